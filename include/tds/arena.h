@@ -0,0 +1,200 @@
+#pragma once
+#ifndef _TDS_ARENA_H_
+#define _TDS_ARENA_H_
+
+#include "private/common.h"
+
+#ifndef TDS_ARENA_CHUNK_SIZE
+#define TDS_ARENA_CHUNK_SIZE ((size_t)64 << 10)
+#endif
+
+// Alignment used when an allocation asks for the natural alignment of `malloc`.
+#define TDS_ARENA_DEFAULT_ALIGNMENT (2 * sizeof(void*))
+
+typedef struct tds_arena_chunk_t {
+    struct tds_arena_chunk_t* previous;
+    size_t size, used;
+} tds_arena_chunk_t;
+
+typedef struct tds_arena_t {
+    tds_arena_chunk_t* chunk; // The chunk being bumped, linked to the ones filled before it.
+    tds_arena_chunk_t* spare; // Chunks released by `rewind` and `reset`, kept for reuse.
+    void* last; // The most recent allocation, which can be grown or released in place.
+    tds_allocator_t allocator;
+} tds_arena_t;
+
+typedef struct tds_arena_mark_t {
+    tds_arena_chunk_t* chunk;
+    size_t used;
+} tds_arena_mark_t;
+
+typedef struct tds_frame_arena_t {
+    tds_arena_t arenas[2];
+    unsigned frame;
+} tds_frame_arena_t;
+
+static inline char* tds_arena_chunk_data(tds_arena_chunk_t* chunk) {
+    return (char*)(chunk + 1);
+}
+
+static inline void* tds_arena_alloc(tds_arena_t* arena, const size_t size, size_t alignment) {
+    if (!alignment) {
+        alignment = TDS_ARENA_DEFAULT_ALIGNMENT;
+    }
+    TDS_ASSERT((alignment & (alignment - 1)) == 0);
+
+    tds_arena_chunk_t* chunk = arena->chunk;
+    if (chunk) {
+        const uintptr_t base = (uintptr_t)tds_arena_chunk_data(chunk);
+        const uintptr_t aligned = (base + chunk->used + alignment - 1) & ~(uintptr_t)(alignment - 1);
+        if (aligned - base <= chunk->size && size <= chunk->size - (aligned - base)) {
+            chunk->used = aligned - base + size;
+            arena->last = (void*)aligned;
+            return arena->last;
+        }
+    }
+
+    // Worst case padding, so the allocation always fits in a fresh chunk.
+    const size_t needed = size + alignment;
+
+    // Reuse a released chunk if one is big enough.
+    tds_arena_chunk_t** link = &arena->spare;
+    while (*link && (*link)->size < needed) {
+        link = &(*link)->previous;
+    }
+
+    if (*link) {
+        chunk = *link;
+        *link = chunk->previous;
+    } else {
+        const size_t chunk_size = needed > TDS_ARENA_CHUNK_SIZE ? needed : TDS_ARENA_CHUNK_SIZE;
+        chunk = tds_allocate(NULL, sizeof(tds_arena_chunk_t) + chunk_size, 0);
+        chunk->size = chunk_size;
+    }
+
+    chunk->used = 0;
+    chunk->previous = arena->chunk;
+    arena->chunk = chunk;
+    return tds_arena_alloc(arena, size, alignment);
+}
+
+static inline tds_arena_mark_t tds_arena_mark(const tds_arena_t* arena) {
+    return (tds_arena_mark_t){
+        .chunk = arena->chunk,
+        .used = arena->chunk ? arena->chunk->used : 0,
+    };
+}
+
+// Releases everything allocated after `mark` was taken. Released chunks are kept for reuse.
+static inline void tds_arena_rewind(tds_arena_t* arena, const tds_arena_mark_t mark) {
+    while (arena->chunk != mark.chunk) {
+        TDS_ASSERT(arena->chunk);
+        tds_arena_chunk_t* chunk = arena->chunk;
+        arena->chunk = chunk->previous;
+        chunk->previous = arena->spare;
+        arena->spare = chunk;
+    }
+
+    if (arena->chunk) {
+        TDS_ASSERT(mark.used <= arena->chunk->used);
+        arena->chunk->used = mark.used;
+    }
+    arena->last = NULL;
+}
+
+// Releases every allocation but keeps the chunks around, so a reset arena doesn't touch the heap again until it needs
+// more memory than it has ever used.
+static inline void tds_arena_reset(tds_arena_t* arena) {
+    tds_arena_rewind(arena, (tds_arena_mark_t){ 0 });
+}
+
+static inline void tds_arena_fini(tds_arena_t* arena) {
+    tds_arena_reset(arena);
+    while (arena->spare) {
+        tds_arena_chunk_t* chunk = arena->spare;
+        arena->spare = chunk->previous;
+        tds_deallocate(NULL, chunk, sizeof(tds_arena_chunk_t) + chunk->size, 0);
+    }
+    *arena = (tds_arena_t){ 0 };
+}
+
+static inline void* tds_arena_allocator_allocate(void* user_data, const size_t size, const size_t alignment) {
+    return tds_arena_alloc(user_data, size, alignment);
+}
+
+static inline void* tds_arena_allocator_reallocate(
+    void* user_data,
+    void* pointer,
+    const size_t old_size,
+    const size_t new_size,
+    const size_t alignment
+) {
+    tds_arena_t* arena = user_data;
+    if (pointer && pointer == arena->last) {
+        // Grow or shrink the most recent allocation in place.
+        const size_t offset = (size_t)((char*)pointer - tds_arena_chunk_data(arena->chunk));
+        if (new_size <= arena->chunk->size - offset) {
+            arena->chunk->used = offset + new_size;
+            return pointer;
+        }
+    }
+
+    void* new_pointer = tds_arena_alloc(arena, new_size, alignment);
+    if (pointer) {
+        TDS_MEMCPY(new_pointer, pointer, old_size < new_size ? old_size : new_size);
+    }
+    return new_pointer;
+}
+
+static inline void tds_arena_allocator_deallocate(
+    void* user_data,
+    void* pointer,
+    const size_t size,
+    const size_t alignment
+) {
+    (void)size;
+    (void)alignment;
+
+    // Only the most recent allocation can be given back; everything else is released with the arena.
+    tds_arena_t* arena = user_data;
+    if (pointer && pointer == arena->last) {
+        arena->chunk->used = (size_t)((char*)pointer - tds_arena_chunk_data(arena->chunk));
+        arena->last = NULL;
+    }
+}
+
+// Returns an allocator for containers generated with TDS_ALLOCATOR. Containers backed by an arena don't need `fini`
+// unless their values need finalizing; resetting or rewinding the arena releases their storage.
+static inline const tds_allocator_t* tds_arena_allocator(tds_arena_t* arena) {
+    arena->allocator = (tds_allocator_t){
+        .allocate = tds_arena_allocator_allocate,
+        .reallocate = tds_arena_allocator_reallocate,
+        .deallocate = tds_arena_allocator_deallocate,
+        .user_data = arena,
+    };
+    return &arena->allocator;
+}
+
+static inline tds_arena_t* tds_frame_arena_current(tds_frame_arena_t* frame_arena) {
+    return frame_arena->arenas + (frame_arena->frame & 1);
+}
+
+static inline tds_arena_t* tds_frame_arena_previous(tds_frame_arena_t* frame_arena) {
+    return frame_arena->arenas + ((frame_arena->frame + 1) & 1);
+}
+
+// Starts a new frame. Allocations from the frame that just ended stay valid until the next swap, everything older is
+// released.
+static inline tds_arena_t* tds_frame_arena_swap(tds_frame_arena_t* frame_arena) {
+    frame_arena->frame++;
+    tds_arena_t* current = tds_frame_arena_current(frame_arena);
+    tds_arena_reset(current);
+    return current;
+}
+
+static inline void tds_frame_arena_fini(tds_frame_arena_t* frame_arena) {
+    tds_arena_fini(frame_arena->arenas);
+    tds_arena_fini(frame_arena->arenas + 1);
+    frame_arena->frame = 0;
+}
+#endif
@@ -0,0 +1,370 @@
+#include "private/common.h"
+#include "private/begin.inc"
+
+// A fixed-capacity key-value cache. Entries live in a single array and carry their own eviction links, and a separate
+// open-addressing index maps keys to entries, so a hit costs one index probe and one entry access, with no allocation.
+// When the cache is full, adding a key evicts another one, chosen by the eviction policy:
+// - LRU, the default: evicts the least recently used entry.
+// - CLOCK, with TDS_CACHE_CLOCK: sweeps a hand over the entries, giving every entry used since the last sweep a
+//   second chance. The new entry takes the place of the evicted one.
+// - SIEVE, with TDS_CACHE_SIEVE: like CLOCK, but new entries always go to the head of the queue, so entries that are
+//   never used again are evicted before the ones that are.
+// CLOCK and SIEVE only set a flag on hits instead of moving the entry, which is cheaper and often evicts better.
+
+#if defined(TDS_CACHE_CLOCK) && defined(TDS_CACHE_SIEVE)
+#error "Define at most one of TDS_CACHE_CLOCK and TDS_CACHE_SIEVE."
+#endif
+
+#ifndef TDS_TYPE
+#define TDS_TYPE TDS_DEFAULT_TYPE_W_KEY_VALUE(cache)
+#endif
+
+#ifndef TDS_ALIGNMENT
+#define TDS_ALIGNMENT TDS_CACHE_LINE_SIZE
+#endif
+
+#define TDS_ENTRY_T TDS_JOIN2(TDS_TYPE, _entry)
+#define TDS_CACHE_NIL TDS_MAX_VALUE(TDS_SIZE_T)
+
+#ifdef TDS_DECLARE
+typedef struct TDS_ENTRY_T {
+    uint64_t hash;
+    TDS_KEY_T key;
+    TDS_VALUE_T value;
+    // Entries are linked from the newest to the oldest. Free entries are linked through `next`.
+    TDS_SIZE_T previous;
+    TDS_SIZE_T next;
+    char visited; // Used since the hand last passed by. Unused by LRU.
+} TDS_ENTRY_T;
+
+typedef struct TDS_TYPE {
+    TDS_ENTRY_T* entries;
+    TDS_SIZE_T* index; // Entry of every occupied index slot, TDS_CACHE_NIL for empty ones.
+    TDS_SIZE_T capacity;
+    TDS_SIZE_T index_capacity; // Always a power of two, at least twice `capacity`.
+    TDS_SIZE_T count;
+    TDS_SIZE_T used; // Entries handed out at least once. Entries past it were never used.
+    TDS_SIZE_T head, tail, free;
+    TDS_SIZE_T hand; // Next entry the CLOCK or SIEVE hand looks at, or TDS_CACHE_NIL to start from the tail.
+#ifdef TDS_ALLOCATOR
+    const tds_allocator_t* allocator;
+#endif
+} TDS_TYPE;
+
+typedef struct TDS_JOIN2(TDS_TYPE, _iter_t) {
+    const TDS_TYPE* cache;
+    TDS_SIZE_T _index;
+    TDS_KEY_T key;
+    TDS_VALUE_T* value;
+} TDS_JOIN2(TDS_TYPE, _iter_t);
+
+void TDS_FUNCTION(reserve)(TDS_TYPE* cache, TDS_SIZE_T capacity);
+TDS_VALUE_T* TDS_FUNCTION(get)(TDS_TYPE* cache, TDS_KEY_T key);
+TDS_VALUE_T* TDS_FUNCTION(peek)(const TDS_TYPE* cache, TDS_KEY_T key);
+int TDS_FUNCTION(set)(TDS_TYPE* cache, TDS_KEY_T key, TDS_VALUE_T value);
+TDS_JOIN2(TDS_TYPE, _iter_t) TDS_FUNCTION(iter)(const TDS_TYPE* cache);
+char TDS_FUNCTION(next)(TDS_JOIN2(TDS_TYPE, _iter_t)* iter);
+int TDS_FUNCTION(remove)(TDS_TYPE* cache, TDS_KEY_T key);
+TDS_SIZE_T TDS_FUNCTION(count)(const TDS_TYPE* cache);
+TDS_SIZE_T TDS_FUNCTION(capacity)(const TDS_TYPE* cache);
+void TDS_FUNCTION(clear)(TDS_TYPE* cache);
+void TDS_FUNCTION(fini)(TDS_TYPE* cache);
+#endif
+
+#ifdef TDS_IMPLEMENT
+static int TDS_FUNCTION(_keys_equal)(TDS_KEY_T a, TDS_KEY_T b) {
+#ifdef TDS_KEY_EQUALS
+    return TDS_KEY_EQUALS(a, b);
+#else
+    return a == b;
+#endif
+}
+
+static void TDS_FUNCTION(_fini_entry)(TDS_ENTRY_T* entry) {
+#ifdef TDS_KEY_FINI
+    TDS_KEY_FINI((entry->key));
+#endif
+#ifdef TDS_VALUE_FINI
+    TDS_VALUE_FINI((entry->value));
+#endif
+    (void)entry;
+}
+
+static void TDS_FUNCTION(_reset)(TDS_TYPE* cache) {
+    for (TDS_SIZE_T i = 0; i < cache->index_capacity; i++) {
+        cache->index[i] = TDS_CACHE_NIL;
+    }
+    cache->count = 0;
+    cache->used = 0;
+    cache->head = cache->tail = cache->free = cache->hand = TDS_CACHE_NIL;
+}
+
+// Returns the index slot holding the entry for `key`, or the empty slot where it would go.
+static TDS_SIZE_T TDS_FUNCTION(_find)(const TDS_TYPE* cache, TDS_KEY_T key, const uint64_t hash) {
+    const TDS_SIZE_T mask = cache->index_capacity - 1;
+    TDS_SIZE_T slot = (TDS_SIZE_T)hash & mask;
+    while (1) {
+        const TDS_SIZE_T entry = cache->index[slot];
+        if (entry == TDS_CACHE_NIL
+            || (cache->entries[entry].hash == hash && TDS_FUNCTION(_keys_equal)(cache->entries[entry].key, key))) {
+            return slot;
+        }
+
+        slot = (slot + 1) & mask;
+    }
+}
+
+// Empties an index slot, shifting back the rest of its cluster instead of leaving a tombstone.
+static void TDS_FUNCTION(_unindex)(TDS_TYPE* cache, TDS_SIZE_T gap) {
+    const TDS_SIZE_T mask = cache->index_capacity - 1;
+    for (TDS_SIZE_T slot = (gap + 1) & mask; cache->index[slot] != TDS_CACHE_NIL; slot = (slot + 1) & mask) {
+        const TDS_SIZE_T home = (TDS_SIZE_T)cache->entries[cache->index[slot]].hash & mask;
+        if (((gap - home) & mask) < ((slot - home) & mask)) {
+            cache->index[gap] = cache->index[slot];
+            gap = slot;
+        }
+    }
+    cache->index[gap] = TDS_CACHE_NIL;
+}
+
+static void TDS_FUNCTION(_unlink)(TDS_TYPE* cache, const TDS_SIZE_T entry) {
+    TDS_ENTRY_T* e = cache->entries + entry;
+    if (e->previous != TDS_CACHE_NIL) {
+        cache->entries[e->previous].next = e->next;
+    } else {
+        cache->head = e->next;
+    }
+
+    if (e->next != TDS_CACHE_NIL) {
+        cache->entries[e->next].previous = e->previous;
+    } else {
+        cache->tail = e->previous;
+    }
+}
+
+static void TDS_FUNCTION(_push_head)(TDS_TYPE* cache, const TDS_SIZE_T entry) {
+    TDS_ENTRY_T* e = cache->entries + entry;
+    e->previous = TDS_CACHE_NIL;
+    e->next = cache->head;
+    if (cache->head != TDS_CACHE_NIL) {
+        cache->entries[cache->head].previous = entry;
+    } else {
+        cache->tail = entry;
+    }
+    cache->head = entry;
+}
+
+#if defined(TDS_CACHE_CLOCK) || defined(TDS_CACHE_SIEVE)
+// Moves the hand from the oldest entries towards the newest ones, clearing the flags of the entries it passes, until it
+// finds one that wasn't used since its last pass. Leaves the hand on the entry after it.
+static TDS_SIZE_T TDS_FUNCTION(_sweep)(TDS_TYPE* cache) {
+    TDS_SIZE_T entry = cache->hand != TDS_CACHE_NIL ? cache->hand : cache->tail;
+    while (cache->entries[entry].visited) {
+        cache->entries[entry].visited = 0;
+        entry = cache->entries[entry].previous != TDS_CACHE_NIL ? cache->entries[entry].previous : cache->tail;
+    }
+
+    cache->hand = cache->entries[entry].previous;
+    return entry;
+}
+#endif
+
+// Evicts an entry to make room for a new one and returns it, unlinked and unindexed, unless the policy keeps the new
+// entry in its place.
+static TDS_SIZE_T TDS_FUNCTION(_evict)(TDS_TYPE* cache) {
+#if defined(TDS_CACHE_CLOCK) || defined(TDS_CACHE_SIEVE)
+    const TDS_SIZE_T entry = TDS_FUNCTION(_sweep)(cache);
+#else
+    const TDS_SIZE_T entry = cache->tail;
+#endif
+    TDS_ENTRY_T* e = cache->entries + entry;
+    TDS_FUNCTION(_unindex)(cache, TDS_FUNCTION(_find)(cache, e->key, e->hash));
+    TDS_FUNCTION(_fini_entry)(e);
+#ifndef TDS_CACHE_CLOCK
+    TDS_FUNCTION(_unlink)(cache, entry);
+#endif
+    cache->count--;
+    return entry;
+}
+
+// Sets the number of entries the cache holds before it starts evicting. Only has an effect before the first `set`.
+void TDS_FUNCTION(reserve)(TDS_TYPE* cache, const TDS_SIZE_T capacity) {
+    TDS_ASSERT(capacity > 0);
+    if (cache->entries) {
+        return;
+    }
+
+    TDS_SIZE_T index_capacity = 2;
+    while (index_capacity < (size_t)capacity * 2) {
+        index_capacity *= 2;
+    }
+
+    cache->entries = tds_allocate(TDS_ALLOCATOR_OF(cache), (size_t)capacity * sizeof(TDS_ENTRY_T), TDS_ALIGNMENT);
+    cache->index = tds_allocate(
+        TDS_ALLOCATOR_OF(cache),
+        (size_t)index_capacity * sizeof(TDS_SIZE_T),
+        TDS_ALIGNMENT);
+    cache->capacity = capacity;
+    cache->index_capacity = index_capacity;
+    TDS_FUNCTION(_reset)(cache);
+}
+
+static void TDS_FUNCTION(_touch)(TDS_TYPE* cache, const TDS_SIZE_T entry) {
+#if defined(TDS_CACHE_CLOCK) || defined(TDS_CACHE_SIEVE)
+    cache->entries[entry].visited = 1;
+#else
+    if (entry != cache->head) {
+        TDS_FUNCTION(_unlink)(cache, entry);
+        TDS_FUNCTION(_push_head)(cache, entry);
+    }
+#endif
+}
+
+// Looks up `key` and marks its entry as used.
+TDS_VALUE_T* TDS_FUNCTION(get)(TDS_TYPE* cache, TDS_KEY_T key) {
+    if (!cache->count) {
+        return NULL;
+    }
+
+    const TDS_SIZE_T entry = cache->index[TDS_FUNCTION(_find)(cache, key, TDS_HASH_KEY(key))];
+    if (entry == TDS_CACHE_NIL) {
+        return NULL;
+    }
+
+    TDS_FUNCTION(_touch)(cache, entry);
+    return &cache->entries[entry].value;
+}
+
+// Looks up `key` without marking its entry as used.
+TDS_VALUE_T* TDS_FUNCTION(peek)(const TDS_TYPE* cache, TDS_KEY_T key) {
+    if (!cache->count) {
+        return NULL;
+    }
+
+    const TDS_SIZE_T entry = cache->index[TDS_FUNCTION(_find)(cache, key, TDS_HASH_KEY(key))];
+    return entry != TDS_CACHE_NIL ? &cache->entries[entry].value : NULL;
+}
+
+// Inserts or replaces the value for `key`, evicting another entry if the cache is full. A replaced value is marked as
+// used. Returns nonzero if the key was inserted.
+int TDS_FUNCTION(set)(TDS_TYPE* cache, TDS_KEY_T key, TDS_VALUE_T value) {
+    if (!cache->entries) {
+        TDS_FUNCTION(reserve)(cache, TDS_INITIAL_CAPACITY);
+    }
+
+    const uint64_t hash = TDS_HASH_KEY(key);
+    TDS_SIZE_T entry = cache->index[TDS_FUNCTION(_find)(cache, key, hash)];
+    if (entry != TDS_CACHE_NIL) {
+        // Key matches, update the value.
+        TDS_FUNCTION(_touch)(cache, entry);
+        cache->entries[entry].value = value;
+        return 0;
+    }
+
+    char linked = 0;
+    if (cache->free != TDS_CACHE_NIL) {
+        entry = cache->free;
+        cache->free = cache->entries[entry].next;
+    } else if (cache->used < cache->capacity) {
+        entry = cache->used++;
+    } else {
+        entry = TDS_FUNCTION(_evict)(cache);
+#ifdef TDS_CACHE_CLOCK
+        linked = 1;
+#endif
+    }
+
+    TDS_ENTRY_T* e = cache->entries + entry;
+    e->hash = hash;
+    e->key = key;
+    e->value = value;
+    e->visited = 0;
+    if (!linked) {
+        TDS_FUNCTION(_push_head)(cache, entry);
+    }
+    // The eviction may have shifted index slots around, so look for the free one only now.
+    cache->index[TDS_FUNCTION(_find)(cache, key, hash)] = entry;
+    cache->count++;
+    return 1;
+}
+
+TDS_JOIN2(TDS_TYPE, _iter_t) TDS_FUNCTION(iter)(const TDS_TYPE* cache) {
+    return (TDS_JOIN2(TDS_TYPE, _iter_t)) {
+        .cache = cache,
+        ._index = 0,
+    };
+}
+
+// Visits the entries in no particular order, without marking them as used.
+char TDS_FUNCTION(next)(TDS_JOIN2(TDS_TYPE, _iter_t)* iter) {
+    const TDS_TYPE* cache = iter->cache;
+    while (iter->_index < cache->index_capacity) {
+        const TDS_SIZE_T entry = cache->index[iter->_index++];
+        if (entry != TDS_CACHE_NIL) {
+            iter->key = cache->entries[entry].key;
+            iter->value = &cache->entries[entry].value;
+            return 1;
+        }
+    }
+
+    return 0;
+}
+
+int TDS_FUNCTION(remove)(TDS_TYPE* cache, TDS_KEY_T key) {
+    if (!cache->count) {
+        return 0;
+    }
+
+    const TDS_SIZE_T slot = TDS_FUNCTION(_find)(cache, key, TDS_HASH_KEY(key));
+    const TDS_SIZE_T entry = cache->index[slot];
+    if (entry == TDS_CACHE_NIL) {
+        return 0;
+    }
+
+    TDS_FUNCTION(_unindex)(cache, slot);
+    TDS_FUNCTION(_fini_entry)(cache->entries + entry);
+    if (cache->hand == entry) {
+        cache->hand = cache->entries[entry].previous;
+    }
+    TDS_FUNCTION(_unlink)(cache, entry);
+    cache->entries[entry].next = cache->free;
+    cache->free = entry;
+    cache->count--;
+    return 1;
+}
+
+TDS_SIZE_T TDS_FUNCTION(count)(const TDS_TYPE* cache) {
+    return cache->count;
+}
+
+TDS_SIZE_T TDS_FUNCTION(capacity)(const TDS_TYPE* cache) {
+    return cache->capacity;
+}
+
+// Removes every entry but keeps the storage and the capacity.
+void TDS_FUNCTION(clear)(TDS_TYPE* cache) {
+    if (!cache->entries) {
+        return;
+    }
+
+#if defined(TDS_VALUE_FINI) || defined(TDS_KEY_FINI)
+    for (TDS_SIZE_T entry = cache->head; entry != TDS_CACHE_NIL; entry = cache->entries[entry].next) {
+        TDS_FUNCTION(_fini_entry)(cache->entries + entry);
+    }
+#endif
+    TDS_FUNCTION(_reset)(cache);
+}
+
+void TDS_FUNCTION(fini)(TDS_TYPE* cache) {
+    TDS_FUNCTION(clear)(cache);
+    tds_deallocate(TDS_ALLOCATOR_OF(cache), cache->entries, (size_t)cache->capacity * sizeof(TDS_ENTRY_T), TDS_ALIGNMENT);
+    tds_deallocate(TDS_ALLOCATOR_OF(cache), cache->index, (size_t)cache->index_capacity * sizeof(TDS_SIZE_T), TDS_ALIGNMENT);
+    TDS_RESET(cache);
+}
+#endif
+
+#include "private/end.inc"
+
+#undef TDS_CACHE_NIL
+#undef TDS_CACHE_CLOCK
+#undef TDS_CACHE_SIEVE
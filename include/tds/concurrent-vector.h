@@ -0,0 +1,307 @@
+#include "private/common.h"
+#include "private/atomic.h"
+#include "private/begin.inc"
+
+// An append-only vector that many threads can push to at once. Each push reserves its index with an atomic increment
+// and writes into segments that double in size, like segmented-vector.h, so elements never move and readers never need
+// a lock. Every element has a flag that its push sets once the value is written, and any push moves the published count
+// over the written elements that follow it, so `count` covers a prefix of finished pushes and readers may iterate up to
+// it while other threads keep pushing. No push ever waits for another. `clear`, `reclaim` and `fini` must not run
+// concurrently with anything else.
+
+#ifndef TDS_TYPE
+#define TDS_TYPE TDS_DEFAULT_TYPE_W_VALUE(concurrent_vec)
+#endif
+
+#ifndef TDS_ALIGNMENT
+#define TDS_ALIGNMENT 0
+#endif
+
+// The first segment holds 1 << TDS_SEGMENT_SHIFT elements.
+#ifndef TDS_SEGMENT_SHIFT
+#define TDS_SEGMENT_SHIFT 3
+#endif
+
+#if TDS_SEGMENT_SHIFT < 0 || TDS_SEGMENT_SHIFT > 30
+#error "TDS_SEGMENT_SHIFT must be between 0 and 30."
+#endif
+
+// Enough segments to address every index representable by TDS_SIZE_T.
+#define TDS_SEGMENT_COUNT (sizeof(TDS_SIZE_T) * 8)
+
+#ifdef TDS_DECLARE
+typedef struct TDS_TYPE {
+    TDS_VALUE_T* volatile segments[TDS_SEGMENT_COUNT]; // Each followed by one written flag per element.
+    volatile size_t reserved; // Indices handed out to pushes so far.
+    volatile size_t published; // Every element below this index has been written.
+#ifdef TDS_ALLOCATOR
+    const tds_allocator_t* allocator;
+#endif
+} TDS_TYPE;
+
+// Iterates over the elements published when `iter` was called, one segment at a time.
+typedef struct TDS_JOIN2(TDS_TYPE, _iter_t) {
+    const TDS_TYPE* vec;
+    TDS_SIZE_T _segment;
+    TDS_SIZE_T _index; // Index of the first element of the next chunk.
+    TDS_SIZE_T _count;
+    TDS_VALUE_T* values;
+    TDS_SIZE_T count;
+} TDS_JOIN2(TDS_TYPE, _iter_t);
+
+TDS_SIZE_T TDS_FUNCTION(push)(TDS_TYPE* vec, TDS_VALUE_T value);
+TDS_SIZE_T TDS_FUNCTION(push_many)(TDS_TYPE* vec, const TDS_VALUE_T* values, TDS_SIZE_T count);
+void TDS_FUNCTION(reserve)(TDS_TYPE* vec, TDS_SIZE_T capacity);
+TDS_VALUE_T* TDS_FUNCTION(at)(const TDS_TYPE* vec, TDS_SIZE_T index);
+TDS_VALUE_T TDS_FUNCTION(get)(const TDS_TYPE* vec, TDS_SIZE_T index);
+TDS_SIZE_T TDS_FUNCTION(count)(const TDS_TYPE* vec);
+TDS_JOIN2(TDS_TYPE, _iter_t) TDS_FUNCTION(iter)(const TDS_TYPE* vec);
+char TDS_FUNCTION(next)(TDS_JOIN2(TDS_TYPE, _iter_t)* iter);
+void TDS_FUNCTION(clear)(TDS_TYPE* vec);
+void TDS_FUNCTION(reclaim)(TDS_TYPE* vec);
+void TDS_FUNCTION(fini)(TDS_TYPE* vec);
+#endif
+
+#ifdef TDS_IMPLEMENT
+static size_t TDS_FUNCTION(_segment_size)(const size_t segment) {
+    return (size_t)1 << (TDS_SEGMENT_SHIFT + segment);
+}
+
+// Bytes of a segment, its written flags included.
+static size_t TDS_FUNCTION(_segment_bytes)(const size_t segment) {
+    return TDS_FUNCTION(_segment_size)(segment) * (sizeof(TDS_VALUE_T) + 1);
+}
+
+static volatile char* TDS_FUNCTION(_flags)(TDS_VALUE_T* values, const size_t segment) {
+    return (volatile char*)(values + TDS_FUNCTION(_segment_size)(segment));
+}
+
+static size_t TDS_FUNCTION(_segment_of)(const size_t index) {
+    return tds_highest_bit((uint64_t)index + ((uint64_t)1 << TDS_SEGMENT_SHIFT)) - TDS_SEGMENT_SHIFT;
+}
+
+// Index of the first element of `segment`.
+static size_t TDS_FUNCTION(_segment_start)(const size_t segment) {
+    return (((size_t)1 << segment) - 1) << TDS_SEGMENT_SHIFT;
+}
+
+// Returns the segment, allocating it if no other thread has yet. When two threads race to allocate the same segment,
+// the loser frees its copy and uses the winner's.
+static TDS_VALUE_T* TDS_FUNCTION(_acquire_segment)(TDS_TYPE* vec, const size_t segment) {
+    TDS_ASSERT(segment < TDS_SEGMENT_COUNT);
+
+    void* volatile* slot = (void* volatile*)&vec->segments[segment];
+    void* current = tds_atomic_load_pointer(slot);
+    if (current) {
+        return current;
+    }
+
+    const size_t size = TDS_FUNCTION(_segment_bytes)(segment);
+    void* allocated = tds_allocate(TDS_ALLOCATOR_OF(vec), size, TDS_ALIGNMENT);
+    if (tds_atomic_compare_exchange_pointer(slot, &current, allocated)) {
+        return allocated;
+    }
+
+    tds_deallocate(TDS_ALLOCATOR_OF(vec), allocated, size, TDS_ALIGNMENT);
+    return current;
+}
+
+// Reserves `count` consecutive indices and returns the first one.
+static size_t TDS_FUNCTION(_reserve_indices)(TDS_TYPE* vec, const size_t count) {
+    const size_t first = tds_atomic_fetch_add(&vec->reserved, count);
+    // Guard against running out of indices.
+    TDS_ASSERT(first + count >= first && first + count <= (size_t)TDS_MAX_VALUE(TDS_SIZE_T));
+    return first;
+}
+
+// Moves the published count over every written element that follows it. Several threads may do this at once, each
+// compare-exchange only moving it over elements whose flags were seen set.
+static void TDS_FUNCTION(_advance)(TDS_TYPE* vec) {
+    size_t published = tds_atomic_load(&vec->published);
+    for (;;) {
+        const size_t segment = TDS_FUNCTION(_segment_of)(published);
+        if (segment >= TDS_SEGMENT_COUNT) {
+            return;
+        }
+        TDS_VALUE_T* values = tds_atomic_load_pointer((void* volatile*)&vec->segments[segment]);
+        if (!values) {
+            return;
+        }
+
+        const size_t start = TDS_FUNCTION(_segment_start)(segment);
+        const size_t segment_end = start + TDS_FUNCTION(_segment_size)(segment);
+        volatile char* flags = TDS_FUNCTION(_flags)(values, segment);
+        size_t end = published;
+        while (end < segment_end && tds_atomic_load_char(&flags[end - start])) {
+            end++;
+        }
+        if (end == published) {
+            return;
+        }
+
+        // On failure, `published` is reloaded and the scan starts over from wherever another thread left it.
+        if (tds_atomic_compare_exchange(&vec->published, &published, end)) {
+            published = end;
+        }
+    }
+}
+
+// Marks [first, end) as written, then helps publish them. The fence orders the flags before the scan: either this scan
+// sees the flag of an earlier element still being written, or that element's push sees these flags in its own scan.
+static void TDS_FUNCTION(_publish)(TDS_TYPE* vec, const size_t first, const size_t end) {
+    size_t index = first;
+    while (index < end) {
+        const size_t segment = TDS_FUNCTION(_segment_of)(index);
+        const size_t start = TDS_FUNCTION(_segment_start)(segment);
+        const size_t segment_end = start + TDS_FUNCTION(_segment_size)(segment);
+        volatile char* flags = TDS_FUNCTION(_flags)(vec->segments[segment], segment);
+        for (; index < end && index < segment_end; index++) {
+            tds_atomic_store_char(&flags[index - start], 1);
+        }
+    }
+
+    tds_atomic_fence();
+    TDS_FUNCTION(_advance)(vec);
+}
+
+// Appends a value and returns its index. Safe to call from any number of threads at once.
+TDS_SIZE_T TDS_FUNCTION(push)(TDS_TYPE* vec, const TDS_VALUE_T value) {
+    const size_t index = TDS_FUNCTION(_reserve_indices)(vec, 1);
+    const size_t segment = TDS_FUNCTION(_segment_of)(index);
+    TDS_VALUE_T* values = TDS_FUNCTION(_acquire_segment)(vec, segment);
+    values[index - TDS_FUNCTION(_segment_start)(segment)] = value;
+
+    TDS_FUNCTION(_publish)(vec, index, index + 1);
+    return (TDS_SIZE_T)index;
+}
+
+// Appends `count` values with a single reservation, so they end up next to each other, and returns the index of the
+// first one. Safe to call from any number of threads at once.
+TDS_SIZE_T TDS_FUNCTION(push_many)(TDS_TYPE* vec, const TDS_VALUE_T* values, const TDS_SIZE_T count) {
+    const size_t first = TDS_FUNCTION(_reserve_indices)(vec, count);
+    const size_t end = first + count;
+
+    // Copy segment by segment.
+    size_t index = first;
+    while (index < end) {
+        const size_t segment = TDS_FUNCTION(_segment_of)(index);
+        const size_t start = TDS_FUNCTION(_segment_start)(segment);
+        const size_t segment_end = start + TDS_FUNCTION(_segment_size)(segment);
+        const size_t copied = (end < segment_end ? end : segment_end) - index;
+
+        TDS_VALUE_T* destination = TDS_FUNCTION(_acquire_segment)(vec, segment);
+        TDS_MEMCPY(destination + (index - start), values + (index - first), copied * sizeof(TDS_VALUE_T));
+        index += copied;
+    }
+
+    TDS_FUNCTION(_publish)(vec, first, end);
+    return (TDS_SIZE_T)first;
+}
+
+// Allocates the segments needed for `capacity` elements up front, so pushes don't have to. Safe to call concurrently
+// with pushes.
+void TDS_FUNCTION(reserve)(TDS_TYPE* vec, const TDS_SIZE_T capacity) {
+    if (!capacity) {
+        return;
+    }
+
+    const size_t last = TDS_FUNCTION(_segment_of)((size_t)capacity - 1);
+    for (size_t segment = 0; segment <= last; segment++) {
+        (void)TDS_FUNCTION(_acquire_segment)(vec, segment);
+    }
+}
+
+// Returns the address of a published element, which stays valid until the vector is cleared.
+TDS_VALUE_T* TDS_FUNCTION(at)(const TDS_TYPE* vec, const TDS_SIZE_T index) {
+    TDS_ASSERT(index < TDS_FUNCTION(count)(vec));
+
+    const size_t segment = TDS_FUNCTION(_segment_of)(index);
+    return vec->segments[segment] + ((size_t)index - TDS_FUNCTION(_segment_start)(segment));
+}
+
+TDS_VALUE_T TDS_FUNCTION(get)(const TDS_TYPE* vec, const TDS_SIZE_T index) {
+    return *TDS_FUNCTION(at)(vec, index);
+}
+
+// Returns the number of published elements. Pushes still in progress aren't counted.
+TDS_SIZE_T TDS_FUNCTION(count)(const TDS_TYPE* vec) {
+    return (TDS_SIZE_T)tds_atomic_load((volatile size_t*)&vec->published);
+}
+
+TDS_JOIN2(TDS_TYPE, _iter_t) TDS_FUNCTION(iter)(const TDS_TYPE* vec) {
+    return (TDS_JOIN2(TDS_TYPE, _iter_t)) {
+        .vec = vec,
+        ._segment = 0,
+        ._index = 0,
+        ._count = TDS_FUNCTION(count)(vec),
+    };
+}
+
+// Moves to the next segment holding elements, setting `values` and `count` to the part of it in use.
+char TDS_FUNCTION(next)(TDS_JOIN2(TDS_TYPE, _iter_t)* iter) {
+    if (iter->_index >= iter->_count) {
+        return 0;
+    }
+
+    const size_t size = TDS_FUNCTION(_segment_size)(iter->_segment);
+    const size_t remaining = (size_t)(iter->_count - iter->_index);
+    iter->values = iter->vec->segments[iter->_segment++];
+    iter->count = (TDS_SIZE_T)(remaining < size ? remaining : size);
+    iter->_index += iter->count;
+    return 1;
+}
+
+// Removes all elements but keeps the segments. Not thread-safe.
+void TDS_FUNCTION(clear)(TDS_TYPE* vec) {
+    TDS_ASSERT(vec->reserved == vec->published);
+
+#ifdef TDS_VALUE_FINI
+    TDS_JOIN2(TDS_TYPE, _iter_t) it = TDS_FUNCTION(iter)(vec);
+    while (TDS_FUNCTION(next)(&it)) {
+        for (TDS_SIZE_T i = 0; i < it.count; i++) {
+            TDS_VALUE_FINI(it.values[i]);
+        }
+    }
+#endif
+
+    // Reset the written flags of the used segments.
+    for (size_t segment = 0; segment < TDS_SEGMENT_COUNT && vec->segments[segment]; segment++) {
+        const size_t start = TDS_FUNCTION(_segment_start)(segment);
+        if (start >= vec->published) {
+            break;
+        }
+        const size_t size = TDS_FUNCTION(_segment_size)(segment);
+        TDS_MEMSET((char*)TDS_FUNCTION(_flags)(vec->segments[segment], segment), 0, size);
+    }
+
+    vec->reserved = 0;
+    vec->published = 0;
+}
+
+// Frees the segments that hold no elements. Not thread-safe.
+void TDS_FUNCTION(reclaim)(TDS_TYPE* vec) {
+    TDS_ASSERT(vec->reserved == vec->published);
+
+    const size_t used = vec->published ? TDS_FUNCTION(_segment_of)(vec->published - 1) + 1 : 0;
+    for (size_t segment = used; segment < TDS_SEGMENT_COUNT && vec->segments[segment]; segment++) {
+        tds_deallocate(
+            TDS_ALLOCATOR_OF(vec),
+            vec->segments[segment],
+            TDS_FUNCTION(_segment_bytes)(segment),
+            TDS_ALIGNMENT);
+        vec->segments[segment] = NULL;
+    }
+}
+
+// Not thread-safe.
+void TDS_FUNCTION(fini)(TDS_TYPE* vec) {
+    TDS_FUNCTION(clear)(vec);
+    TDS_FUNCTION(reclaim)(vec);
+    TDS_RESET(vec);
+}
+#endif
+
+#include "private/end.inc"
+
+#undef TDS_SEGMENT_SHIFT
+#undef TDS_SEGMENT_COUNT
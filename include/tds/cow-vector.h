@@ -0,0 +1,233 @@
+#include "private/common.h"
+#include "private/atomic.h"
+#include "private/begin.inc"
+
+// A vector whose buffer is reference counted, so `clone` is O(1) and clones share their elements until one of them is
+// changed. A change to a vector whose buffer is shared first copies the buffer, and the other vectors keep the old one.
+// The count is atomic, so clones can be handed to and finished by other threads, but each vector must still only be used
+// by one thread at a time. Values are shallow-copied when a buffer is, so TDS_VALUE_FINI is not supported.
+
+#ifndef TDS_TYPE
+#define TDS_TYPE TDS_DEFAULT_TYPE_W_VALUE(cow_vec)
+#endif
+
+#ifdef TDS_VALUE_FINI
+#error "cow-vector.h doesn't support TDS_VALUE_FINI."
+#endif
+
+#ifndef TDS_ALIGNMENT
+#define TDS_ALIGNMENT 0
+#endif
+
+#define TDS_COW_BUFFER_T TDS_JOIN2(TDS_TYPE, _buffer_t)
+// The header is padded to TDS_ALIGNMENT, so the elements are as aligned as the buffer.
+#define TDS_COW_HEADER_SIZE (TDS_ALIGNMENT > sizeof(size_t) ? TDS_ALIGNMENT : sizeof(size_t))
+
+#ifdef TDS_DECLARE
+typedef struct TDS_COW_BUFFER_T {
+    union {
+        volatile size_t references; // Number of vectors using the buffer.
+        char padding[TDS_COW_HEADER_SIZE];
+    } header;
+    TDS_VALUE_T values[];
+} TDS_COW_BUFFER_T;
+
+typedef struct TDS_TYPE {
+    TDS_COW_BUFFER_T* buffer;
+    TDS_SIZE_T count, capacity;
+#ifdef TDS_ALLOCATOR
+    const tds_allocator_t* allocator;
+#endif
+} TDS_TYPE;
+
+TDS_TYPE TDS_FUNCTION(clone)(const TDS_TYPE* vec);
+char TDS_FUNCTION(is_shared)(const TDS_TYPE* vec);
+void TDS_FUNCTION(append)(TDS_TYPE* vec, TDS_VALUE_T value);
+void TDS_FUNCTION(reserve)(TDS_TYPE* vec, TDS_SIZE_T capacity);
+TDS_VALUE_T* TDS_FUNCTION(grow)(TDS_TYPE* vec, TDS_SIZE_T count);
+void TDS_FUNCTION(set)(TDS_TYPE* vec, TDS_SIZE_T index, TDS_VALUE_T value);
+void TDS_FUNCTION(remove)(TDS_TYPE* vec, TDS_SIZE_T index);
+void TDS_FUNCTION(remove_swap)(TDS_TYPE* vec, TDS_SIZE_T index);
+TDS_VALUE_T TDS_FUNCTION(get)(const TDS_TYPE* vec, TDS_SIZE_T index);
+TDS_SIZE_T TDS_FUNCTION(count)(const TDS_TYPE* vec);
+const TDS_VALUE_T* TDS_FUNCTION(first)(const TDS_TYPE* vec);
+TDS_VALUE_T* TDS_FUNCTION(first_mut)(TDS_TYPE* vec);
+void TDS_FUNCTION(clear)(TDS_TYPE* vec);
+void TDS_FUNCTION(reclaim)(TDS_TYPE* vec);
+void TDS_FUNCTION(fini)(TDS_TYPE* vec);
+#endif
+
+#ifdef TDS_IMPLEMENT
+static size_t TDS_FUNCTION(_buffer_size)(const TDS_SIZE_T capacity) {
+    return sizeof(TDS_COW_BUFFER_T) + (size_t)capacity * sizeof(TDS_VALUE_T);
+}
+
+// Drops this vector's reference to its buffer, freeing the buffer if it was the last one.
+static void TDS_FUNCTION(_release)(TDS_TYPE* vec) {
+    if (vec->buffer && tds_atomic_fetch_add(&vec->buffer->header.references, (size_t)-1) == 1) {
+        tds_deallocate(TDS_ALLOCATOR_OF(vec), vec->buffer, TDS_FUNCTION(_buffer_size)(vec->capacity), TDS_ALIGNMENT);
+    }
+    vec->buffer = NULL;
+}
+
+// Gives the vector a buffer of its own with room for exactly `capacity` elements, which must fit the current ones. A
+// buffer the vector already owns is resized in place, and a shared one is copied.
+static void TDS_FUNCTION(_own)(TDS_TYPE* vec, const TDS_SIZE_T capacity) {
+    TDS_ASSERT(vec->count <= capacity);
+
+    if (vec->buffer && !TDS_FUNCTION(is_shared)(vec)) {
+        if (capacity != vec->capacity) {
+            vec->buffer = tds_reallocate(
+                TDS_ALLOCATOR_OF(vec),
+                vec->buffer,
+                TDS_FUNCTION(_buffer_size)(vec->capacity),
+                TDS_FUNCTION(_buffer_size)(capacity),
+                TDS_ALIGNMENT);
+            vec->capacity = capacity;
+        }
+        return;
+    }
+
+    TDS_COW_BUFFER_T* buffer = tds_allocate(TDS_ALLOCATOR_OF(vec), TDS_FUNCTION(_buffer_size)(capacity), TDS_ALIGNMENT);
+    buffer->header.references = 1;
+    if (vec->buffer) {
+        TDS_MEMCPY(buffer->values, vec->buffer->values, (size_t)vec->count * sizeof(TDS_VALUE_T));
+        TDS_FUNCTION(_release)(vec);
+    }
+    vec->buffer = buffer;
+    vec->capacity = capacity;
+}
+
+// Returns a vector sharing this one's elements, in O(1). Both must be finished.
+TDS_TYPE TDS_FUNCTION(clone)(const TDS_TYPE* vec) {
+    if (vec->buffer) {
+        (void)tds_atomic_fetch_add(&vec->buffer->header.references, 1);
+    }
+    return *vec;
+}
+
+// Whether the buffer is shared with a clone, in which case the next change copies it.
+char TDS_FUNCTION(is_shared)(const TDS_TYPE* vec) {
+    return vec->buffer && tds_atomic_load(&vec->buffer->header.references) > 1;
+}
+
+void TDS_FUNCTION(append)(TDS_TYPE* vec, const TDS_VALUE_T value) {
+    TDS_VALUE_T* slot = TDS_FUNCTION(grow)(vec, 1);
+    *slot = value;
+}
+
+// Reserves exactly `capacity` elements, without rounding up. Copies a shared buffer even if it's big enough.
+void TDS_FUNCTION(reserve)(TDS_TYPE* vec, const TDS_SIZE_T capacity) {
+    TDS_ASSERT(vec->count <= vec->capacity);
+
+    if (capacity <= vec->capacity && !TDS_FUNCTION(is_shared)(vec)) {
+        return;
+    }
+
+    TDS_FUNCTION(_own)(vec, capacity > vec->capacity ? capacity : vec->capacity);
+}
+
+TDS_VALUE_T* TDS_FUNCTION(grow)(TDS_TYPE* vec, const TDS_SIZE_T count) {
+    const TDS_SIZE_T old_count = vec->count;
+    const TDS_SIZE_T needed = old_count + count;
+    // Guard against overflow and negative counts.
+    TDS_ASSERT(needed >= old_count);
+
+    if (!vec->buffer && needed == 0) {
+        return NULL;
+    }
+    if (needed > vec->capacity) {
+        TDS_FUNCTION(_own)(vec, TDS_GROWN_CAPACITY(vec->capacity, needed));
+    } else if (TDS_FUNCTION(is_shared)(vec)) {
+        TDS_FUNCTION(_own)(vec, vec->capacity);
+    }
+    vec->count = needed;
+
+    return vec->buffer->values + old_count;
+}
+
+void TDS_FUNCTION(set)(TDS_TYPE* vec, const TDS_SIZE_T index, const TDS_VALUE_T value) {
+    TDS_ASSERT(index < vec->count);
+    TDS_FUNCTION(first_mut)(vec)[index] = value;
+}
+
+void TDS_FUNCTION(remove)(TDS_TYPE* vec, const TDS_SIZE_T index) {
+    TDS_ASSERT(index < vec->count);
+
+    TDS_VALUE_T* array = TDS_FUNCTION(first_mut)(vec);
+    if (index < vec->count - 1) {
+        // Shift elements to the left
+        TDS_MEMMOVE(&array[index], &array[index + 1], (size_t)(vec->count - index - 1) * sizeof(TDS_VALUE_T));
+    }
+    vec->count--;
+}
+
+// Removes the element at `index` in O(1) by moving the last element into its place. Doesn't preserve order.
+void TDS_FUNCTION(remove_swap)(TDS_TYPE* vec, const TDS_SIZE_T index) {
+    TDS_ASSERT(index < vec->count);
+
+    TDS_VALUE_T* array = TDS_FUNCTION(first_mut)(vec);
+    vec->count--;
+    array[index] = array[vec->count];
+}
+
+TDS_VALUE_T TDS_FUNCTION(get)(const TDS_TYPE* vec, const TDS_SIZE_T index) {
+    TDS_ASSERT(index < vec->count);
+    return vec->buffer->values[index];
+}
+
+TDS_SIZE_T TDS_FUNCTION(count)(const TDS_TYPE* vec) {
+    return vec->count;
+}
+
+// Returns the elements for reading, or NULL if the vector has no buffer. They may be shared with clones, so they must
+// not be written through.
+const TDS_VALUE_T* TDS_FUNCTION(first)(const TDS_TYPE* vec) {
+    return vec->buffer ? vec->buffer->values : NULL;
+}
+
+// Returns the elements for writing, copying them first if they are shared, or NULL if the vector has no buffer.
+TDS_VALUE_T* TDS_FUNCTION(first_mut)(TDS_TYPE* vec) {
+    if (TDS_FUNCTION(is_shared)(vec)) {
+        TDS_FUNCTION(_own)(vec, vec->capacity);
+    }
+    return vec->buffer ? vec->buffer->values : NULL;
+}
+
+// Removes all elements. A shared buffer is left to its other vectors instead of being copied.
+void TDS_FUNCTION(clear)(TDS_TYPE* vec) {
+    if (TDS_FUNCTION(is_shared)(vec)) {
+        TDS_FUNCTION(_release)(vec);
+        vec->capacity = 0;
+    }
+    vec->count = 0;
+}
+
+// Shrinks an owned buffer to exactly `count` elements, or frees it if empty. A shared buffer is only let go of if the
+// vector is empty.
+void TDS_FUNCTION(reclaim)(TDS_TYPE* vec) {
+    TDS_ASSERT(vec->count <= vec->capacity);
+
+    if (!vec->count) {
+        TDS_FUNCTION(_release)(vec);
+        vec->capacity = 0;
+        return;
+    }
+
+    if (vec->count == vec->capacity || TDS_FUNCTION(is_shared)(vec)) {
+        return;
+    }
+
+    TDS_FUNCTION(_own)(vec, vec->count);
+}
+
+void TDS_FUNCTION(fini)(TDS_TYPE* vec) {
+    TDS_FUNCTION(_release)(vec);
+    TDS_RESET(vec);
+}
+#endif
+
+#include "private/end.inc"
+
+#undef TDS_COW_BUFFER_T
+#undef TDS_COW_HEADER_SIZE
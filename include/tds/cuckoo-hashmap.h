@@ -0,0 +1,535 @@
+#include "private/common.h"
+#include "private/begin.inc"
+
+// Bucketized cuckoo hashing. Every key can live in one of two buckets of TDS_CUCKOO_SLOTS slots, or in a small stash,
+// so a lookup touches at most two buckets no matter how full the table is. That's at most two cache lines when a bucket
+// fits in one: with 64-byte lines, keys and values of up to 8 bytes together, or 8-byte keys with 4-byte values and
+// the other way around. A uint64_t to uint64_t bucket takes two lines, so a lookup may read four. Buckets store an
+// 8-bit tag per slot; the alternate bucket of a key is derived from its current bucket and tag alone, so keys can be
+// moved around without hashing them again.
+
+#ifndef TDS_TYPE
+#define TDS_TYPE TDS_DEFAULT_TYPE_W_KEY_VALUE(cuckoo_hashmap)
+#endif
+
+#ifndef TDS_ALIGNMENT
+#define TDS_ALIGNMENT TDS_CACHE_LINE_SIZE
+#endif
+
+#define TDS_BUCKET_T TDS_JOIN2(TDS_TYPE, _bucket)
+#define TDS_CUCKOO_SLOTS 4
+
+// Keys that couldn't be placed by the eviction search wait in a stash until the next rehash. Once this many are
+// stashed, the table doubles instead, unless it's already so empty that the keys left over must share their hashes.
+#ifndef TDS_CUCKOO_STASH_SIZE
+#define TDS_CUCKOO_STASH_SIZE 4
+#endif
+
+#if TDS_CUCKOO_STASH_SIZE < 1
+#error "TDS_CUCKOO_STASH_SIZE must be at least 1."
+#endif
+
+// Maximum number of buckets visited by the breadth-first search for an eviction path.
+#ifndef TDS_CUCKOO_SEARCH_SIZE
+#define TDS_CUCKOO_SEARCH_SIZE 128
+#endif
+
+// Buckets are padded to a power of two below a cache line, or to whole cache lines above it, so that with the cache line
+// aligned bucket array a lookup never reads a bucket straddling two lines.
+#define TDS_CUCKOO_BUCKET_SIZE(size) \
+    ((size) <= 16 ? 16 : (size) <= 32 ? 32 : ((size) + TDS_CACHE_LINE_SIZE - 1) / TDS_CACHE_LINE_SIZE * TDS_CACHE_LINE_SIZE)
+
+#ifdef TDS_DECLARE
+// Only there to measure the bucket fields, which are repeated in the padded union below.
+struct TDS_JOIN2(TDS_BUCKET_T, _fields) {
+    uint8_t tags[TDS_CUCKOO_SLOTS];
+    TDS_KEY_T keys[TDS_CUCKOO_SLOTS];
+    TDS_VALUE_T values[TDS_CUCKOO_SLOTS];
+};
+
+typedef union TDS_BUCKET_T {
+    struct {
+        uint8_t tags[TDS_CUCKOO_SLOTS]; // Zero for empty slots.
+        TDS_KEY_T keys[TDS_CUCKOO_SLOTS];
+        TDS_VALUE_T values[TDS_CUCKOO_SLOTS];
+    } fields;
+    char padding[TDS_CUCKOO_BUCKET_SIZE(sizeof(struct TDS_JOIN2(TDS_BUCKET_T, _fields)))];
+} TDS_BUCKET_T;
+
+typedef struct TDS_TYPE {
+    TDS_BUCKET_T* buckets;
+    TDS_SIZE_T count;
+    TDS_SIZE_T bucket_count; // Always a power of two.
+    TDS_SIZE_T stash_count;
+    TDS_SIZE_T stash_capacity;
+    TDS_KEY_T* stash_keys; // Allocated when the first key is stashed.
+    TDS_VALUE_T* stash_values;
+#ifdef TDS_ALLOCATOR
+    const tds_allocator_t* allocator;
+#endif
+} TDS_TYPE;
+
+typedef struct TDS_JOIN2(TDS_TYPE, _iter_t) {
+    const TDS_TYPE* map;
+    TDS_SIZE_T _index;
+    TDS_KEY_T key;
+    TDS_VALUE_T* value;
+} TDS_JOIN2(TDS_TYPE, _iter_t);
+
+TDS_VALUE_T* TDS_FUNCTION(get)(const TDS_TYPE* map, TDS_KEY_T key);
+void TDS_FUNCTION(reserve)(TDS_TYPE* map, TDS_SIZE_T capacity);
+int TDS_FUNCTION(set)(TDS_TYPE* map, TDS_KEY_T key, TDS_VALUE_T value);
+TDS_JOIN2(TDS_TYPE, _iter_t) TDS_FUNCTION(iter)(const TDS_TYPE* map);
+char TDS_FUNCTION(next)(TDS_JOIN2(TDS_TYPE, _iter_t)* iter);
+int TDS_FUNCTION(remove)(TDS_TYPE* map, TDS_KEY_T key);
+TDS_SIZE_T TDS_FUNCTION(count)(const TDS_TYPE* map);
+void TDS_FUNCTION(clear)(TDS_TYPE* map);
+void TDS_FUNCTION(reclaim)(TDS_TYPE* map);
+void TDS_FUNCTION(fini)(TDS_TYPE* map);
+#endif
+
+#ifdef TDS_IMPLEMENT
+static uint8_t TDS_FUNCTION(_tag)(const uint64_t hash) {
+    const uint8_t tag = (uint8_t)(hash >> 56);
+    return tag ? tag : 1;
+}
+
+static TDS_SIZE_T TDS_FUNCTION(_alternate)(const TDS_TYPE* map, const TDS_SIZE_T bucket, const uint8_t tag) {
+    return (bucket ^ (TDS_SIZE_T)tds_mix64(tag)) & (map->bucket_count - 1);
+}
+
+// Buckets needed to hold `capacity` keys at a load factor of at most 90%.
+static TDS_SIZE_T TDS_FUNCTION(_bucket_count_for)(const TDS_SIZE_T capacity) {
+    const size_t slots = ((size_t)capacity * 10 + 8) / 9;
+    TDS_SIZE_T bucket_count = 1;
+    while ((size_t)bucket_count * TDS_CUCKOO_SLOTS < slots) {
+        bucket_count *= 2;
+    }
+
+    return bucket_count;
+}
+
+static int TDS_FUNCTION(_keys_equal)(TDS_KEY_T a, TDS_KEY_T b) {
+#ifdef TDS_KEY_EQUALS
+    return TDS_KEY_EQUALS(a, b);
+#else
+    return a == b;
+#endif
+}
+
+// Finds `key` in `bucket`, returning its slot or TDS_CUCKOO_SLOTS.
+static unsigned TDS_FUNCTION(_find_in)(const TDS_BUCKET_T* bucket, TDS_KEY_T key, const uint8_t tag) {
+    for (unsigned i = 0; i < TDS_CUCKOO_SLOTS; i++) {
+        if (bucket->fields.tags[i] == tag && TDS_FUNCTION(_keys_equal)(bucket->fields.keys[i], key)) {
+            return i;
+        }
+    }
+
+    return TDS_CUCKOO_SLOTS;
+}
+
+static unsigned TDS_FUNCTION(_free_slot)(const TDS_BUCKET_T* bucket) {
+    for (unsigned i = 0; i < TDS_CUCKOO_SLOTS; i++) {
+        if (!bucket->fields.tags[i]) {
+            return i;
+        }
+    }
+
+    return TDS_CUCKOO_SLOTS;
+}
+
+static void TDS_FUNCTION(_place)(
+    TDS_BUCKET_T* bucket,
+    const unsigned slot,
+    const uint8_t tag,
+    TDS_KEY_T key,
+    TDS_VALUE_T value
+) {
+    bucket->fields.tags[slot] = tag;
+    bucket->fields.keys[slot] = key;
+    bucket->fields.values[slot] = value;
+}
+
+static void TDS_FUNCTION(rehash)(TDS_TYPE* map, TDS_SIZE_T bucket_count);
+
+static void TDS_FUNCTION(_free_stash)(
+    const tds_allocator_t* allocator,
+    TDS_KEY_T* keys,
+    TDS_VALUE_T* values,
+    const TDS_SIZE_T capacity
+) {
+    tds_deallocate(allocator, keys, (size_t)capacity * sizeof(TDS_KEY_T), 0);
+    tds_deallocate(allocator, values, (size_t)capacity * sizeof(TDS_VALUE_T), 0);
+}
+
+// Appends an entry to the stash, growing it as needed.
+static void TDS_FUNCTION(_stash)(TDS_TYPE* map, TDS_KEY_T key, TDS_VALUE_T value) {
+    if (map->stash_count == map->stash_capacity) {
+        const TDS_SIZE_T capacity = map->stash_capacity ? map->stash_capacity * 2 : TDS_CUCKOO_STASH_SIZE;
+        map->stash_keys = tds_reallocate(
+            TDS_ALLOCATOR_OF(map),
+            map->stash_keys,
+            (size_t)map->stash_capacity * sizeof(TDS_KEY_T),
+            (size_t)capacity * sizeof(TDS_KEY_T),
+            0);
+        map->stash_values = tds_reallocate(
+            TDS_ALLOCATOR_OF(map),
+            map->stash_values,
+            (size_t)map->stash_capacity * sizeof(TDS_VALUE_T),
+            (size_t)capacity * sizeof(TDS_VALUE_T),
+            0);
+        map->stash_capacity = capacity;
+    }
+
+    map->stash_keys[map->stash_count] = key;
+    map->stash_values[map->stash_count] = value;
+    map->stash_count++;
+}
+
+// Looks for a chain of moves, each taking a key to its alternate bucket, that ends in a free slot and frees a slot in
+// `first` or `second`. Returns the bucket with the freed slot and stores the slot in `*freed`, or returns
+// `map->bucket_count` if no chain was found within TDS_CUCKOO_SEARCH_SIZE buckets.
+static TDS_SIZE_T TDS_FUNCTION(_make_room)(
+    TDS_TYPE* map,
+    const TDS_SIZE_T first,
+    const TDS_SIZE_T second,
+    unsigned* freed
+) {
+    struct {
+        TDS_SIZE_T bucket;
+        int parent; // Node whose key moves into this bucket, or -1 for `first` and `second`.
+        unsigned slot; // Slot of the moving key in the parent's bucket.
+    } nodes[TDS_CUCKOO_SEARCH_SIZE];
+
+    nodes[0].bucket = first;
+    nodes[0].parent = -1;
+    nodes[1].bucket = second;
+    nodes[1].parent = -1;
+    int count = 2;
+    for (int head = 0; head < count; head++) {
+        const TDS_BUCKET_T* bucket = map->buckets + nodes[head].bucket;
+        unsigned slot = TDS_FUNCTION(_free_slot)(bucket);
+        if (slot < TDS_CUCKOO_SLOTS) {
+            // Walk the chain back to its root, moving every key one step forward into the slot freed before it.
+            int node = head;
+            while (nodes[node].parent >= 0) {
+                const int parent = nodes[node].parent;
+                TDS_BUCKET_T* from = map->buckets + nodes[parent].bucket;
+                TDS_BUCKET_T* to = map->buckets + nodes[node].bucket;
+                const unsigned moving = nodes[node].slot;
+                const uint8_t tag = from->fields.tags[moving];
+
+                // A chain can pass through the same bucket twice, in which case an earlier move may have replaced the
+                // key this step expected. Stop there; every move done so far kept the table valid.
+                if (!tag || TDS_FUNCTION(_alternate)(map, nodes[parent].bucket, tag) != nodes[node].bucket) {
+                    return map->bucket_count;
+                }
+
+                TDS_FUNCTION(_place)(to, slot, tag, from->fields.keys[moving], from->fields.values[moving]);
+                from->fields.tags[moving] = 0;
+                slot = moving;
+                node = parent;
+            }
+
+            *freed = slot;
+            return nodes[node].bucket;
+        }
+
+        if (count + TDS_CUCKOO_SLOTS > TDS_CUCKOO_SEARCH_SIZE) {
+            continue;
+        }
+
+        for (unsigned i = 0; i < TDS_CUCKOO_SLOTS; i++) {
+            nodes[count].bucket = TDS_FUNCTION(_alternate)(map, nodes[head].bucket, bucket->fields.tags[i]);
+            nodes[count].parent = head;
+            nodes[count].slot = i;
+            count++;
+        }
+    }
+
+    return map->bucket_count;
+}
+
+// Inserts a key known not to be in the map.
+static void TDS_FUNCTION(_insert)(TDS_TYPE* map, TDS_KEY_T key, TDS_VALUE_T value, const uint64_t hash) {
+    // Check load factor > 0.9 by using integer math instead of floating-point math.
+    if (!map->buckets) {
+        TDS_FUNCTION(rehash)(map, TDS_FUNCTION(_bucket_count_for)(TDS_INITIAL_CAPACITY));
+    }
+    while (((size_t)map->count + 1) * 10 > (size_t)map->bucket_count * TDS_CUCKOO_SLOTS * 9) {
+        TDS_FUNCTION(rehash)(map, map->bucket_count * 2);
+    }
+
+    const uint8_t tag = TDS_FUNCTION(_tag)(hash);
+    while (1) {
+        const TDS_SIZE_T first = (TDS_SIZE_T)hash & (map->bucket_count - 1);
+        const TDS_SIZE_T second = TDS_FUNCTION(_alternate)(map, first, tag);
+
+        unsigned slot = TDS_FUNCTION(_free_slot)(map->buckets + first);
+        TDS_SIZE_T bucket = first;
+        if (slot == TDS_CUCKOO_SLOTS) {
+            slot = TDS_FUNCTION(_free_slot)(map->buckets + second);
+            bucket = second;
+        }
+        if (slot == TDS_CUCKOO_SLOTS) {
+            bucket = TDS_FUNCTION(_make_room)(map, first, second, &slot);
+            if (bucket == map->bucket_count) {
+                // Retry once in case the search was cut short by a chain through the same bucket twice.
+                bucket = TDS_FUNCTION(_make_room)(map, first, second, &slot);
+            }
+        }
+
+        if (bucket < map->bucket_count) {
+            TDS_FUNCTION(_place)(map->buckets + bucket, slot, tag, key, value);
+            map->count++;
+            return;
+        }
+
+        // No number of buckets separates keys that share a hash, so a table that's at most half full stops doubling
+        // and lets the stash grow instead.
+        if (map->stash_count < TDS_CUCKOO_STASH_SIZE
+            || (size_t)map->bucket_count * TDS_CUCKOO_SLOTS >= ((size_t)map->count + 1) * 2) {
+            TDS_FUNCTION(_stash)(map, key, value);
+            map->count++;
+            return;
+        }
+
+        TDS_FUNCTION(rehash)(map, map->bucket_count * 2);
+    }
+}
+
+static void TDS_FUNCTION(rehash)(TDS_TYPE* map, const TDS_SIZE_T bucket_count) {
+    TDS_ASSERT(bucket_count && (bucket_count & (bucket_count - 1)) == 0);
+
+    TDS_BUCKET_T* old_buckets = map->buckets;
+    const TDS_SIZE_T old_bucket_count = map->bucket_count;
+    TDS_KEY_T* stash_keys = map->stash_keys;
+    TDS_VALUE_T* stash_values = map->stash_values;
+    const TDS_SIZE_T stash_count = map->stash_count;
+    const TDS_SIZE_T stash_capacity = map->stash_capacity;
+
+    map->buckets = tds_allocate(TDS_ALLOCATOR_OF(map), (size_t)bucket_count * sizeof(TDS_BUCKET_T), TDS_ALIGNMENT);
+    map->bucket_count = bucket_count;
+    map->count = 0;
+    map->stash_count = 0;
+    map->stash_capacity = 0;
+    map->stash_keys = NULL;
+    map->stash_values = NULL;
+
+    // Reinserting may itself run out of room and rehash again, which is fine: this keeps inserting into whatever table
+    // the map ends up with.
+    for (TDS_SIZE_T i = 0; i < old_bucket_count; i++) {
+        TDS_BUCKET_T* bucket = old_buckets + i;
+        for (unsigned j = 0; j < TDS_CUCKOO_SLOTS; j++) {
+            if (bucket->fields.tags[j]) {
+                TDS_KEY_T key = bucket->fields.keys[j];
+                TDS_FUNCTION(_insert)(map, key, bucket->fields.values[j], TDS_HASH_KEY(key));
+            }
+        }
+    }
+    for (TDS_SIZE_T i = 0; i < stash_count; i++) {
+        TDS_KEY_T key = stash_keys[i];
+        TDS_FUNCTION(_insert)(map, key, stash_values[i], TDS_HASH_KEY(key));
+    }
+    TDS_FUNCTION(_free_stash)(TDS_ALLOCATOR_OF(map), stash_keys, stash_values, stash_capacity);
+
+    tds_deallocate(TDS_ALLOCATOR_OF(map), old_buckets, (size_t)old_bucket_count * sizeof(TDS_BUCKET_T), TDS_ALIGNMENT);
+}
+
+// Returns the value for `key`, whose hash is `hash`, or NULL if absent.
+static TDS_VALUE_T* TDS_FUNCTION(_lookup)(const TDS_TYPE* map, TDS_KEY_T key, const uint64_t hash) {
+    if (!map->buckets) {
+        return NULL;
+    }
+
+    const uint8_t tag = TDS_FUNCTION(_tag)(hash);
+    const TDS_SIZE_T first = (TDS_SIZE_T)hash & (map->bucket_count - 1);
+    TDS_BUCKET_T* bucket = map->buckets + first;
+    unsigned slot = TDS_FUNCTION(_find_in)(bucket, key, tag);
+    if (slot < TDS_CUCKOO_SLOTS) {
+        return bucket->fields.values + slot;
+    }
+
+    bucket = map->buckets + TDS_FUNCTION(_alternate)(map, first, tag);
+    slot = TDS_FUNCTION(_find_in)(bucket, key, tag);
+    if (slot < TDS_CUCKOO_SLOTS) {
+        return bucket->fields.values + slot;
+    }
+
+    for (TDS_SIZE_T i = 0; i < map->stash_count; i++) {
+        if (TDS_FUNCTION(_keys_equal)(map->stash_keys[i], key)) {
+            return map->stash_values + i;
+        }
+    }
+
+    return NULL;
+}
+
+TDS_VALUE_T* TDS_FUNCTION(get)(const TDS_TYPE* map, TDS_KEY_T key) {
+    return map->buckets ? TDS_FUNCTION(_lookup)(map, key, TDS_HASH_KEY(key)) : NULL;
+}
+
+void TDS_FUNCTION(reserve)(TDS_TYPE* map, const TDS_SIZE_T capacity) {
+    const TDS_SIZE_T bucket_count = TDS_FUNCTION(_bucket_count_for)(capacity);
+    if (bucket_count <= map->bucket_count) {
+        return;
+    }
+
+    TDS_FUNCTION(rehash)(map, bucket_count);
+}
+
+int TDS_FUNCTION(set)(TDS_TYPE* map, TDS_KEY_T key, TDS_VALUE_T value) {
+    // Hash once for both the lookup and the insertion.
+    const uint64_t hash = TDS_HASH_KEY(key);
+    TDS_VALUE_T* existing = TDS_FUNCTION(_lookup)(map, key, hash);
+    if (existing) {
+        // Key matches, update the value.
+        *existing = value;
+        return 0;
+    }
+
+    TDS_FUNCTION(_insert)(map, key, value, hash);
+    return 1;
+}
+
+TDS_JOIN2(TDS_TYPE, _iter_t) TDS_FUNCTION(iter)(const TDS_TYPE* map) {
+    return (TDS_JOIN2(TDS_TYPE, _iter_t)) {
+        .map = map,
+        ._index = 0,
+    };
+}
+
+char TDS_FUNCTION(next)(TDS_JOIN2(TDS_TYPE, _iter_t)* iter) {
+    const TDS_TYPE* map = iter->map;
+    const size_t slot_count = (size_t)map->bucket_count * TDS_CUCKOO_SLOTS;
+    while (iter->_index < slot_count) {
+        TDS_BUCKET_T* bucket = map->buckets + iter->_index / TDS_CUCKOO_SLOTS;
+        const unsigned slot = iter->_index++ % TDS_CUCKOO_SLOTS;
+        if (bucket->fields.tags[slot]) {
+            iter->key = bucket->fields.keys[slot];
+            iter->value = bucket->fields.values + slot;
+            return 1;
+        }
+    }
+
+    const TDS_SIZE_T stash_index = (TDS_SIZE_T)(iter->_index - slot_count);
+    if (stash_index < map->stash_count) {
+        iter->key = map->stash_keys[stash_index];
+        iter->value = map->stash_values + stash_index;
+        iter->_index++;
+        return 1;
+    }
+
+    return 0;
+}
+
+int TDS_FUNCTION(remove)(TDS_TYPE* map, TDS_KEY_T key) {
+    if (!map->buckets) {
+        return 0;
+    }
+
+    const uint64_t hash = TDS_HASH_KEY(key);
+    const uint8_t tag = TDS_FUNCTION(_tag)(hash);
+    const TDS_SIZE_T first = (TDS_SIZE_T)hash & (map->bucket_count - 1);
+    const TDS_SIZE_T candidates[2] = { first, TDS_FUNCTION(_alternate)(map, first, tag) };
+    for (unsigned i = 0; i < 2; i++) {
+        TDS_BUCKET_T* bucket = map->buckets + candidates[i];
+        const unsigned slot = TDS_FUNCTION(_find_in)(bucket, key, tag);
+        if (slot < TDS_CUCKOO_SLOTS) {
+#ifdef TDS_KEY_FINI
+            TDS_KEY_FINI((bucket->fields.keys[slot]));
+#endif
+#ifdef TDS_VALUE_FINI
+            TDS_VALUE_FINI((bucket->fields.values[slot]));
+#endif
+            bucket->fields.tags[slot] = 0;
+            map->count--;
+            return 1;
+        }
+    }
+
+    for (TDS_SIZE_T i = 0; i < map->stash_count; i++) {
+        if (TDS_FUNCTION(_keys_equal)(map->stash_keys[i], key)) {
+#ifdef TDS_KEY_FINI
+            TDS_KEY_FINI((map->stash_keys[i]));
+#endif
+#ifdef TDS_VALUE_FINI
+            TDS_VALUE_FINI((map->stash_values[i]));
+#endif
+            // Move the last stashed entry into the gap.
+            map->stash_count--;
+            map->stash_keys[i] = map->stash_keys[map->stash_count];
+            map->stash_values[i] = map->stash_values[map->stash_count];
+            map->count--;
+            return 1;
+        }
+    }
+
+    return 0;
+}
+
+TDS_SIZE_T TDS_FUNCTION(count)(const TDS_TYPE* map) {
+    return map->count;
+}
+
+void TDS_FUNCTION(clear)(TDS_TYPE* map) {
+#if defined(TDS_VALUE_FINI) || defined(TDS_KEY_FINI)
+    TDS_JOIN2(TDS_TYPE, _iter_t) it = TDS_FUNCTION(iter)(map);
+    while (TDS_FUNCTION(next)(&it)) {
+#ifdef TDS_KEY_FINI
+        TDS_KEY_FINI((it.key));
+#endif
+#ifdef TDS_VALUE_FINI
+        TDS_VALUE_FINI((*it.value));
+#endif
+    }
+#endif
+    if (map->buckets) {
+        TDS_MEMSET(map->buckets, 0, sizeof(TDS_BUCKET_T) * map->bucket_count);
+    }
+    map->count = 0;
+    map->stash_count = 0;
+}
+
+void TDS_FUNCTION(reclaim)(TDS_TYPE* map) {
+    if (map->count == 0) {
+        const size_t size = (size_t)map->bucket_count * sizeof(TDS_BUCKET_T);
+        tds_deallocate(TDS_ALLOCATOR_OF(map), map->buckets, size, TDS_ALIGNMENT);
+        TDS_FUNCTION(_free_stash)(TDS_ALLOCATOR_OF(map), map->stash_keys, map->stash_values, map->stash_capacity);
+        TDS_RESET(map);
+        return;
+    }
+
+    const TDS_SIZE_T bucket_count = TDS_FUNCTION(_bucket_count_for)(map->count);
+    if (bucket_count >= map->bucket_count) {
+        return;
+    }
+
+    TDS_FUNCTION(rehash)(map, bucket_count);
+}
+
+void TDS_FUNCTION(fini)(TDS_TYPE* map) {
+#if defined(TDS_VALUE_FINI) || defined(TDS_KEY_FINI)
+    TDS_JOIN2(TDS_TYPE, _iter_t) it = TDS_FUNCTION(iter)(map);
+    while (TDS_FUNCTION(next)(&it)) {
+#ifdef TDS_KEY_FINI
+        TDS_KEY_FINI(it.key);
+#endif
+#ifdef TDS_VALUE_FINI
+        TDS_VALUE_FINI(*it.value);
+#endif
+    }
+#endif
+    tds_deallocate(TDS_ALLOCATOR_OF(map), map->buckets, (size_t)map->bucket_count * sizeof(TDS_BUCKET_T), TDS_ALIGNMENT);
+    TDS_FUNCTION(_free_stash)(TDS_ALLOCATOR_OF(map), map->stash_keys, map->stash_values, map->stash_capacity);
+    TDS_RESET(map);
+}
+#endif
+
+#include "private/end.inc"
+
+#undef TDS_BUCKET_T
+#undef TDS_CUCKOO_BUCKET_SIZE
+#undef TDS_CUCKOO_SLOTS
+#undef TDS_CUCKOO_STASH_SIZE
+#undef TDS_CUCKOO_SEARCH_SIZE
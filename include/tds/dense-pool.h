@@ -5,10 +5,17 @@
 #define TDS_TYPE TDS_DEFAULT_TYPE_W_VALUE(dense_pool)
 #endif
 
+#ifndef TDS_ALIGNMENT
+#define TDS_ALIGNMENT 0
+#endif
+
 #ifdef TDS_DECLARE
 typedef struct TDS_TYPE {
     TDS_VALUE_T* array;
     TDS_SIZE_T* dense, *sparse, count, capacity;
+#ifdef TDS_ALLOCATOR
+    const tds_allocator_t* allocator;
+#endif
 } TDS_TYPE;
 
 TDS_SIZE_T TDS_FUNCTION(append)(TDS_TYPE* pool, TDS_VALUE_T value);
@@ -23,6 +30,33 @@ void TDS_FUNCTION(fini)(TDS_TYPE* pool);
 #endif
 
 #ifdef TDS_IMPLEMENT
+static void TDS_FUNCTION(_reallocate)(TDS_TYPE* pool, const TDS_SIZE_T capacity) {
+    pool->array = tds_reallocate(
+        TDS_ALLOCATOR_OF(pool),
+        pool->array,
+        pool->capacity * sizeof(*pool->array),
+        capacity * sizeof(*pool->array),
+        TDS_ALIGNMENT);
+    pool->dense = tds_reallocate(
+        TDS_ALLOCATOR_OF(pool),
+        pool->dense,
+        pool->capacity * sizeof(*pool->dense),
+        capacity * sizeof(*pool->dense),
+        TDS_ALIGNMENT);
+    pool->sparse = tds_reallocate(
+        TDS_ALLOCATOR_OF(pool),
+        pool->sparse,
+        pool->capacity * sizeof(*pool->sparse),
+        capacity * sizeof(*pool->sparse),
+        TDS_ALIGNMENT);
+}
+
+static void TDS_FUNCTION(_deallocate)(TDS_TYPE* pool) {
+    tds_deallocate(TDS_ALLOCATOR_OF(pool), pool->array, pool->capacity * sizeof(*pool->array), TDS_ALIGNMENT);
+    tds_deallocate(TDS_ALLOCATOR_OF(pool), pool->dense, pool->capacity * sizeof(*pool->dense), TDS_ALIGNMENT);
+    tds_deallocate(TDS_ALLOCATOR_OF(pool), pool->sparse, pool->capacity * sizeof(*pool->sparse), TDS_ALIGNMENT);
+}
+
 TDS_SIZE_T TDS_FUNCTION(append)(TDS_TYPE* pool, const TDS_VALUE_T value) {
     TDS_ASSERT(pool->count <= pool->capacity);
     // Guard against overflow.
@@ -56,9 +90,7 @@ void TDS_FUNCTION(reserve)(TDS_TYPE* pool, const TDS_SIZE_T capacity) {
     }
 
     const TDS_SIZE_T old_capacity = pool->capacity;
-    pool->array = TDS_REALLOC(pool->array, capacity * sizeof(*pool->array));
-    pool->dense = TDS_REALLOC(pool->dense, capacity * sizeof(*pool->dense));
-    pool->sparse = TDS_REALLOC(pool->sparse, capacity * sizeof(*pool->sparse));
+    TDS_FUNCTION(_reallocate)(pool, capacity);
     for (TDS_SIZE_T i = old_capacity; i < capacity; i++) {
         pool->dense[i] = TDS_MAX_VALUE(TDS_SIZE_T);
     }
@@ -126,10 +158,8 @@ void TDS_FUNCTION(reclaim)(TDS_TYPE* pool) {
     TDS_ASSERT(pool->count <= pool->capacity);
 
     if (pool->count == 0) {
-        TDS_FREE(pool->array);
-        TDS_FREE(pool->dense);
-        TDS_FREE(pool->sparse);
-        *pool = (TDS_TYPE){ 0 };
+        TDS_FUNCTION(_deallocate)(pool);
+        TDS_RESET(pool);
         return;
     }
 
@@ -144,9 +174,7 @@ void TDS_FUNCTION(reclaim)(TDS_TYPE* pool) {
         return;
     }
 
-    pool->array = TDS_REALLOC(pool->array, capacity * sizeof(*pool->array));
-    pool->dense = TDS_REALLOC(pool->dense, capacity * sizeof(*pool->dense));
-    pool->sparse = TDS_REALLOC(pool->sparse, capacity * sizeof(*pool->sparse));
+    TDS_FUNCTION(_reallocate)(pool, capacity);
 
     TDS_SIZE_T free_index = pool->count;
     for (TDS_SIZE_T i = 0; i < capacity; i++) {
@@ -167,10 +195,8 @@ void TDS_FUNCTION(fini)(TDS_TYPE* pool) {
         TDS_VALUE_FINI(pool->array[i]);
     }
 #endif
-    TDS_FREE(pool->array);
-    TDS_FREE(pool->dense);
-    TDS_FREE(pool->sparse);
-    *pool= (TDS_TYPE){ 0 };
+    TDS_FUNCTION(_deallocate)(pool);
+    TDS_RESET(pool);
 }
 #endif
 
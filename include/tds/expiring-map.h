@@ -0,0 +1,512 @@
+#include "private/common.h"
+#include "private/begin.inc"
+
+// A hash map whose entries can be given a time to live. Expiry times are kept in a hierarchical timing wheel next to the
+// hash index: TDS_WHEEL_LEVELS levels of 64 slots, where level `l` slots span 64^l ticks. Entries due soon sit in level
+// 0 and far away ones in higher levels, moving down as their time approaches. `advance` jumps straight between occupied
+// slots, so its cost depends on the number of entries that expire, not on the number of entries or elapsed ticks.
+// Entries due after the whole wheel has turned wait in an overflow list, which is rescanned at the start of every turn
+// in which one of them is due, so each far-future expiry also costs a pass over that list.
+//
+// Times are plain integers in whatever unit the caller chooses, and a tick is 2^TDS_EXPIRING_TICK_SHIFT of them.
+// Entries are removed by `advance` on the first tick boundary at or after their expiry time; until then, `get` treats
+// them as absent and removes them lazily.
+
+#ifndef TDS_TYPE
+#define TDS_TYPE TDS_DEFAULT_TYPE_W_KEY_VALUE(expiring_map)
+#endif
+
+#ifndef TDS_ALIGNMENT
+#define TDS_ALIGNMENT 0
+#endif
+
+#ifndef TDS_WHEEL_LEVELS
+#define TDS_WHEEL_LEVELS 4
+#endif
+
+#ifndef TDS_EXPIRING_TICK_SHIFT
+#define TDS_EXPIRING_TICK_SHIFT 0
+#endif
+
+#if TDS_WHEEL_LEVELS < 1 || TDS_WHEEL_LEVELS > 10
+#error "TDS_WHEEL_LEVELS must be between 1 and 10."
+#endif
+
+#define TDS_ENTRY_T TDS_JOIN2(TDS_TYPE, _entry)
+#define TDS_EXPIRING_NIL TDS_MAX_VALUE(TDS_SIZE_T)
+#define TDS_WHEEL_BITS 6
+#define TDS_WHEEL_SLOTS 64
+// The list of entries due after the whole wheel has turned, rescheduled at the start of the earliest turn any is due in.
+#define TDS_WHEEL_OVERFLOW (TDS_WHEEL_LEVELS * TDS_WHEEL_SLOTS)
+// Ticks in one turn of the whole wheel, as a shift.
+#define TDS_WHEEL_TURN_SHIFT (TDS_WHEEL_BITS * TDS_WHEEL_LEVELS)
+#define TDS_WHEEL_NONE 0xffff
+
+#ifdef TDS_DECLARE
+typedef struct TDS_ENTRY_T {
+    uint64_t hash;
+    uint64_t expiry; // UINT64_MAX for entries without a time to live.
+    TDS_KEY_T key;
+    TDS_VALUE_T value;
+    // Links of the wheel slot list the entry is in. Free entries are linked through `next`.
+    TDS_SIZE_T previous;
+    TDS_SIZE_T next;
+    uint16_t wheel; // Wheel slot list, or TDS_WHEEL_NONE.
+} TDS_ENTRY_T;
+
+typedef struct TDS_TYPE {
+    TDS_ENTRY_T* entries; // Entries never move, so the wheel refers to them by index.
+    TDS_SIZE_T* index; // Entry of every occupied index slot, TDS_EXPIRING_NIL for empty ones.
+    TDS_SIZE_T capacity;
+    TDS_SIZE_T index_capacity; // Always zero or a power of two, at least twice `count`.
+    TDS_SIZE_T count;
+    TDS_SIZE_T used; // Entries handed out at least once.
+    TDS_SIZE_T free;
+    uint64_t now;
+    uint64_t tick; // Every entry due before this tick is gone.
+    uint64_t occupied[TDS_WHEEL_LEVELS]; // Non-empty slots of every level.
+    uint64_t overflow_turn; // No entry in the overflow list is due in an earlier turn of the wheel.
+    TDS_SIZE_T wheel[TDS_WHEEL_LEVELS * TDS_WHEEL_SLOTS + 1];
+#ifdef TDS_ALLOCATOR
+    const tds_allocator_t* allocator;
+#endif
+} TDS_TYPE;
+
+typedef struct TDS_JOIN2(TDS_TYPE, _iter_t) {
+    const TDS_TYPE* map;
+    TDS_SIZE_T _index;
+    TDS_KEY_T key;
+    TDS_VALUE_T* value;
+} TDS_JOIN2(TDS_TYPE, _iter_t);
+
+TDS_VALUE_T* TDS_FUNCTION(get)(TDS_TYPE* map, TDS_KEY_T key);
+void TDS_FUNCTION(reserve)(TDS_TYPE* map, TDS_SIZE_T capacity);
+int TDS_FUNCTION(set)(TDS_TYPE* map, TDS_KEY_T key, TDS_VALUE_T value);
+int TDS_FUNCTION(set_ttl)(TDS_TYPE* map, TDS_KEY_T key, uint64_t ttl);
+TDS_SIZE_T TDS_FUNCTION(advance)(TDS_TYPE* map, uint64_t now);
+TDS_JOIN2(TDS_TYPE, _iter_t) TDS_FUNCTION(iter)(const TDS_TYPE* map);
+char TDS_FUNCTION(next)(TDS_JOIN2(TDS_TYPE, _iter_t)* iter);
+int TDS_FUNCTION(remove)(TDS_TYPE* map, TDS_KEY_T key);
+TDS_SIZE_T TDS_FUNCTION(count)(const TDS_TYPE* map);
+void TDS_FUNCTION(clear)(TDS_TYPE* map);
+void TDS_FUNCTION(fini)(TDS_TYPE* map);
+#endif
+
+#ifdef TDS_IMPLEMENT
+static int TDS_FUNCTION(_keys_equal)(TDS_KEY_T a, TDS_KEY_T b) {
+#ifdef TDS_KEY_EQUALS
+    return TDS_KEY_EQUALS(a, b);
+#else
+    return a == b;
+#endif
+}
+
+static void TDS_FUNCTION(_reset_wheel)(TDS_TYPE* map) {
+    for (unsigned i = 0; i < TDS_COUNTOF(map->wheel); i++) {
+        map->wheel[i] = TDS_EXPIRING_NIL;
+    }
+    for (unsigned i = 0; i < TDS_WHEEL_LEVELS; i++) {
+        map->occupied[i] = 0;
+    }
+    map->overflow_turn = UINT64_MAX;
+}
+
+// Returns the index slot holding the entry for `key`, or the empty slot where it would go.
+static TDS_SIZE_T TDS_FUNCTION(_find)(const TDS_TYPE* map, TDS_KEY_T key, const uint64_t hash) {
+    const TDS_SIZE_T mask = map->index_capacity - 1;
+    TDS_SIZE_T slot = (TDS_SIZE_T)hash & mask;
+    while (1) {
+        const TDS_SIZE_T entry = map->index[slot];
+        if (entry == TDS_EXPIRING_NIL
+            || (map->entries[entry].hash == hash && TDS_FUNCTION(_keys_equal)(map->entries[entry].key, key))) {
+            return slot;
+        }
+
+        slot = (slot + 1) & mask;
+    }
+}
+
+// Empties an index slot, shifting back the rest of its cluster instead of leaving a tombstone.
+static void TDS_FUNCTION(_unindex)(TDS_TYPE* map, TDS_SIZE_T gap) {
+    const TDS_SIZE_T mask = map->index_capacity - 1;
+    for (TDS_SIZE_T slot = (gap + 1) & mask; map->index[slot] != TDS_EXPIRING_NIL; slot = (slot + 1) & mask) {
+        const TDS_SIZE_T home = (TDS_SIZE_T)map->entries[map->index[slot]].hash & mask;
+        if (((gap - home) & mask) < ((slot - home) & mask)) {
+            map->index[gap] = map->index[slot];
+            gap = slot;
+        }
+    }
+    map->index[gap] = TDS_EXPIRING_NIL;
+}
+
+static void TDS_FUNCTION(_rebuild_index)(TDS_TYPE* map, const TDS_SIZE_T index_capacity) {
+    TDS_SIZE_T* old_index = map->index;
+    const TDS_SIZE_T old_capacity = map->index_capacity;
+    map->index = tds_allocate(TDS_ALLOCATOR_OF(map), (size_t)index_capacity * sizeof(TDS_SIZE_T), TDS_ALIGNMENT);
+    map->index_capacity = index_capacity;
+    for (TDS_SIZE_T i = 0; i < index_capacity; i++) {
+        map->index[i] = TDS_EXPIRING_NIL;
+    }
+
+    for (TDS_SIZE_T i = 0; i < old_capacity; i++) {
+        const TDS_SIZE_T entry = old_index[i];
+        if (entry != TDS_EXPIRING_NIL) {
+            const TDS_ENTRY_T* e = map->entries + entry;
+            map->index[TDS_FUNCTION(_find)(map, e->key, e->hash)] = entry;
+        }
+    }
+
+    tds_deallocate(TDS_ALLOCATOR_OF(map), old_index, (size_t)old_capacity * sizeof(TDS_SIZE_T), TDS_ALIGNMENT);
+}
+
+static void TDS_FUNCTION(_link)(TDS_TYPE* map, const TDS_SIZE_T entry, const unsigned list) {
+    TDS_ENTRY_T* e = map->entries + entry;
+    e->wheel = (uint16_t)list;
+    e->previous = TDS_EXPIRING_NIL;
+    e->next = map->wheel[list];
+    if (e->next != TDS_EXPIRING_NIL) {
+        map->entries[e->next].previous = entry;
+    }
+    map->wheel[list] = entry;
+    if (list < TDS_WHEEL_OVERFLOW) {
+        map->occupied[list / TDS_WHEEL_SLOTS] |= 1ull << (list % TDS_WHEEL_SLOTS);
+    }
+}
+
+static void TDS_FUNCTION(_unlink)(TDS_TYPE* map, const TDS_SIZE_T entry) {
+    TDS_ENTRY_T* e = map->entries + entry;
+    if (e->wheel == TDS_WHEEL_NONE) {
+        return;
+    }
+
+    if (e->previous != TDS_EXPIRING_NIL) {
+        map->entries[e->previous].next = e->next;
+    } else {
+        map->wheel[e->wheel] = e->next;
+        if (e->next == TDS_EXPIRING_NIL && e->wheel < TDS_WHEEL_OVERFLOW) {
+            map->occupied[e->wheel / TDS_WHEEL_SLOTS] &= ~(1ull << (e->wheel % TDS_WHEEL_SLOTS));
+        }
+    }
+    if (e->next != TDS_EXPIRING_NIL) {
+        map->entries[e->next].previous = e->previous;
+    }
+    e->wheel = TDS_WHEEL_NONE;
+}
+
+// The tick whose processing removes an entry expiring at `expiry`: the first one starting at or after it.
+static uint64_t TDS_FUNCTION(_due_tick)(const uint64_t expiry) {
+    return ((expiry - 1) >> TDS_EXPIRING_TICK_SHIFT) + 1;
+}
+
+// Puts an entry in the slot of the lowest level whose current window contains its due tick.
+static void TDS_FUNCTION(_schedule)(TDS_TYPE* map, const TDS_SIZE_T entry) {
+    const uint64_t due = TDS_FUNCTION(_due_tick)(map->entries[entry].expiry);
+    TDS_ASSERT(due >= map->tick);
+
+    const uint64_t difference = due ^ map->tick;
+    unsigned level = 0;
+    while (level < TDS_WHEEL_LEVELS && (difference >> (TDS_WHEEL_BITS * (level + 1))) != 0) {
+        level++;
+    }
+
+    if (level == TDS_WHEEL_LEVELS) {
+        // The bound left by removed entries is only kept while the list holds others.
+        const uint64_t turn = due >> TDS_WHEEL_TURN_SHIFT;
+        if (map->wheel[TDS_WHEEL_OVERFLOW] == TDS_EXPIRING_NIL || turn < map->overflow_turn) {
+            map->overflow_turn = turn;
+        }
+        TDS_FUNCTION(_link)(map, entry, TDS_WHEEL_OVERFLOW);
+    } else {
+        const unsigned slot = (unsigned)(due >> (TDS_WHEEL_BITS * level)) % TDS_WHEEL_SLOTS;
+        TDS_FUNCTION(_link)(map, entry, level * TDS_WHEEL_SLOTS + slot);
+    }
+}
+
+// Schedules the entries of a wheel slot list again, relative to the current tick.
+static void TDS_FUNCTION(_cascade)(TDS_TYPE* map, const unsigned list) {
+    TDS_SIZE_T entry = map->wheel[list];
+    map->wheel[list] = TDS_EXPIRING_NIL;
+    if (list < TDS_WHEEL_OVERFLOW) {
+        map->occupied[list / TDS_WHEEL_SLOTS] &= ~(1ull << (list % TDS_WHEEL_SLOTS));
+    }
+
+    while (entry != TDS_EXPIRING_NIL) {
+        const TDS_SIZE_T next = map->entries[entry].next;
+        TDS_FUNCTION(_schedule)(map, entry);
+        entry = next;
+    }
+}
+
+static void TDS_FUNCTION(_erase)(TDS_TYPE* map, const TDS_SIZE_T slot) {
+    const TDS_SIZE_T entry = map->index[slot];
+    TDS_ENTRY_T* e = map->entries + entry;
+    TDS_FUNCTION(_unindex)(map, slot);
+    TDS_FUNCTION(_unlink)(map, entry);
+#ifdef TDS_KEY_FINI
+    TDS_KEY_FINI((e->key));
+#endif
+#ifdef TDS_VALUE_FINI
+    TDS_VALUE_FINI((e->value));
+#endif
+    e->next = map->free;
+    map->free = entry;
+    map->count--;
+}
+
+// Returns the index slot of a live entry for `key`, or TDS_EXPIRING_NIL. Expired entries found on the way are erased.
+static TDS_SIZE_T TDS_FUNCTION(_lookup)(TDS_TYPE* map, TDS_KEY_T key) {
+    if (!map->count) {
+        return TDS_EXPIRING_NIL;
+    }
+
+    const TDS_SIZE_T slot = TDS_FUNCTION(_find)(map, key, TDS_HASH_KEY(key));
+    const TDS_SIZE_T entry = map->index[slot];
+    if (entry == TDS_EXPIRING_NIL) {
+        return TDS_EXPIRING_NIL;
+    }
+
+    if (map->entries[entry].expiry <= map->now) {
+        TDS_FUNCTION(_erase)(map, slot);
+        return TDS_EXPIRING_NIL;
+    }
+
+    return slot;
+}
+
+TDS_VALUE_T* TDS_FUNCTION(get)(TDS_TYPE* map, TDS_KEY_T key) {
+    const TDS_SIZE_T slot = TDS_FUNCTION(_lookup)(map, key);
+    return slot != TDS_EXPIRING_NIL ? &map->entries[map->index[slot]].value : NULL;
+}
+
+// Makes room for at least `capacity` entries.
+void TDS_FUNCTION(reserve)(TDS_TYPE* map, const TDS_SIZE_T capacity) {
+    if (!map->entries) {
+        TDS_FUNCTION(_reset_wheel)(map);
+        map->free = TDS_EXPIRING_NIL;
+    }
+
+    if (capacity > map->capacity) {
+        map->entries = tds_reallocate(
+            TDS_ALLOCATOR_OF(map),
+            map->entries,
+            (size_t)map->capacity * sizeof(TDS_ENTRY_T),
+            (size_t)capacity * sizeof(TDS_ENTRY_T),
+            TDS_ALIGNMENT);
+        map->capacity = capacity;
+    }
+
+    TDS_SIZE_T index_capacity = map->index_capacity ? map->index_capacity : 2;
+    while (index_capacity < (size_t)capacity * 2) {
+        index_capacity *= 2;
+    }
+    if (index_capacity > map->index_capacity) {
+        TDS_FUNCTION(_rebuild_index)(map, index_capacity);
+    }
+}
+
+// Inserts or replaces the value for `key`. New keys don't expire, and replacing a value keeps its time to live.
+// Returns nonzero if the key was inserted.
+int TDS_FUNCTION(set)(TDS_TYPE* map, TDS_KEY_T key, TDS_VALUE_T value) {
+    TDS_SIZE_T slot = TDS_FUNCTION(_lookup)(map, key);
+    if (slot != TDS_EXPIRING_NIL) {
+        // Key matches, update the value.
+        map->entries[map->index[slot]].value = value;
+        return 0;
+    }
+
+    if (!map->entries) {
+        TDS_FUNCTION(reserve)(map, TDS_INITIAL_CAPACITY);
+    } else if (map->free == TDS_EXPIRING_NIL && map->used == map->capacity) {
+        TDS_FUNCTION(reserve)(map, map->capacity * 2);
+    }
+
+    TDS_SIZE_T entry;
+    if (map->free != TDS_EXPIRING_NIL) {
+        entry = map->free;
+        map->free = map->entries[entry].next;
+    } else {
+        entry = map->used++;
+    }
+
+    const uint64_t hash = TDS_HASH_KEY(key);
+    map->entries[entry] = (TDS_ENTRY_T){
+        .hash = hash,
+        .expiry = UINT64_MAX,
+        .key = key,
+        .value = value,
+        .wheel = TDS_WHEEL_NONE,
+    };
+    map->index[TDS_FUNCTION(_find)(map, key, hash)] = entry;
+    map->count++;
+    return 1;
+}
+
+// Makes `key` expire `ttl` time units after the time of the last `advance`. A zero TTL removes the entry right away.
+// Returns zero if the key is absent.
+int TDS_FUNCTION(set_ttl)(TDS_TYPE* map, TDS_KEY_T key, const uint64_t ttl) {
+    const TDS_SIZE_T slot = TDS_FUNCTION(_lookup)(map, key);
+    if (slot == TDS_EXPIRING_NIL) {
+        return 0;
+    }
+
+    if (ttl == 0) {
+        TDS_FUNCTION(_erase)(map, slot);
+        return 1;
+    }
+
+    const TDS_SIZE_T entry = map->index[slot];
+    TDS_FUNCTION(_unlink)(map, entry);
+    map->entries[entry].expiry = ttl < UINT64_MAX - map->now ? map->now + ttl : UINT64_MAX;
+    if (map->entries[entry].expiry != UINT64_MAX) {
+        TDS_FUNCTION(_schedule)(map, entry);
+    }
+    return 1;
+}
+
+// Moves the clock forward to `now` and removes the entries due by then. Returns the number of entries removed.
+TDS_SIZE_T TDS_FUNCTION(advance)(TDS_TYPE* map, const uint64_t now) {
+    TDS_ASSERT(now >= map->now);
+    map->now = now;
+
+    const uint64_t target = (now >> TDS_EXPIRING_TICK_SHIFT) + 1;
+    TDS_SIZE_T expired = 0;
+    while (map->tick < target && map->entries) {
+        // Find the next tick that has something to do: expiring the entries of a level 0 slot, or moving the entries
+        // of a higher level slot down when its span begins.
+        const uint64_t tick = map->tick;
+        uint64_t next = UINT64_MAX;
+        for (unsigned level = 0; level < TDS_WHEEL_LEVELS; level++) {
+            const unsigned shift = TDS_WHEEL_BITS * level;
+            const uint64_t slots = map->occupied[level] & (~0ull << ((tick >> shift) % TDS_WHEEL_SLOTS));
+            if (slots) {
+                const uint64_t window = tick >> shift >> TDS_WHEEL_BITS << TDS_WHEEL_BITS;
+                uint64_t start = (window + tds_lowest_bit(slots)) << shift;
+                start = start > tick ? start : tick;
+                next = start < next ? start : next;
+            }
+        }
+        // Overflow entries are always due in a later turn than the current tick, so the turn starts after it.
+        if (map->wheel[TDS_WHEEL_OVERFLOW] != TDS_EXPIRING_NIL) {
+            const uint64_t start = map->overflow_turn << TDS_WHEEL_TURN_SHIFT;
+            next = start < next ? start : next;
+        }
+
+        if (next >= target) {
+            map->tick = target;
+            break;
+        }
+
+        map->tick = next;
+        if (map->wheel[TDS_WHEEL_OVERFLOW] != TDS_EXPIRING_NIL
+            && next == map->overflow_turn << TDS_WHEEL_TURN_SHIFT) {
+            TDS_FUNCTION(_cascade)(map, TDS_WHEEL_OVERFLOW);
+        }
+        for (unsigned level = TDS_WHEEL_LEVELS - 1; level > 0; level--) {
+            const unsigned shift = TDS_WHEEL_BITS * level;
+            if ((next & (((uint64_t)1 << shift) - 1)) == 0) {
+                TDS_FUNCTION(_cascade)(map, level * TDS_WHEEL_SLOTS + (unsigned)(next >> shift) % TDS_WHEEL_SLOTS);
+            }
+        }
+
+        const unsigned list = (unsigned)(next % TDS_WHEEL_SLOTS);
+        while (map->wheel[list] != TDS_EXPIRING_NIL) {
+            const TDS_ENTRY_T* e = map->entries + map->wheel[list];
+            TDS_ASSERT(TDS_FUNCTION(_due_tick)(e->expiry) == next);
+            TDS_FUNCTION(_erase)(map, TDS_FUNCTION(_find)(map, e->key, e->hash));
+            expired++;
+        }
+        map->tick = next + 1;
+    }
+
+    if (!map->entries) {
+        map->tick = target;
+    }
+    return expired;
+}
+
+TDS_JOIN2(TDS_TYPE, _iter_t) TDS_FUNCTION(iter)(const TDS_TYPE* map) {
+    return (TDS_JOIN2(TDS_TYPE, _iter_t)) {
+        .map = map,
+        ._index = 0,
+    };
+}
+
+// Visits the live entries in no particular order. Expired entries are skipped but not removed.
+char TDS_FUNCTION(next)(TDS_JOIN2(TDS_TYPE, _iter_t)* iter) {
+    const TDS_TYPE* map = iter->map;
+    while (iter->_index < map->index_capacity) {
+        const TDS_SIZE_T entry = map->index[iter->_index++];
+        if (entry != TDS_EXPIRING_NIL && map->entries[entry].expiry > map->now) {
+            iter->key = map->entries[entry].key;
+            iter->value = &map->entries[entry].value;
+            return 1;
+        }
+    }
+
+    return 0;
+}
+
+int TDS_FUNCTION(remove)(TDS_TYPE* map, TDS_KEY_T key) {
+    if (!map->count) {
+        return 0;
+    }
+
+    const TDS_SIZE_T slot = TDS_FUNCTION(_find)(map, key, TDS_HASH_KEY(key));
+    if (map->index[slot] == TDS_EXPIRING_NIL) {
+        return 0;
+    }
+
+    // An expired entry still counts as absent.
+    const int live = map->entries[map->index[slot]].expiry > map->now;
+    TDS_FUNCTION(_erase)(map, slot);
+    return live;
+}
+
+// Includes expired entries that `advance` or a lookup haven't removed yet.
+TDS_SIZE_T TDS_FUNCTION(count)(const TDS_TYPE* map) {
+    return map->count;
+}
+
+// Removes all entries but keeps the storage and the clock.
+void TDS_FUNCTION(clear)(TDS_TYPE* map) {
+    if (!map->entries) {
+        return;
+    }
+
+    for (TDS_SIZE_T i = 0; i < map->index_capacity; i++) {
+#if defined(TDS_VALUE_FINI) || defined(TDS_KEY_FINI)
+        if (map->index[i] != TDS_EXPIRING_NIL) {
+#ifdef TDS_KEY_FINI
+            TDS_KEY_FINI((map->entries[map->index[i]].key));
+#endif
+#ifdef TDS_VALUE_FINI
+            TDS_VALUE_FINI((map->entries[map->index[i]].value));
+#endif
+        }
+#endif
+        map->index[i] = TDS_EXPIRING_NIL;
+    }
+    TDS_FUNCTION(_reset_wheel)(map);
+    map->count = 0;
+    map->used = 0;
+    map->free = TDS_EXPIRING_NIL;
+}
+
+void TDS_FUNCTION(fini)(TDS_TYPE* map) {
+    TDS_FUNCTION(clear)(map);
+    tds_deallocate(TDS_ALLOCATOR_OF(map), map->entries, (size_t)map->capacity * sizeof(TDS_ENTRY_T), TDS_ALIGNMENT);
+    tds_deallocate(TDS_ALLOCATOR_OF(map), map->index, (size_t)map->index_capacity * sizeof(TDS_SIZE_T), TDS_ALIGNMENT);
+    TDS_RESET(map);
+}
+#endif
+
+#include "private/end.inc"
+
+#undef TDS_EXPIRING_NIL
+#undef TDS_WHEEL_BITS
+#undef TDS_WHEEL_SLOTS
+#undef TDS_WHEEL_OVERFLOW
+#undef TDS_WHEEL_TURN_SHIFT
+#undef TDS_WHEEL_NONE
+#undef TDS_WHEEL_LEVELS
+#undef TDS_EXPIRING_TICK_SHIFT
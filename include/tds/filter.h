@@ -0,0 +1,320 @@
+#include "private/common.h"
+#include "private/begin.inc"
+
+// Approximate membership filters. They answer "definitely not present" or "probably present" in a few bits per key.
+// By default this generates a blocked Bloom filter, which keys can be added to one by one. Define TDS_XOR_FILTER to
+// generate a static xor filter instead, built once from an array of keys. Both hash keys with TDS_HASH_KEY.
+
+#include <stdlib.h>
+
+#ifndef TDS_TYPE
+#ifdef TDS_XOR_FILTER
+#define TDS_TYPE TDS_JOIN4(TDS_PREFIX, xor_filter, _, TDS_KEY_T)
+#else
+#define TDS_TYPE TDS_JOIN4(TDS_PREFIX, bloom_filter, _, TDS_KEY_T)
+#endif
+#endif
+
+#ifndef TDS_ALIGNMENT
+#ifdef TDS_XOR_FILTER
+#define TDS_ALIGNMENT 0
+#else
+#define TDS_ALIGNMENT TDS_CACHE_LINE_SIZE
+#endif
+#endif
+
+// Bits of Bloom filter storage per expected key. 10 bits give a false positive rate of about 1%.
+#ifndef TDS_FILTER_BITS_PER_KEY
+#define TDS_FILTER_BITS_PER_KEY 10
+#endif
+
+// Keys a Bloom filter is sized for when it's added to without being reserved first, since it can't grow later.
+#ifndef TDS_FILTER_DEFAULT_CAPACITY
+#define TDS_FILTER_DEFAULT_CAPACITY 1024
+#endif
+
+// A Bloom filter block is a 64-byte cache line of 8 words. Every key sets one bit in each word of its block.
+#define TDS_FILTER_BLOCK_WORDS 8
+#define TDS_FILTER_BLOCK_BITS (TDS_FILTER_BLOCK_WORDS * 64)
+
+// Construction of an xor filter fails with a small probability for a given seed and is retried with another one.
+#define TDS_FILTER_MAX_ATTEMPTS 64
+
+#ifdef TDS_DECLARE
+#ifdef TDS_XOR_FILTER
+typedef struct TDS_TYPE {
+    uint8_t* fingerprints; // Three blocks of `block_length` fingerprints.
+    uint64_t seed;
+    TDS_SIZE_T block_length;
+    TDS_SIZE_T count;
+#ifdef TDS_ALLOCATOR
+    const tds_allocator_t* allocator;
+#endif
+} TDS_TYPE;
+
+int TDS_FUNCTION(build)(TDS_TYPE* filter, const TDS_KEY_T* keys, TDS_SIZE_T count);
+#else
+typedef struct TDS_TYPE {
+    uint64_t* words;
+    TDS_SIZE_T block_count;
+    TDS_SIZE_T count;
+#ifdef TDS_ALLOCATOR
+    const tds_allocator_t* allocator;
+#endif
+} TDS_TYPE;
+
+void TDS_FUNCTION(reserve)(TDS_TYPE* filter, TDS_SIZE_T count);
+void TDS_FUNCTION(add)(TDS_TYPE* filter, TDS_KEY_T key);
+void TDS_FUNCTION(clear)(TDS_TYPE* filter);
+#endif
+
+int TDS_FUNCTION(contains)(const TDS_TYPE* filter, TDS_KEY_T key);
+TDS_SIZE_T TDS_FUNCTION(count)(const TDS_TYPE* filter);
+void TDS_FUNCTION(fini)(TDS_TYPE* filter);
+#endif
+
+#ifdef TDS_IMPLEMENT
+#ifdef TDS_XOR_FILTER
+static int TDS_FUNCTION(_compare)(const void* a, const void* b) {
+    const uint64_t x = *(const uint64_t*)a, y = *(const uint64_t*)b;
+    return (x > y) - (x < y);
+}
+
+// Position of one of the three fingerprints a hash maps to. Each one lives in its own block.
+static TDS_SIZE_T TDS_FUNCTION(_position)(const uint64_t hash, const unsigned i, const TDS_SIZE_T block_length) {
+    const uint64_t rotated = i ? (hash << (21 * i)) | (hash >> (64 - 21 * i)) : hash;
+    return (TDS_SIZE_T)(((rotated & 0xffffffff) * block_length) >> 32) + i * block_length;
+}
+
+static uint8_t TDS_FUNCTION(_fingerprint)(const uint64_t hash) {
+    return (uint8_t)(hash ^ (hash >> 32));
+}
+
+// Builds the filter from `keys`, replacing its previous contents. Duplicate keys are allowed. Returns zero if no
+// working seed was found, which is astronomically unlikely; the filter is left empty in that case.
+int TDS_FUNCTION(build)(TDS_TYPE* filter, const TDS_KEY_T* keys, const TDS_SIZE_T count) {
+    const tds_allocator_t* allocator = TDS_ALLOCATOR_OF(filter);
+    TDS_FUNCTION(fini)(filter);
+
+    // Peeling never gets past duplicates, so work on the unique hashes.
+    uint64_t* hashes = tds_allocate(allocator, ((size_t)count + 1) * sizeof(uint64_t), 0);
+    for (TDS_SIZE_T i = 0; i < count; i++) {
+        TDS_KEY_T key = keys[i];
+        hashes[i] = TDS_HASH_KEY(key);
+    }
+    qsort(hashes, count, sizeof(uint64_t), TDS_FUNCTION(_compare));
+
+    TDS_SIZE_T unique = 0;
+    for (TDS_SIZE_T i = 0; i < count; i++) {
+        if (unique == 0 || hashes[i] != hashes[unique - 1]) {
+            hashes[unique++] = hashes[i];
+        }
+    }
+
+    // 1.23 slots per key is enough for peeling to succeed with high probability.
+    const TDS_SIZE_T block_length = (TDS_SIZE_T)((32 + (size_t)unique * 123 / 100) / 3 + 1);
+    const size_t length = (size_t)block_length * 3;
+    uint64_t* masks = tds_allocate(allocator, length * sizeof(uint64_t), 0);
+    uint32_t* counts = tds_allocate(allocator, length * sizeof(uint32_t), 0);
+    TDS_SIZE_T* queue = tds_allocate(allocator, length * sizeof(TDS_SIZE_T), 0);
+    uint64_t* stack_hashes = tds_allocate(allocator, ((size_t)unique + 1) * sizeof(uint64_t), 0);
+    TDS_SIZE_T* stack_positions = tds_allocate(allocator, ((size_t)unique + 1) * sizeof(TDS_SIZE_T), 0);
+
+    uint64_t seed = 0x9e3779b97f4a7c15ull;
+    TDS_SIZE_T stack_count = 0;
+    for (unsigned attempt = 0; attempt < TDS_FILTER_MAX_ATTEMPTS; attempt++) {
+        TDS_MEMSET(masks, 0, length * sizeof(uint64_t));
+        TDS_MEMSET(counts, 0, length * sizeof(uint32_t));
+        for (TDS_SIZE_T i = 0; i < unique; i++) {
+            const uint64_t hash = tds_mix64(hashes[i] + seed);
+            for (unsigned j = 0; j < 3; j++) {
+                const TDS_SIZE_T position = TDS_FUNCTION(_position)(hash, j, block_length);
+                masks[position] ^= hash;
+                counts[position]++;
+            }
+        }
+
+        // Repeatedly take out the keys that are alone in one of their slots.
+        size_t queue_count = 0;
+        for (size_t i = 0; i < length; i++) {
+            if (counts[i] == 1) {
+                queue[queue_count++] = (TDS_SIZE_T)i;
+            }
+        }
+
+        stack_count = 0;
+        while (queue_count) {
+            const TDS_SIZE_T position = queue[--queue_count];
+            if (counts[position] != 1) {
+                continue;
+            }
+
+            const uint64_t hash = masks[position];
+            stack_hashes[stack_count] = hash;
+            stack_positions[stack_count] = position;
+            stack_count++;
+            for (unsigned j = 0; j < 3; j++) {
+                const TDS_SIZE_T other = TDS_FUNCTION(_position)(hash, j, block_length);
+                masks[other] ^= hash;
+                if (--counts[other] == 1) {
+                    queue[queue_count++] = other;
+                }
+            }
+        }
+
+        if (stack_count == unique) {
+            break;
+        }
+        seed = tds_mix64(seed + attempt + 1);
+    }
+
+    int result = 0;
+    if (stack_count == unique) {
+        // Assign fingerprints in reverse peeling order, so every key's three slots XOR to its fingerprint.
+        filter->fingerprints = tds_allocate(allocator, length, TDS_ALIGNMENT);
+        for (TDS_SIZE_T i = stack_count; i-- > 0;) {
+            const uint64_t hash = stack_hashes[i];
+            uint8_t fingerprint = TDS_FUNCTION(_fingerprint)(hash);
+            for (unsigned j = 0; j < 3; j++) {
+                fingerprint ^= filter->fingerprints[TDS_FUNCTION(_position)(hash, j, block_length)];
+            }
+            filter->fingerprints[stack_positions[i]] = fingerprint;
+        }
+
+        filter->seed = seed;
+        filter->block_length = block_length;
+        filter->count = unique;
+        result = 1;
+    }
+
+    tds_deallocate(allocator, hashes, ((size_t)count + 1) * sizeof(uint64_t), 0);
+    tds_deallocate(allocator, masks, length * sizeof(uint64_t), 0);
+    tds_deallocate(allocator, counts, length * sizeof(uint32_t), 0);
+    tds_deallocate(allocator, queue, length * sizeof(TDS_SIZE_T), 0);
+    tds_deallocate(allocator, stack_hashes, ((size_t)unique + 1) * sizeof(uint64_t), 0);
+    tds_deallocate(allocator, stack_positions, ((size_t)unique + 1) * sizeof(TDS_SIZE_T), 0);
+    return result;
+}
+
+int TDS_FUNCTION(contains)(const TDS_TYPE* filter, TDS_KEY_T key) {
+    if (!filter->fingerprints) {
+        return 0;
+    }
+
+    const uint64_t hash = tds_mix64(TDS_HASH_KEY(key) + filter->seed);
+    return TDS_FUNCTION(_fingerprint)(hash) == (
+        filter->fingerprints[TDS_FUNCTION(_position)(hash, 0, filter->block_length)] ^
+        filter->fingerprints[TDS_FUNCTION(_position)(hash, 1, filter->block_length)] ^
+        filter->fingerprints[TDS_FUNCTION(_position)(hash, 2, filter->block_length)]);
+}
+
+TDS_SIZE_T TDS_FUNCTION(count)(const TDS_TYPE* filter) {
+    return filter->count;
+}
+
+void TDS_FUNCTION(fini)(TDS_TYPE* filter) {
+    tds_deallocate(TDS_ALLOCATOR_OF(filter), filter->fingerprints, (size_t)filter->block_length * 3, TDS_ALIGNMENT);
+    TDS_RESET(filter);
+}
+#else
+// Returns the block of `hash`. The high half of the hash picks the block, the low half the bits inside it.
+static const uint64_t* TDS_FUNCTION(_block)(const TDS_TYPE* filter, const uint64_t hash) {
+    const uint64_t index = ((hash >> 32) * filter->block_count) >> 32;
+    return filter->words + index * TDS_FILTER_BLOCK_WORDS;
+}
+
+// Computes the bit set in each word of the block. No loop-carried dependencies, so it vectorizes.
+static void TDS_FUNCTION(_mask)(const uint64_t hash, uint64_t* mask) {
+    static const uint32_t salts[TDS_FILTER_BLOCK_WORDS] = {
+        0x47b6137b, 0x44974d91, 0x8824ad5b, 0xa2b7289d, 0x705495c7, 0x2df1424b, 0x9efc4947, 0x5c6bfb31,
+    };
+
+    for (unsigned i = 0; i < TDS_FILTER_BLOCK_WORDS; i++) {
+        mask[i] = (uint64_t)1 << (((uint32_t)hash * salts[i]) >> 26);
+    }
+}
+
+// Sizes the filter for `count` keys. A Bloom filter can't be resized once keys are in it, so this only has an effect on
+// a filter that has never been added to.
+void TDS_FUNCTION(reserve)(TDS_TYPE* filter, const TDS_SIZE_T count) {
+    if (filter->words) {
+        return;
+    }
+
+    size_t block_count = ((size_t)count * TDS_FILTER_BITS_PER_KEY + TDS_FILTER_BLOCK_BITS - 1) / TDS_FILTER_BLOCK_BITS;
+    if (block_count == 0) {
+        block_count = 1;
+    }
+    TDS_ASSERT(block_count <= 0xffffffff);
+
+    filter->words = tds_allocate(
+        TDS_ALLOCATOR_OF(filter),
+        block_count * TDS_FILTER_BLOCK_WORDS * sizeof(uint64_t),
+        TDS_ALIGNMENT);
+    filter->block_count = (TDS_SIZE_T)block_count;
+}
+
+void TDS_FUNCTION(add)(TDS_TYPE* filter, TDS_KEY_T key) {
+    if (!filter->words) {
+        TDS_FUNCTION(reserve)(filter, TDS_FILTER_DEFAULT_CAPACITY);
+    }
+
+    const uint64_t hash = TDS_HASH_KEY(key);
+    uint64_t* block = (uint64_t*)TDS_FUNCTION(_block)(filter, hash);
+    uint64_t mask[TDS_FILTER_BLOCK_WORDS];
+    TDS_FUNCTION(_mask)(hash, mask);
+    for (unsigned i = 0; i < TDS_FILTER_BLOCK_WORDS; i++) {
+        block[i] |= mask[i];
+    }
+    filter->count++;
+}
+
+int TDS_FUNCTION(contains)(const TDS_TYPE* filter, TDS_KEY_T key) {
+    if (!filter->words) {
+        return 0;
+    }
+
+    const uint64_t hash = TDS_HASH_KEY(key);
+    const uint64_t* block = TDS_FUNCTION(_block)(filter, hash);
+    uint64_t mask[TDS_FILTER_BLOCK_WORDS];
+    TDS_FUNCTION(_mask)(hash, mask);
+
+    // Test the whole block at once instead of stopping at the first missing bit.
+    uint64_t missing = 0;
+    for (unsigned i = 0; i < TDS_FILTER_BLOCK_WORDS; i++) {
+        missing |= mask[i] & ~block[i];
+    }
+    return missing == 0;
+}
+
+// Number of keys added so far, duplicates included.
+TDS_SIZE_T TDS_FUNCTION(count)(const TDS_TYPE* filter) {
+    return filter->count;
+}
+
+void TDS_FUNCTION(clear)(TDS_TYPE* filter) {
+    if (filter->words) {
+        TDS_MEMSET(filter->words, 0, (size_t)filter->block_count * TDS_FILTER_BLOCK_WORDS * sizeof(uint64_t));
+    }
+    filter->count = 0;
+}
+
+void TDS_FUNCTION(fini)(TDS_TYPE* filter) {
+    tds_deallocate(
+        TDS_ALLOCATOR_OF(filter),
+        filter->words,
+        (size_t)filter->block_count * TDS_FILTER_BLOCK_WORDS * sizeof(uint64_t),
+        TDS_ALIGNMENT);
+    TDS_RESET(filter);
+}
+#endif
+#endif
+
+#include "private/end.inc"
+
+#undef TDS_XOR_FILTER
+#undef TDS_FILTER_BITS_PER_KEY
+#undef TDS_FILTER_DEFAULT_CAPACITY
+#undef TDS_FILTER_BLOCK_WORDS
+#undef TDS_FILTER_BLOCK_BITS
+#undef TDS_FILTER_MAX_ATTEMPTS
@@ -5,7 +5,22 @@
 #define TDS_TYPE TDS_DEFAULT_TYPE_W_KEY_VALUE(hashmap)
 #endif
 
+#ifndef TDS_ALIGNMENT
+#define TDS_ALIGNMENT TDS_CACHE_LINE_SIZE
+#endif
+
+#if defined(TDS_INLINE_CAPACITY) && TDS_INLINE_CAPACITY < 1
+#error "TDS_INLINE_CAPACITY must be at least 1."
+#endif
+
 #define TDS_ENTRY_T TDS_JOIN2(TDS_TYPE, _entry)
+#define TDS_FROZEN_T TDS_JOIN2(TDS_TYPE, _frozen_t)
+
+// Average number of keys per displacement bucket of a frozen map. Fewer keys per bucket make freezing faster and the
+// pilot table bigger.
+#ifndef TDS_FROZEN_KEYS_PER_BUCKET
+#define TDS_FROZEN_KEYS_PER_BUCKET 4
+#endif
 
 #ifdef TDS_DECLARE
 typedef struct TDS_ENTRY_T {
@@ -17,9 +32,17 @@ typedef struct TDS_ENTRY_T {
 } TDS_ENTRY_T;
 
 typedef struct TDS_TYPE {
-    TDS_ENTRY_T* buckets;
+    TDS_ENTRY_T* buckets; // NULL while the entries live in `inline_keys` and `inline_values`.
     TDS_SIZE_T count;
     TDS_SIZE_T capacity; // Always a prime number.
+#ifdef TDS_INLINE_CAPACITY
+    // Keys are kept apart from the values so that scanning them touches as little memory as possible.
+    TDS_KEY_T inline_keys[TDS_INLINE_CAPACITY];
+    TDS_VALUE_T inline_values[TDS_INLINE_CAPACITY];
+#endif
+#ifdef TDS_ALLOCATOR
+    const tds_allocator_t* allocator;
+#endif
 } TDS_TYPE;
 
 typedef struct TDS_JOIN2(TDS_TYPE, _iter_t) {
@@ -29,6 +52,19 @@ typedef struct TDS_JOIN2(TDS_TYPE, _iter_t) {
     TDS_VALUE_T* value;
 } TDS_JOIN2(TDS_TYPE, _iter_t);
 
+// Read-only snapshot of a map, indexed by a minimal perfect hash: every key has exactly one slot and there are no empty
+// ones. Keys and values are shallow copies owned by the map it was frozen from.
+typedef struct TDS_FROZEN_T {
+    TDS_KEY_T* keys;
+    TDS_VALUE_T* values;
+    uint32_t* pilots; // Per displacement bucket, the seed that sends its keys to free slots.
+    TDS_SIZE_T count;
+    TDS_SIZE_T bucket_count;
+#ifdef TDS_ALLOCATOR
+    const tds_allocator_t* allocator;
+#endif
+} TDS_FROZEN_T;
+
 TDS_VALUE_T* TDS_FUNCTION(get)(const TDS_TYPE* map, TDS_KEY_T key);
 void TDS_FUNCTION(reserve)(TDS_TYPE* map, TDS_SIZE_T capacity);
 int TDS_FUNCTION(set)(TDS_TYPE* map, TDS_KEY_T key, TDS_VALUE_T value);
@@ -39,6 +75,11 @@ TDS_SIZE_T TDS_FUNCTION(count)(const TDS_TYPE* map);
 void TDS_FUNCTION(clear)(TDS_TYPE* map);
 void TDS_FUNCTION(reclaim)(TDS_TYPE* map);
 void TDS_FUNCTION(fini)(TDS_TYPE* map);
+char TDS_FUNCTION(freeze)(const TDS_TYPE* map, TDS_FROZEN_T* frozen);
+TDS_VALUE_T* TDS_FUNCTION(frozen_get)(const TDS_FROZEN_T* frozen, TDS_KEY_T key);
+void TDS_FUNCTION(frozen_get_many)(const TDS_FROZEN_T* frozen, const TDS_KEY_T* keys, TDS_SIZE_T count, TDS_VALUE_T** values);
+TDS_SIZE_T TDS_FUNCTION(frozen_count)(const TDS_FROZEN_T* frozen);
+void TDS_FUNCTION(frozen_fini)(TDS_FROZEN_T* frozen);
 #endif
 
 #ifdef TDS_IMPLEMENT
@@ -80,49 +121,92 @@ static TDS_SIZE_T TDS_FUNCTION(prime_capacity)(TDS_SIZE_T capacity) {
     return TDS_MAX_VALUE(TDS_SIZE_T);
 }
 
+// Robin Hood insertion of an entry known not to be in `buckets` yet.
+static void TDS_FUNCTION(_place)(TDS_ENTRY_T* buckets, const TDS_SIZE_T capacity, TDS_ENTRY_T entry) {
+    entry.probe_sequence_length = 0;
+
+    TDS_SIZE_T index = entry.hash % capacity;
+    while (1) {
+        TDS_ENTRY_T* cur = buckets + index;
+        if (!cur->occupied) {
+            buckets[index] = entry;
+            return;
+        }
+
+        // Robin Hood: Swap if our probe distance is higher.
+        if (cur->probe_sequence_length < entry.probe_sequence_length) {
+            const TDS_ENTRY_T temp = *cur;
+            *cur = entry;
+            entry = temp;
+        }
+        index = (index + 1) % capacity;
+        entry.probe_sequence_length++;
+        TDS_ASSERT(entry.probe_sequence_length < capacity);
+    }
+}
+
 static void TDS_FUNCTION(rehash)(TDS_TYPE* map, const TDS_SIZE_T capacity) {
     TDS_ASSERT(map->count <= capacity);
 
-    TDS_ENTRY_T* new_buckets = TDS_CALLOC(capacity, sizeof(TDS_ENTRY_T));
+    TDS_ENTRY_T* new_buckets = tds_allocate(TDS_ALLOCATOR_OF(map), (size_t)capacity * sizeof(TDS_ENTRY_T), TDS_ALIGNMENT);
     if (map->buckets) {
         for (TDS_SIZE_T i = 0; i < map->capacity; i++) {
-            TDS_ENTRY_T entry = map->buckets[i];
-            if (!entry.occupied) {
-                continue;
-            }
-
-            entry.probe_sequence_length = 0;
-
-            // Insert entry.
-            TDS_SIZE_T index = entry.hash % capacity;
-            while (1) {
-                TDS_ENTRY_T* cur = new_buckets + index;
-                if (!cur->occupied) {
-                    new_buckets[index] = entry;
-                    break;
-                }
-
-                // Robin Hood: Swap if our probe distance is higher.
-                if (cur->probe_sequence_length < entry.probe_sequence_length) {
-                    const TDS_ENTRY_T temp = *cur;
-                    *cur = entry;
-                    entry = temp;
-                }
-                index = (index + 1) % capacity;
-                entry.probe_sequence_length++;
-                TDS_ASSERT(entry.probe_sequence_length < capacity);
+            if (map->buckets[i].occupied) {
+                TDS_FUNCTION(_place)(new_buckets, capacity, map->buckets[i]);
             }
         }
     }
+#ifdef TDS_INLINE_CAPACITY
+    else {
+        // Spilling out of the inline storage, whose keys were never hashed.
+        for (TDS_SIZE_T i = 0; i < map->count; i++) {
+            TDS_KEY_T key = map->inline_keys[i];
+            TDS_FUNCTION(_place)(new_buckets, capacity, (TDS_ENTRY_T){
+                .hash = TDS_HASH_KEY(key),
+                .key = key,
+                .value = map->inline_values[i],
+                .occupied = 1,
+            });
+        }
+    }
+#endif
 
-    TDS_FREE(map->buckets);
+    tds_deallocate(TDS_ALLOCATOR_OF(map), map->buckets, (size_t)map->capacity * sizeof(TDS_ENTRY_T), TDS_ALIGNMENT);
     map->buckets = new_buckets;
     map->capacity = capacity;
 }
 
+#ifdef TDS_INLINE_CAPACITY
+// Returns the index of `key` in the inline storage, or `map->count` if it isn't there.
+static TDS_SIZE_T TDS_FUNCTION(_inline_find)(const TDS_TYPE* map, TDS_KEY_T key) {
+#ifdef TDS_KEY_EQUALS
+    for (TDS_SIZE_T i = 0; i < map->count; i++) {
+        if (TDS_KEY_EQUALS(map->inline_keys[i], key)) {
+            return i;
+        }
+    }
+
+    return map->count;
+#else
+    // No early exit, so compilers can turn this into a vectorized compare.
+    TDS_SIZE_T index = map->count;
+    for (TDS_SIZE_T i = 0; i < map->count; i++) {
+        index = map->inline_keys[i] == key ? i : index;
+    }
+
+    return index;
+#endif
+}
+#endif
+
 TDS_VALUE_T* TDS_FUNCTION(get)(const TDS_TYPE* map, TDS_KEY_T key) {
     if (!map->buckets) {
+#ifdef TDS_INLINE_CAPACITY
+        const TDS_SIZE_T index = TDS_FUNCTION(_inline_find)(map, key);
+        return index < map->count ? (TDS_VALUE_T*)map->inline_values + index : NULL;
+#else
         return NULL;
+#endif
     }
 
     const uint64_t hash = TDS_HASH_KEY(key);
@@ -153,8 +237,13 @@ TDS_VALUE_T* TDS_FUNCTION(get)(const TDS_TYPE* map, TDS_KEY_T key) {
 }
 
 void TDS_FUNCTION(reserve)(TDS_TYPE* map, const TDS_SIZE_T capacity) {
-    TDS_ASSERT(map->count <= map->capacity);
+    TDS_ASSERT(!map->buckets || map->count <= map->capacity);
 
+#ifdef TDS_INLINE_CAPACITY
+    if (!map->buckets && capacity <= TDS_INLINE_CAPACITY) {
+        return;
+    }
+#endif
     if (capacity <= map->capacity) {
         return;
     }
@@ -163,6 +252,26 @@ void TDS_FUNCTION(reserve)(TDS_TYPE* map, const TDS_SIZE_T capacity) {
 }
 
 int TDS_FUNCTION(set)(TDS_TYPE* map, TDS_KEY_T key, TDS_VALUE_T value) {
+#ifdef TDS_INLINE_CAPACITY
+    if (!map->buckets) {
+        const TDS_SIZE_T index = TDS_FUNCTION(_inline_find)(map, key);
+        if (index < map->count) {
+            map->inline_values[index] = value;
+            return 0;
+        }
+
+        if (map->count < TDS_INLINE_CAPACITY) {
+            map->inline_keys[map->count] = key;
+            map->inline_values[map->count] = value;
+            map->count++;
+            return 1;
+        }
+
+        // Out of inline room, spill into the hash table.
+        TDS_FUNCTION(reserve)(map, TDS_FUNCTION(usable_capacity)(map->count * 2));
+    }
+#endif
+
     // Ensure the map has room for at least one more entry.
     // Check load factor > 0.75 by using integer math instead of floating-point math.
     // TODO: Use floating point math instead, for cases where we're approaching TDS_SIZE_T limits.
@@ -229,6 +338,18 @@ TDS_JOIN2(TDS_TYPE, _iter_t) TDS_FUNCTION(iter)(const TDS_TYPE* map) {
 }
 
 char TDS_FUNCTION(next)(TDS_JOIN2(TDS_TYPE, _iter_t)* iter) {
+#ifdef TDS_INLINE_CAPACITY
+    if (!iter->map->buckets) {
+        if (iter->_index < iter->map->count) {
+            iter->key = iter->map->inline_keys[iter->_index];
+            iter->value = (TDS_VALUE_T*)iter->map->inline_values + iter->_index++;
+            return 1;
+        }
+
+        return 0;
+    }
+#endif
+
     while (iter->_index < iter->map->capacity) {
         TDS_ENTRY_T* entry = iter->map->buckets + iter->_index++;
         if (entry->occupied) {
@@ -243,7 +364,26 @@ char TDS_FUNCTION(next)(TDS_JOIN2(TDS_TYPE, _iter_t)* iter) {
 
 int TDS_FUNCTION(remove)(TDS_TYPE* map, TDS_KEY_T key) {
     if (!map->buckets) {
+#ifdef TDS_INLINE_CAPACITY
+        const TDS_SIZE_T index = TDS_FUNCTION(_inline_find)(map, key);
+        if (index == map->count) {
+            return 0;
+        }
+
+#ifdef TDS_KEY_FINI
+        TDS_KEY_FINI((map->inline_keys[index]));
+#endif
+#ifdef TDS_VALUE_FINI
+        TDS_VALUE_FINI((map->inline_values[index]));
+#endif
+        // Move the last entry into the gap.
+        map->count--;
+        map->inline_keys[index] = map->inline_keys[map->count];
+        map->inline_values[index] = map->inline_values[map->count];
+        return 1;
+#else
         return 0;
+#endif
     }
 
     const uint64_t hash = TDS_HASH_KEY(key);
@@ -325,14 +465,39 @@ void TDS_FUNCTION(clear)(TDS_TYPE* map) {
 }
 
 void TDS_FUNCTION(reclaim)(TDS_TYPE* map) {
+#ifdef TDS_INLINE_CAPACITY
+    if (!map->buckets) {
+        // The inline storage can't shrink.
+        return;
+    }
+#endif
     TDS_ASSERT(map->count <= map->capacity);
 
     if (map->count == 0) {
-        TDS_FREE(map->buckets);
-        *map = (TDS_TYPE){ 0 };
+        tds_deallocate(TDS_ALLOCATOR_OF(map), map->buckets, (size_t)map->capacity * sizeof(TDS_ENTRY_T), TDS_ALIGNMENT);
+        TDS_RESET(map);
         return;
     }
 
+#ifdef TDS_INLINE_CAPACITY
+    if (map->count <= TDS_INLINE_CAPACITY) {
+        // Move back into the inline storage.
+        map->count = 0;
+        for (TDS_SIZE_T i = 0; i < map->capacity; i++) {
+            if (map->buckets[i].occupied) {
+                map->inline_keys[map->count] = map->buckets[i].key;
+                map->inline_values[map->count] = map->buckets[i].value;
+                map->count++;
+            }
+        }
+
+        tds_deallocate(TDS_ALLOCATOR_OF(map), map->buckets, (size_t)map->capacity * sizeof(TDS_ENTRY_T), TDS_ALIGNMENT);
+        map->buckets = NULL;
+        map->capacity = 0;
+        return;
+    }
+#endif
+
     const TDS_SIZE_T capacity = TDS_FUNCTION(prime_capacity)(TDS_FUNCTION(usable_capacity)(map->count));
     if (capacity == map->capacity) {
         return;
@@ -353,9 +518,258 @@ void TDS_FUNCTION(fini)(TDS_TYPE* map) {
 #endif
     }
 #endif
-    TDS_FREE(map->buckets);
-    *map = (TDS_TYPE){ 0 };
+    tds_deallocate(TDS_ALLOCATOR_OF(map), map->buckets, (size_t)map->capacity * sizeof(TDS_ENTRY_T), TDS_ALIGNMENT);
+    TDS_RESET(map);
+}
+
+// Maps the low 32 bits of `value` onto [0, range) without a division.
+static TDS_SIZE_T TDS_FUNCTION(_reduce)(const uint64_t value, const TDS_SIZE_T range) {
+    return (TDS_SIZE_T)(((value & 0xffffffff) * range) >> 32);
+}
+
+static TDS_SIZE_T TDS_FUNCTION(_frozen_slot)(const uint64_t hash, const uint32_t pilot, const TDS_SIZE_T count) {
+    return TDS_FUNCTION(_reduce)(tds_mix64(hash ^ (pilot * 0x9e3779b97f4a7c15ull)) >> 32, count);
+}
+
+static TDS_SIZE_T TDS_FUNCTION(_frozen_position)(const TDS_FROZEN_T* frozen, const uint64_t hash) {
+    const uint32_t pilot = frozen->pilots[TDS_FUNCTION(_reduce)(hash, frozen->bucket_count)];
+    return TDS_FUNCTION(_frozen_slot)(hash, pilot, frozen->count);
+}
+
+// Builds a minimal perfect hash over the keys of `map` with hash-and-displace: keys are grouped into small buckets by
+// hash, and buckets are placed from the biggest down, each one looking for the first pilot that sends all of its keys
+// to free slots. The stored hashes are reused, so keys aren't hashed again. `frozen` must be zero-initialized or
+// previously frozen, its old contents are released. Returns 0 and leaves `frozen` empty if two keys have the same hash,
+// since no pilot can separate them.
+char TDS_FUNCTION(freeze)(const TDS_TYPE* map, TDS_FROZEN_T* frozen) {
+    TDS_FUNCTION(frozen_fini)(frozen);
+#ifdef TDS_ALLOCATOR
+    frozen->allocator = map->allocator;
+#endif
+    const tds_allocator_t* allocator = TDS_ALLOCATOR_OF(map);
+    const TDS_SIZE_T count = map->count;
+    if (count == 0) {
+        return 1;
+    }
+
+    uint64_t* hashes = tds_allocate(allocator, (size_t)count * sizeof(uint64_t), 0);
+    TDS_KEY_T* keys = tds_allocate(allocator, (size_t)count * sizeof(TDS_KEY_T), 0);
+    TDS_VALUE_T* values = tds_allocate(allocator, (size_t)count * sizeof(TDS_VALUE_T), 0);
+    TDS_SIZE_T staged = 0;
+#ifdef TDS_INLINE_CAPACITY
+    for (TDS_SIZE_T i = 0; !map->buckets && i < map->count; i++) {
+        TDS_KEY_T key = map->inline_keys[i];
+        hashes[staged] = TDS_HASH_KEY(key);
+        keys[staged] = key;
+        values[staged] = map->inline_values[i];
+        staged++;
+    }
+#endif
+    for (TDS_SIZE_T i = 0; i < map->capacity; i++) {
+        const TDS_ENTRY_T* entry = map->buckets + i;
+        if (entry->occupied) {
+            hashes[staged] = entry->hash;
+            keys[staged] = entry->key;
+            values[staged] = entry->value;
+            staged++;
+        }
+    }
+    TDS_ASSERT(staged == count);
+
+    // Group the entries by bucket with a counting sort. `ends[bucket]` is one past its last member.
+    const TDS_SIZE_T bucket_count = count / TDS_FROZEN_KEYS_PER_BUCKET + 1;
+    TDS_SIZE_T* ends = tds_allocate(allocator, (size_t)bucket_count * sizeof(TDS_SIZE_T), 0);
+    TDS_SIZE_T* members = tds_allocate(allocator, (size_t)count * sizeof(TDS_SIZE_T), 0);
+    for (TDS_SIZE_T i = 0; i < count; i++) {
+        ends[TDS_FUNCTION(_reduce)(hashes[i], bucket_count)]++;
+    }
+    TDS_SIZE_T largest = 0;
+    for (TDS_SIZE_T i = 0, total = 0; i < bucket_count; i++) {
+        largest = ends[i] > largest ? ends[i] : largest;
+        total += ends[i];
+        ends[i] = total;
+    }
+    for (TDS_SIZE_T i = count; i-- > 0;) {
+        members[--ends[TDS_FUNCTION(_reduce)(hashes[i], bucket_count)]] = i;
+    }
+    // Every bucket now holds where it begins, which is where the previous one ends.
+    for (TDS_SIZE_T i = 0; i + 1 < bucket_count; i++) {
+        ends[i] = ends[i + 1];
+    }
+    ends[bucket_count - 1] = count;
+
+    // Keys with the same hash land in the same bucket, where they'd make the pilot search below loop forever.
+    char collision = 0;
+    for (TDS_SIZE_T bucket = 0; !collision && bucket < bucket_count; bucket++) {
+        const TDS_SIZE_T begin = bucket ? ends[bucket - 1] : 0;
+        for (TDS_SIZE_T i = begin; !collision && i < ends[bucket]; i++) {
+            for (TDS_SIZE_T j = begin; j < i; j++) {
+                if (hashes[members[i]] == hashes[members[j]]) {
+                    collision = 1;
+                    break;
+                }
+            }
+        }
+    }
+    if (collision) {
+        tds_deallocate(allocator, hashes, (size_t)count * sizeof(uint64_t), 0);
+        tds_deallocate(allocator, keys, (size_t)count * sizeof(TDS_KEY_T), 0);
+        tds_deallocate(allocator, values, (size_t)count * sizeof(TDS_VALUE_T), 0);
+        tds_deallocate(allocator, ends, (size_t)bucket_count * sizeof(TDS_SIZE_T), 0);
+        tds_deallocate(allocator, members, (size_t)count * sizeof(TDS_SIZE_T), 0);
+        return 0;
+    }
+
+    // Order the buckets from the biggest down, again with a counting sort.
+    TDS_SIZE_T* offsets = tds_allocate(allocator, ((size_t)largest + 1) * sizeof(TDS_SIZE_T), 0);
+    TDS_SIZE_T* order = tds_allocate(allocator, (size_t)bucket_count * sizeof(TDS_SIZE_T), 0);
+    for (TDS_SIZE_T i = 0; i < bucket_count; i++) {
+        const TDS_SIZE_T size = ends[i] - (i ? ends[i - 1] : 0);
+        offsets[largest - size]++;
+    }
+    for (TDS_SIZE_T i = 0, total = 0; i <= largest; i++) {
+        const TDS_SIZE_T size_count = offsets[i];
+        offsets[i] = total;
+        total += size_count;
+    }
+    for (TDS_SIZE_T i = 0; i < bucket_count; i++) {
+        const TDS_SIZE_T size = ends[i] - (i ? ends[i - 1] : 0);
+        order[offsets[largest - size]++] = i;
+    }
+
+    frozen->keys = tds_allocate(allocator, (size_t)count * sizeof(TDS_KEY_T), TDS_ALIGNMENT);
+    frozen->values = tds_allocate(allocator, (size_t)count * sizeof(TDS_VALUE_T), TDS_ALIGNMENT);
+    frozen->pilots = tds_allocate(allocator, (size_t)bucket_count * sizeof(uint32_t), TDS_ALIGNMENT);
+    frozen->count = count;
+    frozen->bucket_count = bucket_count;
+
+    const size_t taken_size = ((size_t)count + 63) / 64 * sizeof(uint64_t);
+    uint64_t* taken = tds_allocate(allocator, taken_size, 0);
+    TDS_SIZE_T* slots = tds_allocate(allocator, (size_t)largest * sizeof(TDS_SIZE_T), 0);
+    for (TDS_SIZE_T i = 0; i < bucket_count; i++) {
+        const TDS_SIZE_T bucket = order[i];
+        const TDS_SIZE_T begin = bucket ? ends[bucket - 1] : 0, size = ends[bucket] - begin;
+        if (size == 0) {
+            // Buckets are sorted by size, so only empty ones are left.
+            break;
+        }
+
+        uint32_t pilot = 0;
+        TDS_SIZE_T placed = 0;
+        while (placed < size) {
+            const TDS_SIZE_T slot = TDS_FUNCTION(_frozen_slot)(hashes[members[begin + placed]], pilot, count);
+            char free_slot = !(taken[slot / 64] & ((uint64_t)1 << (slot % 64)));
+            // Keys of the same bucket must not collide with each other either.
+            for (TDS_SIZE_T j = 0; free_slot && j < placed; j++) {
+                free_slot = slots[j] != slot;
+            }
+
+            if (free_slot) {
+                slots[placed++] = slot;
+            } else {
+                // Keys have distinct hashes, so some pilot eventually separates them.
+                pilot++;
+                placed = 0;
+            }
+        }
+
+        frozen->pilots[bucket] = pilot;
+        for (TDS_SIZE_T j = 0; j < size; j++) {
+            const TDS_SIZE_T slot = slots[j];
+            taken[slot / 64] |= (uint64_t)1 << (slot % 64);
+            frozen->keys[slot] = keys[members[begin + j]];
+            frozen->values[slot] = values[members[begin + j]];
+        }
+    }
+
+    tds_deallocate(allocator, hashes, (size_t)count * sizeof(uint64_t), 0);
+    tds_deallocate(allocator, keys, (size_t)count * sizeof(TDS_KEY_T), 0);
+    tds_deallocate(allocator, values, (size_t)count * sizeof(TDS_VALUE_T), 0);
+    tds_deallocate(allocator, ends, (size_t)bucket_count * sizeof(TDS_SIZE_T), 0);
+    tds_deallocate(allocator, members, (size_t)count * sizeof(TDS_SIZE_T), 0);
+    tds_deallocate(allocator, offsets, ((size_t)largest + 1) * sizeof(TDS_SIZE_T), 0);
+    tds_deallocate(allocator, order, (size_t)bucket_count * sizeof(TDS_SIZE_T), 0);
+    tds_deallocate(allocator, taken, taken_size, 0);
+    tds_deallocate(allocator, slots, (size_t)largest * sizeof(TDS_SIZE_T), 0);
+    return 1;
+}
+
+TDS_VALUE_T* TDS_FUNCTION(frozen_get)(const TDS_FROZEN_T* frozen, TDS_KEY_T key) {
+    if (!frozen->count) {
+        return NULL;
+    }
+
+    // Keys that were never added still land on some slot, so the key there has to be checked.
+    const TDS_SIZE_T position = TDS_FUNCTION(_frozen_position)(frozen, TDS_HASH_KEY(key));
+#ifdef TDS_KEY_EQUALS
+    return TDS_KEY_EQUALS(frozen->keys[position], key) ? frozen->values + position : NULL;
+#else
+    return frozen->keys[position] == key ? frozen->values + position : NULL;
+#endif
+}
+
+// Looks up `count` keys, storing a pointer to each value, or NULL, in `values`. Keys are looked up TDS_PROBE_BATCH at a
+// time, prefetching the pilots of the whole batch and then its slots, so that their cache misses overlap.
+void TDS_FUNCTION(frozen_get_many)(
+    const TDS_FROZEN_T* frozen,
+    const TDS_KEY_T* keys,
+    const TDS_SIZE_T count,
+    TDS_VALUE_T** values
+) {
+    if (!frozen->count) {
+        for (TDS_SIZE_T i = 0; i < count; i++) {
+            values[i] = NULL;
+        }
+        return;
+    }
+
+    for (TDS_SIZE_T begin = 0; begin < count; begin += TDS_PROBE_BATCH) {
+        const TDS_SIZE_T batch = count - begin < TDS_PROBE_BATCH ? count - begin : TDS_PROBE_BATCH;
+        uint64_t hashes[TDS_PROBE_BATCH];
+        TDS_SIZE_T positions[TDS_PROBE_BATCH];
+
+        for (TDS_SIZE_T i = 0; i < batch; i++) {
+            TDS_KEY_T key = keys[begin + i];
+            hashes[i] = TDS_HASH_KEY(key);
+            TDS_PREFETCH(frozen->pilots + TDS_FUNCTION(_reduce)(hashes[i], frozen->bucket_count));
+        }
+
+        for (TDS_SIZE_T i = 0; i < batch; i++) {
+            positions[i] = TDS_FUNCTION(_frozen_position)(frozen, hashes[i]);
+            TDS_PREFETCH(frozen->keys + positions[i]);
+            TDS_PREFETCH(frozen->values + positions[i]);
+        }
+
+        for (TDS_SIZE_T i = 0; i < batch; i++) {
+            const TDS_SIZE_T position = positions[i];
+#ifdef TDS_KEY_EQUALS
+            const char found = TDS_KEY_EQUALS(frozen->keys[position], keys[begin + i]);
+#else
+            const char found = frozen->keys[position] == keys[begin + i];
+#endif
+            values[begin + i] = found ? frozen->values + position : NULL;
+        }
+    }
+}
+
+TDS_SIZE_T TDS_FUNCTION(frozen_count)(const TDS_FROZEN_T* frozen) {
+    return frozen->count;
+}
+
+// Doesn't finalize keys nor values, they are still owned by the map.
+void TDS_FUNCTION(frozen_fini)(TDS_FROZEN_T* frozen) {
+    const tds_allocator_t* allocator = TDS_ALLOCATOR_OF(frozen);
+    tds_deallocate(allocator, frozen->keys, (size_t)frozen->count * sizeof(TDS_KEY_T), TDS_ALIGNMENT);
+    tds_deallocate(allocator, frozen->values, (size_t)frozen->count * sizeof(TDS_VALUE_T), TDS_ALIGNMENT);
+    tds_deallocate(allocator, frozen->pilots, (size_t)frozen->bucket_count * sizeof(uint32_t), TDS_ALIGNMENT);
+    *frozen = (TDS_FROZEN_T){ 0 };
+#ifdef TDS_ALLOCATOR
+    frozen->allocator = allocator;
+#endif
 }
 #endif
 
 #include "private/end.inc"
+
+#undef TDS_FROZEN_T
+#undef TDS_FROZEN_KEYS_PER_BUCKET
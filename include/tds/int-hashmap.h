@@ -0,0 +1,270 @@
+#include "private/common.h"
+
+// Integer keys are hashed with a cheap bit mixer instead of rapidhash.
+#ifndef TDS_HASH_KEY
+#define TDS_HASH_KEY(key) tds_mix64((uint64_t)(key))
+#endif
+
+#include "private/begin.inc"
+
+// A hash map specialized for integer keys. One key value, TDS_EMPTY_KEY, is reserved to mark empty slots, so a slot is
+// just a key and a value, with no stored hash, probe length or occupied flag. Collisions are resolved by linear probing,
+// which lookups scan a cache line at a time, and removals shift the following entries back instead of leaving
+// tombstones.
+
+#ifndef TDS_TYPE
+#define TDS_TYPE TDS_DEFAULT_TYPE_W_KEY_VALUE(int_hashmap)
+#endif
+
+#ifndef TDS_ALIGNMENT
+#define TDS_ALIGNMENT TDS_CACHE_LINE_SIZE
+#endif
+
+// The key that marks empty slots, which therefore can't be stored in the map. Zero lets new tables come straight out
+// of zeroed memory.
+#ifndef TDS_EMPTY_KEY
+#define TDS_EMPTY_KEY 0
+#endif
+
+#define TDS_ENTRY_T TDS_JOIN2(TDS_TYPE, _entry)
+// Slots compared at once by lookups, about a cache line worth of them.
+#define TDS_INT_HASHMAP_GROUP (sizeof(TDS_ENTRY_T) >= 64 ? 1 : 64 / sizeof(TDS_ENTRY_T))
+
+#ifdef TDS_DECLARE
+typedef struct TDS_ENTRY_T {
+    TDS_KEY_T key;
+    TDS_VALUE_T value;
+} TDS_ENTRY_T;
+
+typedef struct TDS_TYPE {
+    TDS_ENTRY_T* buckets;
+    TDS_SIZE_T count;
+    TDS_SIZE_T capacity; // Always a power of two.
+#ifdef TDS_ALLOCATOR
+    const tds_allocator_t* allocator;
+#endif
+} TDS_TYPE;
+
+typedef struct TDS_JOIN2(TDS_TYPE, _iter_t) {
+    const TDS_TYPE* map;
+    TDS_SIZE_T _index;
+    TDS_KEY_T key;
+    TDS_VALUE_T* value;
+} TDS_JOIN2(TDS_TYPE, _iter_t);
+
+TDS_VALUE_T* TDS_FUNCTION(get)(const TDS_TYPE* map, TDS_KEY_T key);
+void TDS_FUNCTION(reserve)(TDS_TYPE* map, TDS_SIZE_T capacity);
+int TDS_FUNCTION(set)(TDS_TYPE* map, TDS_KEY_T key, TDS_VALUE_T value);
+TDS_JOIN2(TDS_TYPE, _iter_t) TDS_FUNCTION(iter)(const TDS_TYPE* map);
+char TDS_FUNCTION(next)(TDS_JOIN2(TDS_TYPE, _iter_t)* iter);
+int TDS_FUNCTION(remove)(TDS_TYPE* map, TDS_KEY_T key);
+TDS_SIZE_T TDS_FUNCTION(count)(const TDS_TYPE* map);
+void TDS_FUNCTION(clear)(TDS_TYPE* map);
+void TDS_FUNCTION(reclaim)(TDS_TYPE* map);
+void TDS_FUNCTION(fini)(TDS_TYPE* map);
+#endif
+
+#ifdef TDS_IMPLEMENT
+// Slots needed to hold `count` keys at a load factor of at most 75%.
+static TDS_SIZE_T TDS_FUNCTION(_capacity_for)(const TDS_SIZE_T count) {
+    TDS_SIZE_T capacity = TDS_INITIAL_CAPACITY > 1 ? TDS_INITIAL_CAPACITY : 2;
+    while ((size_t)count * 4 > (size_t)capacity * 3) {
+        capacity *= 2;
+    }
+
+    // Round up to a power of two.
+    TDS_SIZE_T power = 1;
+    while (power < capacity) {
+        power *= 2;
+    }
+
+    return power;
+}
+
+static TDS_SIZE_T TDS_FUNCTION(_home)(const TDS_TYPE* map, TDS_KEY_T key) {
+    return (TDS_SIZE_T)TDS_HASH_KEY(key) & (map->capacity - 1);
+}
+
+static void TDS_FUNCTION(_clear_slots)(TDS_ENTRY_T* buckets, const TDS_SIZE_T capacity) {
+    for (TDS_SIZE_T i = 0; i < capacity; i++) {
+        buckets[i].key = (TDS_KEY_T)TDS_EMPTY_KEY;
+    }
+}
+
+// Returns the slot holding `key`, or the empty slot that ends its probe sequence.
+static TDS_SIZE_T TDS_FUNCTION(_find)(const TDS_TYPE* map, TDS_KEY_T key) {
+    const TDS_SIZE_T mask = map->capacity - 1;
+    TDS_SIZE_T index = TDS_FUNCTION(_home)(map, key);
+    // The "for" instead of a "while" loop is just to guard against infinite loops.
+    for (TDS_SIZE_T probed = 0; probed < map->capacity; probed += TDS_INT_HASHMAP_GROUP) {
+        // Compare a whole group without branching and pick the first slot that ends the search.
+        TDS_SIZE_T hit = TDS_INT_HASHMAP_GROUP;
+        for (TDS_SIZE_T i = TDS_INT_HASHMAP_GROUP; i-- > 0;) {
+            const TDS_KEY_T slot_key = map->buckets[(index + i) & mask].key;
+            hit = slot_key == key || slot_key == (TDS_KEY_T)TDS_EMPTY_KEY ? i : hit;
+        }
+
+        if (hit < TDS_INT_HASHMAP_GROUP) {
+            return (index + hit) & mask;
+        }
+
+        index = (index + TDS_INT_HASHMAP_GROUP) & mask;
+    }
+
+    TDS_ASSERT(0);
+    return 0;
+}
+
+static void TDS_FUNCTION(rehash)(TDS_TYPE* map, const TDS_SIZE_T capacity) {
+    TDS_ASSERT(map->count < capacity);
+
+    TDS_ENTRY_T* old_buckets = map->buckets;
+    const TDS_SIZE_T old_capacity = map->capacity;
+    map->buckets = tds_allocate(TDS_ALLOCATOR_OF(map), (size_t)capacity * sizeof(TDS_ENTRY_T), TDS_ALIGNMENT);
+    map->capacity = capacity;
+    TDS_FUNCTION(_clear_slots)(map->buckets, capacity);
+
+    for (TDS_SIZE_T i = 0; i < old_capacity; i++) {
+        if (old_buckets[i].key != (TDS_KEY_T)TDS_EMPTY_KEY) {
+            map->buckets[TDS_FUNCTION(_find)(map, old_buckets[i].key)] = old_buckets[i];
+        }
+    }
+
+    tds_deallocate(TDS_ALLOCATOR_OF(map), old_buckets, (size_t)old_capacity * sizeof(TDS_ENTRY_T), TDS_ALIGNMENT);
+}
+
+TDS_VALUE_T* TDS_FUNCTION(get)(const TDS_TYPE* map, TDS_KEY_T key) {
+    if (!map->buckets || key == (TDS_KEY_T)TDS_EMPTY_KEY) {
+        return NULL;
+    }
+
+    TDS_ENTRY_T* entry = map->buckets + TDS_FUNCTION(_find)(map, key);
+    return entry->key == key ? &entry->value : NULL;
+}
+
+// Makes room for at least `capacity` entries.
+void TDS_FUNCTION(reserve)(TDS_TYPE* map, const TDS_SIZE_T capacity) {
+    const TDS_SIZE_T new_capacity = TDS_FUNCTION(_capacity_for)(capacity);
+    if (new_capacity <= map->capacity) {
+        return;
+    }
+
+    TDS_FUNCTION(rehash)(map, new_capacity);
+}
+
+int TDS_FUNCTION(set)(TDS_TYPE* map, TDS_KEY_T key, TDS_VALUE_T value) {
+    TDS_ASSERT(key != (TDS_KEY_T)TDS_EMPTY_KEY);
+
+    // Only look for a bigger capacity once one more entry would push the load factor past 0.75.
+    if (!map->buckets || ((size_t)map->count + 1) * 4 > (size_t)map->capacity * 3) {
+        TDS_FUNCTION(reserve)(map, map->count + 1);
+    }
+    TDS_ENTRY_T* entry = map->buckets + TDS_FUNCTION(_find)(map, key);
+    if (entry->key == key) {
+        // Key matches, update the value.
+        entry->value = value;
+        return 0;
+    }
+
+    entry->key = key;
+    entry->value = value;
+    map->count++;
+    return 1;
+}
+
+TDS_JOIN2(TDS_TYPE, _iter_t) TDS_FUNCTION(iter)(const TDS_TYPE* map) {
+    return (TDS_JOIN2(TDS_TYPE, _iter_t)) {
+        .map = map,
+        ._index = 0,
+    };
+}
+
+char TDS_FUNCTION(next)(TDS_JOIN2(TDS_TYPE, _iter_t)* iter) {
+    while (iter->_index < iter->map->capacity) {
+        TDS_ENTRY_T* entry = iter->map->buckets + iter->_index++;
+        if (entry->key != (TDS_KEY_T)TDS_EMPTY_KEY) {
+            iter->key = entry->key;
+            iter->value = &entry->value;
+            return 1;
+        }
+    }
+
+    return 0;
+}
+
+int TDS_FUNCTION(remove)(TDS_TYPE* map, TDS_KEY_T key) {
+    if (!map->buckets || key == (TDS_KEY_T)TDS_EMPTY_KEY) {
+        return 0;
+    }
+
+    TDS_SIZE_T gap = TDS_FUNCTION(_find)(map, key);
+    if (map->buckets[gap].key != key) {
+        return 0;
+    }
+
+#ifdef TDS_VALUE_FINI
+    TDS_VALUE_FINI((map->buckets[gap].value));
+#endif
+    map->count--;
+
+    // Shift back every following entry of the cluster that the gap separates from its home slot.
+    const TDS_SIZE_T mask = map->capacity - 1;
+    for (TDS_SIZE_T index = (gap + 1) & mask; map->buckets[index].key != (TDS_KEY_T)TDS_EMPTY_KEY; index = (index + 1) & mask) {
+        const TDS_SIZE_T home = TDS_FUNCTION(_home)(map, map->buckets[index].key);
+        // Cyclic distances from the home slot: the entry can move if the gap is not past it.
+        if (((gap - home) & mask) < ((index - home) & mask)) {
+            map->buckets[gap] = map->buckets[index];
+            gap = index;
+        }
+    }
+    map->buckets[gap].key = (TDS_KEY_T)TDS_EMPTY_KEY;
+
+    return 1;
+}
+
+TDS_SIZE_T TDS_FUNCTION(count)(const TDS_TYPE* map) {
+    return map->count;
+}
+
+void TDS_FUNCTION(clear)(TDS_TYPE* map) {
+#ifdef TDS_VALUE_FINI
+    TDS_JOIN2(TDS_TYPE, _iter_t) it = TDS_FUNCTION(iter)(map);
+    while (TDS_FUNCTION(next)(&it)) {
+        TDS_VALUE_FINI((*it.value));
+    }
+#endif
+    TDS_FUNCTION(_clear_slots)(map->buckets, map->capacity);
+    map->count = 0;
+}
+
+void TDS_FUNCTION(reclaim)(TDS_TYPE* map) {
+    if (map->count == 0) {
+        tds_deallocate(TDS_ALLOCATOR_OF(map), map->buckets, (size_t)map->capacity * sizeof(TDS_ENTRY_T), TDS_ALIGNMENT);
+        TDS_RESET(map);
+        return;
+    }
+
+    const TDS_SIZE_T capacity = TDS_FUNCTION(_capacity_for)(map->count);
+    if (capacity >= map->capacity) {
+        return;
+    }
+
+    TDS_FUNCTION(rehash)(map, capacity);
+}
+
+void TDS_FUNCTION(fini)(TDS_TYPE* map) {
+#ifdef TDS_VALUE_FINI
+    TDS_JOIN2(TDS_TYPE, _iter_t) it = TDS_FUNCTION(iter)(map);
+    while (TDS_FUNCTION(next)(&it)) {
+        TDS_VALUE_FINI(*it.value);
+    }
+#endif
+    tds_deallocate(TDS_ALLOCATOR_OF(map), map->buckets, (size_t)map->capacity * sizeof(TDS_ENTRY_T), TDS_ALIGNMENT);
+    TDS_RESET(map);
+}
+#endif
+
+#include "private/end.inc"
+
+#undef TDS_EMPTY_KEY
+#undef TDS_INT_HASHMAP_GROUP
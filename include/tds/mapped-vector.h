@@ -0,0 +1,434 @@
+#include "private/common.h"
+#include "private/begin.inc"
+
+// A vector whose storage is a memory-mapped file, so its contents persist and can be larger than RAM, with the page
+// cache deciding what stays in memory. The file starts with a small header holding the element count, followed by the
+// elements. A vector that wasn't opened on a file is backed by anonymous memory instead. Requires POSIX `mmap`, and
+// values must be plain data, since they outlive the process. On Linux, mappings are grown with `mremap` when
+// <sys/mman.h> declares it, which glibc only does with _GNU_SOURCE, and are mapped again elsewhere otherwise. Functions
+// that grow the vector report when the file or the mapping can't be resized, leaving the vector unchanged.
+
+#if defined(_WIN32)
+#error "mapped-vector.h requires POSIX mmap."
+#endif
+
+#ifdef TDS_VALUE_FINI
+#error "mapped-vector.h stores plain data and doesn't support TDS_VALUE_FINI."
+#endif
+
+#ifndef _TDS_MAPPED_VECTOR_H_
+#define _TDS_MAPPED_VECTOR_H_
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+
+// "tdsmvec1" on little-endian machines. The last character is the format version.
+#define TDS_MAPPED_MAGIC 0x316365766d736474ull
+
+// Padded to a cache line so the elements that follow are aligned.
+typedef union tds_mapped_header_t {
+    struct {
+        uint64_t magic;
+        uint64_t value_size;
+        uint64_t count;
+    } fields;
+    char padding[TDS_CACHE_LINE_SIZE];
+} tds_mapped_header_t;
+
+static inline size_t tds_page_size(void) {
+    const long size = sysconf(_SC_PAGESIZE);
+    return size > 0 ? (size_t)size : 4096;
+}
+#endif
+
+#ifndef TDS_TYPE
+#define TDS_TYPE TDS_DEFAULT_TYPE_W_VALUE(mapped_vec)
+#endif
+
+#ifdef TDS_DECLARE
+typedef struct TDS_TYPE {
+    TDS_VALUE_T* array;
+    TDS_SIZE_T count, capacity;
+    tds_mapped_header_t* header; // Start of the mapping, NULL if nothing is mapped.
+    size_t mapped_size;
+    int file; // Only meaningful if `file_backed`.
+    char file_backed;
+} TDS_TYPE;
+
+int TDS_FUNCTION(open)(TDS_TYPE* vec, const char* path);
+int TDS_FUNCTION(sync)(const TDS_TYPE* vec);
+char TDS_FUNCTION(append)(TDS_TYPE* vec, TDS_VALUE_T value);
+char TDS_FUNCTION(reserve)(TDS_TYPE* vec, TDS_SIZE_T capacity);
+TDS_VALUE_T* TDS_FUNCTION(grow)(TDS_TYPE* vec, TDS_SIZE_T count);
+char TDS_FUNCTION(extend)(TDS_TYPE* vec, const TDS_VALUE_T* source, TDS_SIZE_T count);
+char TDS_FUNCTION(insert)(TDS_TYPE* vec, TDS_SIZE_T index, TDS_VALUE_T value);
+char TDS_FUNCTION(insert_many)(TDS_TYPE* vec, TDS_SIZE_T index, const TDS_VALUE_T* source, TDS_SIZE_T count);
+void TDS_FUNCTION(remove)(TDS_TYPE* vec, TDS_SIZE_T index);
+void TDS_FUNCTION(remove_swap)(TDS_TYPE* vec, TDS_SIZE_T index);
+void TDS_FUNCTION(remove_range)(TDS_TYPE* vec, TDS_SIZE_T index, TDS_SIZE_T count);
+TDS_SIZE_T TDS_FUNCTION(retain_if)(
+    TDS_TYPE* vec,
+    char (*predicate)(const TDS_VALUE_T* value, void* user_data),
+    void* user_data);
+TDS_VALUE_T TDS_FUNCTION(get)(const TDS_TYPE* vec, TDS_SIZE_T index);
+TDS_SIZE_T TDS_FUNCTION(count)(const TDS_TYPE* vec);
+TDS_VALUE_T* TDS_FUNCTION(first)(const TDS_TYPE* vec);
+void TDS_FUNCTION(clear)(TDS_TYPE* vec);
+void TDS_FUNCTION(reclaim)(TDS_TYPE* vec);
+void TDS_FUNCTION(fini)(TDS_TYPE* vec);
+#endif
+
+#ifdef TDS_IMPLEMENT
+static void TDS_FUNCTION(_set_count)(TDS_TYPE* vec, const TDS_SIZE_T count) {
+    vec->count = count;
+    // Kept in the mapping too, so it's there when the file is reopened.
+    vec->header->fields.count = count;
+}
+
+// Resizes the file and the mapping to `size` bytes, header included. Returns 0 and leaves the vector unchanged if
+// either can't be resized.
+static char TDS_FUNCTION(_remap)(TDS_TYPE* vec, const size_t size) {
+    // The file grows before the mapping and shrinks after it, so the mapping never reaches past its end.
+    const char growing = size > vec->mapped_size;
+    if (vec->file_backed && growing && ftruncate(vec->file, (off_t)size) != 0) {
+        return 0;
+    }
+
+    const int flags = vec->file_backed ? MAP_SHARED : MAP_PRIVATE | MAP_ANONYMOUS;
+    const int file = vec->file_backed ? vec->file : -1;
+    void* base;
+    if (!vec->header) {
+        base = mmap(NULL, size, PROT_READ | PROT_WRITE, flags, file, 0);
+    } else {
+#if defined(__linux__) && defined(MREMAP_MAYMOVE)
+        base = mremap(vec->header, vec->mapped_size, size, MREMAP_MAYMOVE);
+#else
+        // The old mapping is only dropped once the new one exists, so a failure loses nothing. A file already holds the
+        // data, so it's enough to map it again.
+        base = mmap(NULL, size, PROT_READ | PROT_WRITE, flags, file, 0);
+        if (base != MAP_FAILED) {
+            if (!vec->file_backed) {
+                TDS_MEMCPY(base, vec->header, size < vec->mapped_size ? size : vec->mapped_size);
+            }
+            munmap(vec->header, vec->mapped_size);
+        }
+#endif
+    }
+
+    if (base == MAP_FAILED) {
+        if (vec->file_backed && growing) {
+            const int result = ftruncate(vec->file, (off_t)vec->mapped_size);
+            (void)result;
+        }
+        return 0;
+    }
+    if (vec->file_backed && !growing) {
+        // A file that fails to shrink only wastes space.
+        const int result = ftruncate(vec->file, (off_t)size);
+        (void)result;
+    }
+
+    vec->header = base;
+    vec->mapped_size = size;
+    vec->array = (TDS_VALUE_T*)(vec->header + 1);
+    const size_t capacity = (size - sizeof(tds_mapped_header_t)) / sizeof(TDS_VALUE_T);
+    vec->capacity = capacity > (size_t)TDS_MAX_VALUE(TDS_SIZE_T) ? TDS_MAX_VALUE(TDS_SIZE_T) : (TDS_SIZE_T)capacity;
+    return 1;
+}
+
+// Opens the file at `path`, creating it if needed, and maps it. An existing file must have been written by a mapped
+// vector of the same value size. The vector must be empty. Returns 0 if the file can't be opened, mapped or isn't
+// valid.
+int TDS_FUNCTION(open)(TDS_TYPE* vec, const char* path) {
+    TDS_ASSERT(!vec->header);
+
+    const int file = open(path, O_RDWR | O_CREAT, 0644);
+    if (file < 0) {
+        return 0;
+    }
+
+    struct stat status;
+    if (fstat(file, &status) != 0) {
+        close(file);
+        return 0;
+    }
+
+    const size_t size = (size_t)status.st_size;
+    if (size == 0) {
+        vec->file = file;
+        vec->file_backed = 1;
+        if (!TDS_FUNCTION(_remap)(vec, tds_page_size())) {
+            close(file);
+            *vec = (TDS_TYPE){ 0 };
+            return 0;
+        }
+        vec->header->fields.magic = TDS_MAPPED_MAGIC;
+        vec->header->fields.value_size = sizeof(TDS_VALUE_T);
+        TDS_FUNCTION(_set_count)(vec, 0);
+        return 1;
+    }
+
+    if (size < sizeof(tds_mapped_header_t)) {
+        close(file);
+        return 0;
+    }
+
+    void* base = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, file, 0);
+    if (base == MAP_FAILED) {
+        close(file);
+        return 0;
+    }
+
+    const tds_mapped_header_t* header = base;
+    if (header->fields.magic != TDS_MAPPED_MAGIC
+        || header->fields.value_size != sizeof(TDS_VALUE_T)
+        || header->fields.count > (size - sizeof(tds_mapped_header_t)) / sizeof(TDS_VALUE_T)
+        || header->fields.count > (uint64_t)TDS_MAX_VALUE(TDS_SIZE_T)) {
+        munmap(base, size);
+        close(file);
+        return 0;
+    }
+
+    vec->file = file;
+    vec->file_backed = 1;
+    vec->header = base;
+    vec->mapped_size = size;
+    vec->array = (TDS_VALUE_T*)(vec->header + 1);
+    const size_t capacity = (size - sizeof(tds_mapped_header_t)) / sizeof(TDS_VALUE_T);
+    vec->capacity = capacity > (size_t)TDS_MAX_VALUE(TDS_SIZE_T) ? TDS_MAX_VALUE(TDS_SIZE_T) : (TDS_SIZE_T)capacity;
+    vec->count = (TDS_SIZE_T)header->fields.count;
+    return 1;
+}
+
+// Writes the mapped pages back to the file and waits for it. Returns 0 on failure.
+int TDS_FUNCTION(sync)(const TDS_TYPE* vec) {
+    if (!vec->file_backed || !vec->header) {
+        return 1;
+    }
+
+    return msync(vec->header, vec->mapped_size, MS_SYNC) == 0;
+}
+
+// Returns 0 if the vector couldn't grow.
+char TDS_FUNCTION(append)(TDS_TYPE* vec, const TDS_VALUE_T value) {
+    TDS_VALUE_T* slot = TDS_FUNCTION(grow)(vec, 1);
+    if (!slot) {
+        return 0;
+    }
+
+    *slot = value;
+    return 1;
+}
+
+// Reserves room for at least `capacity` elements. The mapping is rounded up to whole pages. Returns 0 if the file or the
+// mapping couldn't be resized.
+char TDS_FUNCTION(reserve)(TDS_TYPE* vec, const TDS_SIZE_T capacity) {
+    TDS_ASSERT(vec->count <= vec->capacity);
+
+    if (vec->header && capacity <= vec->capacity) {
+        return 1;
+    }
+
+    const size_t page = tds_page_size();
+    const size_t size = sizeof(tds_mapped_header_t) + (size_t)capacity * sizeof(TDS_VALUE_T);
+    return TDS_FUNCTION(_remap)(vec, (size + page - 1) / page * page);
+}
+
+// Returns a pointer to `count` new elements at the end, or NULL if the vector couldn't grow.
+TDS_VALUE_T* TDS_FUNCTION(grow)(TDS_TYPE* vec, const TDS_SIZE_T count) {
+    TDS_ASSERT(vec->count <= vec->capacity);
+
+    if (count == 0) {
+        return vec->array ? vec->array + vec->count : NULL;
+    }
+
+    const TDS_SIZE_T old_count = vec->count;
+    const TDS_SIZE_T needed = old_count + count;
+    // Guard against overflow and negative counts.
+    TDS_ASSERT(needed > old_count);
+
+    if (!vec->header || needed > vec->capacity) {
+        if (!TDS_FUNCTION(reserve)(vec, TDS_GROWN_CAPACITY(vec->capacity, needed))) {
+            return NULL;
+        }
+    }
+    TDS_FUNCTION(_set_count)(vec, needed);
+
+    return vec->array + old_count;
+}
+
+// Appends `count` values copied from `source`, which must not point into the vector. Returns 0 if the vector couldn't
+// grow.
+char TDS_FUNCTION(extend)(TDS_TYPE* vec, const TDS_VALUE_T* source, const TDS_SIZE_T count) {
+    if (count == 0) {
+        return 1;
+    }
+
+    TDS_VALUE_T* slots = TDS_FUNCTION(grow)(vec, count);
+    if (!slots) {
+        return 0;
+    }
+
+    TDS_MEMCPY(slots, source, (size_t)count * sizeof(TDS_VALUE_T));
+    return 1;
+}
+
+// Opens a gap of `count` elements at `index`, shifting later elements right, and returns a pointer to it, or NULL if
+// the vector couldn't grow.
+static TDS_VALUE_T* TDS_FUNCTION(_open_gap)(TDS_TYPE* vec, const TDS_SIZE_T index, const TDS_SIZE_T count) {
+    TDS_ASSERT(index <= vec->count);
+
+    const TDS_SIZE_T old_count = vec->count;
+    if (!TDS_FUNCTION(grow)(vec, count)) {
+        return NULL;
+    }
+    if (index < old_count) {
+        TDS_MEMMOVE(&vec->array[index + count], &vec->array[index], (size_t)(old_count - index) * sizeof(TDS_VALUE_T));
+    }
+
+    return vec->array + index;
+}
+
+// Inserts `value` at `index`, shifting later elements right. Returns 0 if the vector couldn't grow.
+char TDS_FUNCTION(insert)(TDS_TYPE* vec, const TDS_SIZE_T index, const TDS_VALUE_T value) {
+    TDS_VALUE_T* slot = TDS_FUNCTION(_open_gap)(vec, index, 1);
+    if (!slot) {
+        return 0;
+    }
+
+    *slot = value;
+    return 1;
+}
+
+// Inserts `count` values copied from `source` at `index`. `source` must not point into the vector. Returns 0 if the
+// vector couldn't grow.
+char TDS_FUNCTION(insert_many)(
+    TDS_TYPE* vec,
+    const TDS_SIZE_T index,
+    const TDS_VALUE_T* source,
+    const TDS_SIZE_T count
+) {
+    if (count == 0) {
+        TDS_ASSERT(index <= vec->count);
+        return 1;
+    }
+
+    TDS_VALUE_T* slots = TDS_FUNCTION(_open_gap)(vec, index, count);
+    if (!slots) {
+        return 0;
+    }
+
+    TDS_MEMCPY(slots, source, (size_t)count * sizeof(TDS_VALUE_T));
+    return 1;
+}
+
+void TDS_FUNCTION(remove)(TDS_TYPE* vec, const TDS_SIZE_T index) {
+    TDS_ASSERT(index < vec->count);
+
+    if (index < vec->count - 1) {
+        // Shift elements to the left
+        TDS_MEMMOVE(&vec->array[index], &vec->array[index + 1], (size_t)(vec->count - index - 1) * sizeof(TDS_VALUE_T));
+    }
+    TDS_FUNCTION(_set_count)(vec, vec->count - 1);
+}
+
+// Removes the element at `index` in O(1) by moving the last element into its place. Doesn't preserve order.
+void TDS_FUNCTION(remove_swap)(TDS_TYPE* vec, const TDS_SIZE_T index) {
+    TDS_ASSERT(index < vec->count);
+
+    vec->array[index] = vec->array[vec->count - 1];
+    TDS_FUNCTION(_set_count)(vec, vec->count - 1);
+}
+
+// Removes `count` elements starting at `index` with a single shift of the elements after them.
+void TDS_FUNCTION(remove_range)(TDS_TYPE* vec, const TDS_SIZE_T index, const TDS_SIZE_T count) {
+    TDS_ASSERT(index <= vec->count && count <= vec->count - index);
+
+    if (count == 0) {
+        return;
+    }
+
+    const TDS_SIZE_T end = index + count;
+    if (end < vec->count) {
+        TDS_MEMMOVE(&vec->array[index], &vec->array[end], (size_t)(vec->count - end) * sizeof(TDS_VALUE_T));
+    }
+    TDS_FUNCTION(_set_count)(vec, vec->count - count);
+}
+
+// Keeps only the elements `predicate` returns nonzero for, preserving their order, in one pass. Returns how many
+// elements were removed.
+TDS_SIZE_T TDS_FUNCTION(retain_if)(
+    TDS_TYPE* vec,
+    char (*predicate)(const TDS_VALUE_T* value, void* user_data),
+    void* user_data
+) {
+    TDS_SIZE_T kept = 0;
+    for (TDS_SIZE_T i = 0; i < vec->count; i++) {
+        if (predicate(&vec->array[i], user_data)) {
+            vec->array[kept++] = vec->array[i];
+        }
+    }
+
+    const TDS_SIZE_T removed = vec->count - kept;
+    if (removed) {
+        TDS_FUNCTION(_set_count)(vec, kept);
+    }
+    return removed;
+}
+
+TDS_VALUE_T TDS_FUNCTION(get)(const TDS_TYPE* vec, const TDS_SIZE_T index) {
+    TDS_ASSERT(index < vec->count);
+    return vec->array[index];
+}
+
+TDS_SIZE_T TDS_FUNCTION(count)(const TDS_TYPE* vec) {
+    return vec->count;
+}
+
+TDS_VALUE_T* TDS_FUNCTION(first)(const TDS_TYPE* vec) {
+    return vec->array;
+}
+
+void TDS_FUNCTION(clear)(TDS_TYPE* vec) {
+    if (vec->header) {
+        TDS_FUNCTION(_set_count)(vec, 0);
+    }
+}
+
+// Shrinks the file and the mapping to the pages needed by `count` elements. An empty anonymous vector is unmapped.
+void TDS_FUNCTION(reclaim)(TDS_TYPE* vec) {
+    if (!vec->header) {
+        return;
+    }
+
+    if (vec->count == 0 && !vec->file_backed) {
+        munmap(vec->header, vec->mapped_size);
+        *vec = (TDS_TYPE){ 0 };
+        return;
+    }
+
+    const size_t page = tds_page_size();
+    const size_t size = sizeof(tds_mapped_header_t) + (size_t)vec->count * sizeof(TDS_VALUE_T);
+    const size_t rounded = (size + page - 1) / page * page;
+    if (rounded < vec->mapped_size) {
+        // A mapping that can't shrink is still valid, so it's just kept.
+        (void)TDS_FUNCTION(_remap)(vec, rounded);
+    }
+}
+
+// Unmaps the vector and closes its file, which keeps the elements.
+void TDS_FUNCTION(fini)(TDS_TYPE* vec) {
+    if (vec->header) {
+        munmap(vec->header, vec->mapped_size);
+    }
+    if (vec->file_backed) {
+        close(vec->file);
+    }
+    *vec = (TDS_TYPE){ 0 };
+}
+#endif
+
+#include "private/end.inc"
+
@@ -0,0 +1,114 @@
+#pragma once
+#ifndef _TDS_PARALLEL_H_
+#define _TDS_PARALLEL_H_
+
+#include "private/common.h"
+#include "private/atomic.h"
+
+// Executors run the tasks of the parallel container functions. The default one starts threads with pthreads, and
+// embedders can plug in their own thread pool instead. Like `arena.h`, this isn't a generator.
+
+#if !defined(TDS_NO_THREADS) && !defined(_WIN32)
+#include <pthread.h>
+#include <unistd.h>
+#define TDS_PTHREADS
+#endif
+
+// Minimum number of elements per task. Smaller inputs are processed on the calling thread.
+#ifndef TDS_PARALLEL_GRAIN
+#define TDS_PARALLEL_GRAIN ((size_t)4096)
+#endif
+
+// The default executor never starts more threads than this per call.
+#ifndef TDS_PARALLEL_MAX_THREADS
+#define TDS_PARALLEL_MAX_THREADS 256
+#endif
+
+typedef struct tds_executor_t {
+    // Calls `task(argument, index)` once for every index in [0, count), possibly concurrently, and returns when all of
+    // them have finished.
+    void (*run)(void* user_data, void (*task)(void* argument, size_t index), void* argument, size_t count);
+    // How many tasks the executor runs at once. Zero means one per online CPU.
+    size_t concurrency;
+    void* user_data;
+} tds_executor_t;
+
+static inline size_t tds_hardware_concurrency(void) {
+#if defined(TDS_PTHREADS) && defined(_SC_NPROCESSORS_ONLN)
+    const long count = sysconf(_SC_NPROCESSORS_ONLN);
+    return count > 1 ? (size_t)count : 1;
+#else
+    return 1;
+#endif
+}
+
+typedef struct tds_parallel_job_t {
+    void (*task)(void* argument, size_t index);
+    void* argument;
+    size_t count;
+    volatile size_t next;
+} tds_parallel_job_t;
+
+// Tasks are handed out one at a time, so threads that finish early pick up the remaining ones.
+static inline void* tds_parallel_worker(void* job_pointer) {
+    tds_parallel_job_t* job = job_pointer;
+    for (size_t index = tds_atomic_fetch_add(&job->next, 1); index < job->count;
+         index = tds_atomic_fetch_add(&job->next, 1)) {
+        job->task(job->argument, index);
+    }
+    return NULL;
+}
+
+// Starts a thread per task, up to the number of CPUs, for the duration of the call. The calling thread works too.
+static inline void tds_thread_run(
+    void* user_data,
+    void (*task)(void* argument, size_t index),
+    void* argument,
+    const size_t count
+) {
+    (void)user_data;
+    tds_parallel_job_t job = { .task = task, .argument = argument, .count = count, .next = 0 };
+
+#ifdef TDS_PTHREADS
+    size_t thread_count = tds_hardware_concurrency();
+    if (thread_count > count) {
+        thread_count = count;
+    }
+    if (thread_count > TDS_PARALLEL_MAX_THREADS) {
+        thread_count = TDS_PARALLEL_MAX_THREADS;
+    }
+
+    pthread_t threads[TDS_PARALLEL_MAX_THREADS];
+    size_t started = 0;
+    while (started + 1 < thread_count && pthread_create(&threads[started], NULL, tds_parallel_worker, &job) == 0) {
+        started++;
+    }
+
+    // If threads couldn't be created, the calling thread does their share.
+    tds_parallel_worker(&job);
+    for (size_t i = 0; i < started; i++) {
+        pthread_join(threads[i], NULL);
+    }
+#else
+    tds_parallel_worker(&job);
+#endif
+}
+
+// The executor used when a parallel function is given NULL.
+static inline const tds_executor_t* tds_default_executor(void) {
+    static const tds_executor_t executor = { .run = tds_thread_run };
+    return &executor;
+}
+
+// How many tasks to split `count` elements into so that every task gets at least TDS_PARALLEL_GRAIN of them, with a
+// few tasks per worker to balance the load.
+static inline size_t tds_parallel_task_count(const tds_executor_t* executor, const size_t count, const size_t per_worker) {
+    const size_t workers = executor->concurrency ? executor->concurrency : tds_hardware_concurrency();
+    const size_t most = count / TDS_PARALLEL_GRAIN;
+    const size_t tasks = workers * per_worker;
+    if (tasks < most) {
+        return tasks;
+    }
+    return most > 1 ? most : 1;
+}
+#endif
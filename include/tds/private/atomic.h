@@ -0,0 +1,166 @@
+#pragma once
+#ifndef _TDS_PRIVATE_ATOMIC_H_
+#define _TDS_PRIVATE_ATOMIC_H_
+
+// Minimal atomics, thread-local storage and spinlocks shared by the thread-aware headers. Written against compiler
+// intrinsics instead of <stdatomic.h> so that MSVC in C mode is supported too.
+
+#include <stddef.h>
+
+#if defined(_MSC_VER) && !defined(__clang__)
+#include <intrin.h>
+#define TDS_THREAD_LOCAL __declspec(thread)
+#elif defined(__STDC_VERSION__) && __STDC_VERSION__ >= 201112L
+#define TDS_THREAD_LOCAL _Thread_local
+#else
+#define TDS_THREAD_LOCAL __thread
+#endif
+
+#if defined(_MSC_VER) && !defined(__clang__)
+#ifdef _WIN64
+#define TDS_INTERLOCKED(name) name##64
+#define TDS_INTERLOCKED_T __int64
+#else
+#define TDS_INTERLOCKED(name) name
+#define TDS_INTERLOCKED_T long
+#endif
+
+static inline size_t tds_atomic_load(volatile size_t* pointer) {
+    return (size_t)TDS_INTERLOCKED(_InterlockedCompareExchange)((volatile TDS_INTERLOCKED_T*)pointer, 0, 0);
+}
+
+static inline void tds_atomic_store(volatile size_t* pointer, const size_t value) {
+    (void)TDS_INTERLOCKED(_InterlockedExchange)((volatile TDS_INTERLOCKED_T*)pointer, (TDS_INTERLOCKED_T)value);
+}
+
+static inline size_t tds_atomic_exchange(volatile size_t* pointer, const size_t value) {
+    return (size_t)TDS_INTERLOCKED(_InterlockedExchange)((volatile TDS_INTERLOCKED_T*)pointer, (TDS_INTERLOCKED_T)value);
+}
+
+static inline size_t tds_atomic_fetch_add(volatile size_t* pointer, const size_t value) {
+    return (size_t)TDS_INTERLOCKED(_InterlockedExchangeAdd)(
+        (volatile TDS_INTERLOCKED_T*)pointer,
+        (TDS_INTERLOCKED_T)value);
+}
+
+static inline int tds_atomic_compare_exchange(volatile size_t* pointer, size_t* expected, const size_t desired) {
+    const size_t previous = (size_t)TDS_INTERLOCKED(_InterlockedCompareExchange)(
+        (volatile TDS_INTERLOCKED_T*)pointer,
+        (TDS_INTERLOCKED_T)desired,
+        (TDS_INTERLOCKED_T)*expected);
+    if (previous == *expected) {
+        return 1;
+    }
+    *expected = previous;
+    return 0;
+}
+
+static inline void* tds_atomic_load_pointer(void* volatile* pointer) {
+    return _InterlockedCompareExchangePointer(pointer, NULL, NULL);
+}
+
+static inline void tds_atomic_store_pointer(void* volatile* pointer, void* value) {
+    (void)_InterlockedExchangePointer(pointer, value);
+}
+
+static inline int tds_atomic_compare_exchange_pointer(void* volatile* pointer, void** expected, void* desired) {
+    void* previous = _InterlockedCompareExchangePointer(pointer, desired, *expected);
+    if (previous == *expected) {
+        return 1;
+    }
+    *expected = previous;
+    return 0;
+}
+
+static inline char tds_atomic_load_char(volatile char* pointer) {
+    return _InterlockedCompareExchange8(pointer, 0, 0);
+}
+
+static inline void tds_atomic_store_char(volatile char* pointer, const char value) {
+    (void)_InterlockedExchange8(pointer, value);
+}
+
+static inline void tds_atomic_fence(void) {
+    volatile long barrier = 0;
+    (void)_InterlockedOr(&barrier, 0);
+}
+
+static inline void tds_cpu_relax(void) {
+#if defined(_M_IX86) || defined(_M_X64)
+    _mm_pause();
+#elif defined(_M_ARM) || defined(_M_ARM64)
+    __yield();
+#endif
+}
+#else
+static inline size_t tds_atomic_load(volatile size_t* pointer) {
+    return __atomic_load_n(pointer, __ATOMIC_ACQUIRE);
+}
+
+static inline void tds_atomic_store(volatile size_t* pointer, const size_t value) {
+    __atomic_store_n(pointer, value, __ATOMIC_RELEASE);
+}
+
+static inline size_t tds_atomic_exchange(volatile size_t* pointer, const size_t value) {
+    return __atomic_exchange_n(pointer, value, __ATOMIC_ACQ_REL);
+}
+
+static inline size_t tds_atomic_fetch_add(volatile size_t* pointer, const size_t value) {
+    return __atomic_fetch_add(pointer, value, __ATOMIC_ACQ_REL);
+}
+
+static inline int tds_atomic_compare_exchange(volatile size_t* pointer, size_t* expected, const size_t desired) {
+    return __atomic_compare_exchange_n(pointer, expected, desired, 0, __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE);
+}
+
+static inline void* tds_atomic_load_pointer(void* volatile* pointer) {
+    return __atomic_load_n(pointer, __ATOMIC_ACQUIRE);
+}
+
+static inline void tds_atomic_store_pointer(void* volatile* pointer, void* value) {
+    __atomic_store_n(pointer, value, __ATOMIC_RELEASE);
+}
+
+static inline int tds_atomic_compare_exchange_pointer(void* volatile* pointer, void** expected, void* desired) {
+    return __atomic_compare_exchange_n(pointer, expected, desired, 0, __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE);
+}
+
+static inline char tds_atomic_load_char(volatile char* pointer) {
+    return __atomic_load_n(pointer, __ATOMIC_ACQUIRE);
+}
+
+static inline void tds_atomic_store_char(volatile char* pointer, const char value) {
+    __atomic_store_n(pointer, value, __ATOMIC_RELEASE);
+}
+
+// A full barrier: stores before it become visible to every thread before loads after it are performed.
+static inline void tds_atomic_fence(void) {
+    __atomic_thread_fence(__ATOMIC_SEQ_CST);
+}
+
+static inline void tds_cpu_relax(void) {
+#if defined(__i386__) || defined(__x86_64__)
+    __builtin_ia32_pause();
+#elif defined(__aarch64__) || defined(__arm__)
+    __asm__ __volatile__("yield");
+#endif
+}
+#endif
+
+typedef struct tds_spinlock_t {
+    volatile size_t locked;
+} tds_spinlock_t;
+
+static inline void tds_spinlock_lock(tds_spinlock_t* lock) {
+    while (tds_atomic_exchange(&lock->locked, 1)) {
+        // Spin on a plain load so the cache line isn't bounced around while the lock is held.
+        while (tds_atomic_load(&lock->locked)) {
+            tds_cpu_relax();
+        }
+    }
+}
+
+static inline void tds_spinlock_unlock(tds_spinlock_t* lock) {
+    tds_atomic_store(&lock->locked, 0);
+}
+#endif
@@ -68,6 +68,51 @@
 #define TDS_MEMCPY memcpy
 #endif
 
+#ifndef TDS_CACHE_LINE_SIZE
+#define TDS_CACHE_LINE_SIZE 64
+#endif
+
+#ifndef TDS_HUGE_PAGE_SIZE
+#define TDS_HUGE_PAGE_SIZE ((size_t)2 << 20)
+#endif
+
+#ifndef TDS_HUGE_PAGE_THRESHOLD
+#define TDS_HUGE_PAGE_THRESHOLD ((size_t)4 << 20)
+#endif
+
+// Vectors multiply their capacity by TDS_GROWTH_NUM / TDS_GROWTH_DEN whenever `append` or `grow` run out of room.
+#ifndef TDS_GROWTH_NUM
+#define TDS_GROWTH_NUM 3
+#endif
+
+#ifndef TDS_GROWTH_DEN
+#define TDS_GROWTH_DEN 2
+#endif
+
+#if TDS_GROWTH_NUM <= TDS_GROWTH_DEN
+#error "TDS_GROWTH_NUM / TDS_GROWTH_DEN must be greater than 1."
+#endif
+
+#if defined(TDS_ALIGNED_ALLOC) != defined(TDS_ALIGNED_FREE)
+#error "TDS_ALIGNED_ALLOC and TDS_ALIGNED_FREE must be defined together."
+#endif
+
+#if defined(__linux__) && !defined(TDS_NO_HUGE_PAGES)
+#include <sys/mman.h>
+#endif
+
+#if defined(__GNUC__) || defined(__clang__)
+#define TDS_PREFETCH(address) __builtin_prefetch(address)
+#elif defined(_MSC_VER) && (defined(_M_IX86) || defined(_M_X64))
+#include <xmmintrin.h>
+#define TDS_PREFETCH(address) _mm_prefetch((const char*)(address), _MM_HINT_T0)
+#else
+#define TDS_PREFETCH(address) ((void)(address))
+#endif
+
+// How many probes bulk operations issue prefetches for before doing them.
+#define TDS_PROBE_BATCH 8
+
 #ifndef TDS_ASSERT
 #ifdef NDEBUG
 #define TDS_ASSERT(x) ((void)0)
@@ -78,4 +123,193 @@
 #endif
 
 #define TDS_FUNCTION(name) TDS_JOIN3(TDS_TYPE, _, name)
+
+#include <stddef.h>
+#include <stdint.h>
+
+// MurmurHash3's 64-bit finalizer. Used to derive more hashes from a single TDS_HASH_KEY result.
+static inline uint64_t tds_mix64(uint64_t x) {
+    x ^= x >> 33;
+    x *= 0xff51afd7ed558ccdull;
+    x ^= x >> 33;
+    x *= 0xc4ceb9fe1a85ec53ull;
+    x ^= x >> 33;
+    return x;
+}
+
+// Index of the lowest set bit of a nonzero word.
+static inline unsigned tds_lowest_bit(const uint64_t x) {
+#if defined(__GNUC__) || defined(__clang__)
+    return (unsigned)__builtin_ctzll(x);
+#else
+    unsigned index = 0;
+    while (!((x >> index) & 1)) {
+        index++;
+    }
+    return index;
+#endif
+}
+
+// Index of the highest set bit of a nonzero word.
+static inline unsigned tds_highest_bit(const uint64_t x) {
+#if defined(__GNUC__) || defined(__clang__)
+    return 63 - (unsigned)__builtin_clzll(x);
+#else
+    unsigned index = 63;
+    while (!((x >> index) & 1)) {
+        index--;
+    }
+    return index;
+#endif
+}
+
+// Capacity for a vector to grow to from `capacity` so that `needed` elements fit. It grows geometrically, so appends are
+// amortized O(1), to at least `initial`, and never past `max`, the largest count the vector can hold.
+static inline size_t tds_grown_capacity(
+    const size_t capacity, const size_t needed, const size_t initial, const size_t max) {
+    size_t grown = capacity > (size_t)-1 / TDS_GROWTH_NUM ? max : capacity * TDS_GROWTH_NUM / TDS_GROWTH_DEN;
+    if (grown < initial) {
+        grown = initial;
+    }
+    if (grown < needed) {
+        grown = needed;
+    }
+    return grown < max ? grown : max;
+}
+
+// Asks the kernel to back the huge-page-aligned interior of a large allocation with transparent huge pages.
+static inline void tds_advise_huge_pages(void* pointer, const size_t size) {
+#if defined(MADV_HUGEPAGE)
+    if (!pointer || size < TDS_HUGE_PAGE_THRESHOLD) {
+        return;
+    }
+
+    const uintptr_t begin = ((uintptr_t)pointer + TDS_HUGE_PAGE_SIZE - 1) & ~(uintptr_t)(TDS_HUGE_PAGE_SIZE - 1);
+    const uintptr_t end = ((uintptr_t)pointer + size) & ~(uintptr_t)(TDS_HUGE_PAGE_SIZE - 1);
+    if (begin < end) {
+        // Purely a hint, failure is harmless.
+        (void)madvise((void*)begin, end - begin, MADV_HUGEPAGE);
+    }
+#else
+    (void)pointer;
+    (void)size;
+#endif
+}
+
+#ifndef TDS_ALIGNED_ALLOC
+// Default aligned allocation built on top of TDS_CALLOC and TDS_FREE, so custom allocators keep working. The original
+// pointer is stored right before the aligned block.
+static inline void* tds_aligned_alloc(const size_t alignment, const size_t size) {
+    TDS_ASSERT(alignment && (alignment & (alignment - 1)) == 0);
+
+    char* raw = TDS_CALLOC(1, size + alignment + sizeof(void*));
+    if (!raw) {
+        return NULL;
+    }
+
+    const uintptr_t aligned = ((uintptr_t)raw + sizeof(void*) + alignment - 1) & ~(uintptr_t)(alignment - 1);
+    TDS_MEMCPY((char*)aligned - sizeof(void*), &raw, sizeof(void*));
+    return (void*)aligned;
+}
+
+static inline void tds_aligned_free(void* pointer) {
+    if (!pointer) {
+        return;
+    }
+
+    void* raw;
+    TDS_MEMCPY(&raw, (char*)pointer - sizeof(void*), sizeof(void*));
+    TDS_FREE(raw);
+}
+
+#define TDS_ALIGNED_ALLOC tds_aligned_alloc
+#define TDS_ALIGNED_FREE tds_aligned_free
+// Memory from TDS_CALLOC is already zeroed, so `tds_allocate` doesn't clear it again.
+#define TDS_ALIGNED_ALLOC_ZEROES
+#endif
+
+// Per-instance allocator used by containers generated with TDS_ALLOCATOR. `reallocate` may be NULL, in which case
+// reallocation is emulated with `allocate` and `deallocate`. Memory doesn't need to be zeroed by `allocate`.
+typedef struct tds_allocator_t {
+    void* (*allocate)(void* user_data, size_t size, size_t alignment);
+    void* (*reallocate)(void* user_data, void* pointer, size_t old_size, size_t new_size, size_t alignment);
+    void (*deallocate)(void* user_data, void* pointer, size_t size, size_t alignment);
+    void* user_data;
+} tds_allocator_t;
+
+// Internal allocation helpers used by every container. A NULL allocator means the global TDS_* allocation macros. An
+// alignment of zero means "whatever TDS_CALLOC returns" and maps directly onto TDS_CALLOC, TDS_REALLOC and TDS_FREE.
+// New memory returned by `tds_allocate` is zeroed.
+static inline size_t tds_effective_alignment(const size_t size, const size_t alignment) {
+#if defined(MADV_HUGEPAGE)
+    if (alignment && size >= TDS_HUGE_PAGE_THRESHOLD && alignment < TDS_HUGE_PAGE_SIZE) {
+        return TDS_HUGE_PAGE_SIZE;
+    }
+#else
+    (void)size;
+#endif
+    return alignment;
+}
+
+static inline void* tds_allocate(const tds_allocator_t* allocator, const size_t size, const size_t alignment) {
+    if (allocator) {
+        void* pointer = allocator->allocate(allocator->user_data, size, alignment);
+        TDS_MEMSET(pointer, 0, size);
+        return pointer;
+    }
+
+    void* pointer = alignment
+        ? TDS_ALIGNED_ALLOC(tds_effective_alignment(size, alignment), size)
+        : TDS_CALLOC(1, size);
+#ifndef TDS_ALIGNED_ALLOC_ZEROES
+    // A custom TDS_ALIGNED_ALLOC doesn't have to zero its memory.
+    if (alignment && pointer) {
+        TDS_MEMSET(pointer, 0, size);
+    }
+#endif
+    tds_advise_huge_pages(pointer, size);
+    return pointer;
+}
+
+static inline void tds_deallocate(
+    const tds_allocator_t* allocator,
+    void* pointer,
+    const size_t size,
+    const size_t alignment
+) {
+    if (allocator) {
+        if (pointer) {
+            allocator->deallocate(allocator->user_data, pointer, size, alignment);
+        }
+    } else if (alignment) {
+        TDS_ALIGNED_FREE(pointer);
+    } else {
+        TDS_FREE(pointer);
+    }
+}
+
+static inline void* tds_reallocate(
+    const tds_allocator_t* allocator,
+    void* pointer,
+    const size_t old_size,
+    const size_t new_size,
+    const size_t alignment
+) {
+    if (allocator && allocator->reallocate) {
+        return allocator->reallocate(allocator->user_data, pointer, old_size, new_size, alignment);
+    }
+
+    if (!allocator && !alignment) {
+        pointer = TDS_REALLOC(pointer, new_size);
+        tds_advise_huge_pages(pointer, new_size);
+        return pointer;
+    }
+
+    void* new_pointer = tds_allocate(allocator, new_size, alignment);
+    if (pointer) {
+        TDS_MEMCPY(new_pointer, pointer, old_size < new_size ? old_size : new_size);
+        tds_deallocate(allocator, pointer, old_size, alignment);
+    }
+    return new_pointer;
+}
 #endif
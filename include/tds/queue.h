@@ -5,10 +5,17 @@
 #define TDS_TYPE TDS_DEFAULT_TYPE_W_VALUE(queue)
 #endif
 
+#ifndef TDS_ALIGNMENT
+#define TDS_ALIGNMENT 0
+#endif
+
 #ifdef TDS_DECLARE
 typedef struct TDS_TYPE {
     TDS_VALUE_T* array;
     TDS_SIZE_T head, count, capacity;
+#ifdef TDS_ALLOCATOR
+    const tds_allocator_t* allocator;
+#endif
 } TDS_TYPE;
 
 void TDS_FUNCTION(push)(TDS_TYPE* queue, TDS_VALUE_T value);
@@ -26,7 +33,7 @@ static void TDS_FUNCTION(_reallocate)(TDS_TYPE* queue, const TDS_SIZE_T capacity
     TDS_ASSERT(queue->count <= queue->capacity);
     TDS_ASSERT(queue->count <= capacity);
 
-    TDS_VALUE_T* array = TDS_CALLOC(capacity, sizeof(TDS_VALUE_T));
+    TDS_VALUE_T* array = tds_allocate(TDS_ALLOCATOR_OF(queue), (size_t)capacity * sizeof(TDS_VALUE_T), TDS_ALIGNMENT);
     if (queue->count) {
         const TDS_SIZE_T first_count = queue->count < queue->capacity - queue->head
                 ? queue->count
@@ -40,7 +47,7 @@ static void TDS_FUNCTION(_reallocate)(TDS_TYPE* queue, const TDS_SIZE_T capacity
         }
     }
 
-    TDS_FREE(queue->array);
+    tds_deallocate(TDS_ALLOCATOR_OF(queue), queue->array, (size_t)queue->capacity * sizeof(TDS_VALUE_T), TDS_ALIGNMENT);
     queue->array = array;
     queue->head = 0;
     queue->capacity = capacity;
@@ -112,8 +119,8 @@ void TDS_FUNCTION(reclaim)(TDS_TYPE* queue) {
         return;
     }
     if (queue->count == 0) {
-        TDS_FREE(queue->array);
-        *queue = (TDS_TYPE){ 0 };
+        tds_deallocate(TDS_ALLOCATOR_OF(queue), queue->array, (size_t)queue->capacity * sizeof(TDS_VALUE_T), TDS_ALIGNMENT);
+        TDS_RESET(queue);
         return;
     }
     TDS_FUNCTION(_reallocate)(queue, queue->count);
@@ -121,8 +128,8 @@ void TDS_FUNCTION(reclaim)(TDS_TYPE* queue) {
 
 void TDS_FUNCTION(fini)(TDS_TYPE* queue) {
     TDS_FUNCTION(clear)(queue);
-    TDS_FREE(queue->array);
-    *queue = (TDS_TYPE){ 0 };
+    tds_deallocate(TDS_ALLOCATOR_OF(queue), queue->array, (size_t)queue->capacity * sizeof(TDS_VALUE_T), TDS_ALIGNMENT);
+    TDS_RESET(queue);
 }
 #endif
 
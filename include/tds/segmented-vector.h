@@ -0,0 +1,195 @@
+#include "private/common.h"
+#include "private/begin.inc"
+
+// A vector stored in segments that double in size, so growing it allocates a new segment instead of moving the
+// elements, and pointers to elements stay valid until they are removed. Segment `k` holds
+// `1 << (TDS_SEGMENT_SHIFT + k)` elements, and element `i` is found with a bit scan of `i + (1 << TDS_SEGMENT_SHIFT)`.
+
+#ifndef TDS_TYPE
+#define TDS_TYPE TDS_DEFAULT_TYPE_W_VALUE(segmented_vec)
+#endif
+
+#ifndef TDS_ALIGNMENT
+#define TDS_ALIGNMENT 0
+#endif
+
+// The first segment holds 1 << TDS_SEGMENT_SHIFT elements.
+#ifndef TDS_SEGMENT_SHIFT
+#define TDS_SEGMENT_SHIFT 3
+#endif
+
+#if TDS_SEGMENT_SHIFT < 0 || TDS_SEGMENT_SHIFT > 30
+#error "TDS_SEGMENT_SHIFT must be between 0 and 30."
+#endif
+
+// Enough segments to address every index representable by TDS_SIZE_T.
+#define TDS_SEGMENT_COUNT (sizeof(TDS_SIZE_T) * 8)
+
+#ifdef TDS_DECLARE
+typedef struct TDS_TYPE {
+    TDS_VALUE_T* segments[TDS_SEGMENT_COUNT];
+    TDS_SIZE_T count;
+    TDS_SIZE_T capacity; // Elements in the allocated segments.
+#ifdef TDS_ALLOCATOR
+    const tds_allocator_t* allocator;
+#endif
+} TDS_TYPE;
+
+// Iterates over the used part of each segment.
+typedef struct TDS_JOIN2(TDS_TYPE, _iter_t) {
+    const TDS_TYPE* vec;
+    TDS_SIZE_T _segment;
+    TDS_SIZE_T _index; // Index of the first element of the next chunk.
+    TDS_VALUE_T* values;
+    TDS_SIZE_T count;
+} TDS_JOIN2(TDS_TYPE, _iter_t);
+
+TDS_VALUE_T* TDS_FUNCTION(append)(TDS_TYPE* vec, TDS_VALUE_T value);
+void TDS_FUNCTION(reserve)(TDS_TYPE* vec, TDS_SIZE_T capacity);
+TDS_VALUE_T* TDS_FUNCTION(at)(const TDS_TYPE* vec, TDS_SIZE_T index);
+TDS_VALUE_T TDS_FUNCTION(get)(const TDS_TYPE* vec, TDS_SIZE_T index);
+void TDS_FUNCTION(remove_swap)(TDS_TYPE* vec, TDS_SIZE_T index);
+TDS_SIZE_T TDS_FUNCTION(count)(const TDS_TYPE* vec);
+TDS_JOIN2(TDS_TYPE, _iter_t) TDS_FUNCTION(iter)(const TDS_TYPE* vec);
+char TDS_FUNCTION(next)(TDS_JOIN2(TDS_TYPE, _iter_t)* iter);
+void TDS_FUNCTION(clear)(TDS_TYPE* vec);
+void TDS_FUNCTION(reclaim)(TDS_TYPE* vec);
+void TDS_FUNCTION(fini)(TDS_TYPE* vec);
+#endif
+
+#ifdef TDS_IMPLEMENT
+static size_t TDS_FUNCTION(_segment_size)(const size_t segment) {
+    return (size_t)1 << (TDS_SEGMENT_SHIFT + segment);
+}
+
+// Elements held by the first `segments` segments.
+static size_t TDS_FUNCTION(_capacity_of)(const size_t segments) {
+    return (((size_t)1 << segments) - 1) << TDS_SEGMENT_SHIFT;
+}
+
+// Allocates segments until `capacity` elements fit.
+void TDS_FUNCTION(reserve)(TDS_TYPE* vec, const TDS_SIZE_T capacity) {
+    size_t segment = 0;
+    while (vec->segments[segment]) {
+        segment++;
+    }
+
+    while (vec->capacity < capacity) {
+        TDS_ASSERT(segment < TDS_SEGMENT_COUNT);
+        const size_t size = TDS_FUNCTION(_segment_size)(segment);
+        vec->segments[segment] = tds_allocate(TDS_ALLOCATOR_OF(vec), size * sizeof(TDS_VALUE_T), TDS_ALIGNMENT);
+
+        const size_t total = TDS_FUNCTION(_capacity_of)(++segment);
+        vec->capacity = total > (size_t)TDS_MAX_VALUE(TDS_SIZE_T) ? TDS_MAX_VALUE(TDS_SIZE_T) : (TDS_SIZE_T)total;
+    }
+}
+
+// Appends a value and returns its address, which stays valid until the element is removed.
+TDS_VALUE_T* TDS_FUNCTION(append)(TDS_TYPE* vec, const TDS_VALUE_T value) {
+    TDS_ASSERT(vec->count < TDS_MAX_VALUE(TDS_SIZE_T));
+
+    if (vec->count == vec->capacity) {
+        TDS_FUNCTION(reserve)(vec, vec->count + 1);
+    }
+
+    TDS_VALUE_T* slot = TDS_FUNCTION(at)(vec, vec->count++);
+    *slot = value;
+    return slot;
+}
+
+TDS_VALUE_T* TDS_FUNCTION(at)(const TDS_TYPE* vec, const TDS_SIZE_T index) {
+    TDS_ASSERT(index < vec->capacity);
+
+    const uint64_t position = (uint64_t)index + ((uint64_t)1 << TDS_SEGMENT_SHIFT);
+    const unsigned bit = tds_highest_bit(position);
+    return vec->segments[bit - TDS_SEGMENT_SHIFT] + (position ^ ((uint64_t)1 << bit));
+}
+
+TDS_VALUE_T TDS_FUNCTION(get)(const TDS_TYPE* vec, const TDS_SIZE_T index) {
+    TDS_ASSERT(index < vec->count);
+    return *TDS_FUNCTION(at)(vec, index);
+}
+
+// Removes the element at `index` in O(1) by moving the last element into its place. Doesn't preserve order, and
+// invalidates pointers to the last element.
+void TDS_FUNCTION(remove_swap)(TDS_TYPE* vec, const TDS_SIZE_T index) {
+    TDS_ASSERT(index < vec->count);
+
+    TDS_VALUE_T* slot = TDS_FUNCTION(at)(vec, index);
+#ifdef TDS_VALUE_FINI
+    TDS_VALUE_FINI((*slot));
+#endif
+
+    vec->count--;
+    *slot = *TDS_FUNCTION(at)(vec, vec->count);
+}
+
+TDS_SIZE_T TDS_FUNCTION(count)(const TDS_TYPE* vec) {
+    return vec->count;
+}
+
+TDS_JOIN2(TDS_TYPE, _iter_t) TDS_FUNCTION(iter)(const TDS_TYPE* vec) {
+    return (TDS_JOIN2(TDS_TYPE, _iter_t)) {
+        .vec = vec,
+        ._segment = 0,
+        ._index = 0,
+    };
+}
+
+// Moves to the next segment holding elements, setting `values` and `count` to the part of it in use.
+char TDS_FUNCTION(next)(TDS_JOIN2(TDS_TYPE, _iter_t)* iter) {
+    if (iter->_index >= iter->vec->count) {
+        return 0;
+    }
+
+    const size_t size = TDS_FUNCTION(_segment_size)(iter->_segment);
+    const size_t remaining = (size_t)(iter->vec->count - iter->_index);
+    iter->values = iter->vec->segments[iter->_segment++];
+    iter->count = (TDS_SIZE_T)(remaining < size ? remaining : size);
+    iter->_index += iter->count;
+    return 1;
+}
+
+void TDS_FUNCTION(clear)(TDS_TYPE* vec) {
+#ifdef TDS_VALUE_FINI
+    TDS_JOIN2(TDS_TYPE, _iter_t) it = TDS_FUNCTION(iter)(vec);
+    while (TDS_FUNCTION(next)(&it)) {
+        for (TDS_SIZE_T i = 0; i < it.count; i++) {
+            TDS_VALUE_FINI(it.values[i]);
+        }
+    }
+#endif
+    vec->count = 0;
+}
+
+// Frees the segments that hold no elements.
+void TDS_FUNCTION(reclaim)(TDS_TYPE* vec) {
+    size_t used = 0;
+    while (TDS_FUNCTION(_capacity_of)(used) < (size_t)vec->count) {
+        used++;
+    }
+
+    for (size_t segment = used; segment < TDS_SEGMENT_COUNT && vec->segments[segment]; segment++) {
+        tds_deallocate(
+            TDS_ALLOCATOR_OF(vec),
+            vec->segments[segment],
+            TDS_FUNCTION(_segment_size)(segment) * sizeof(TDS_VALUE_T),
+            TDS_ALIGNMENT);
+        vec->segments[segment] = NULL;
+    }
+
+    const size_t total = TDS_FUNCTION(_capacity_of)(used);
+    vec->capacity = total > (size_t)TDS_MAX_VALUE(TDS_SIZE_T) ? TDS_MAX_VALUE(TDS_SIZE_T) : (TDS_SIZE_T)total;
+}
+
+void TDS_FUNCTION(fini)(TDS_TYPE* vec) {
+    TDS_FUNCTION(clear)(vec);
+    TDS_FUNCTION(reclaim)(vec);
+    TDS_RESET(vec);
+}
+#endif
+
+#include "private/end.inc"
+
+#undef TDS_SEGMENT_SHIFT
+#undef TDS_SEGMENT_COUNT
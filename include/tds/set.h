@@ -5,6 +5,14 @@
 #define TDS_TYPE TDS_DEFAULT_TYPE_W_VALUE(set)
 #endif
 
+#ifndef TDS_ALIGNMENT
+#define TDS_ALIGNMENT TDS_CACHE_LINE_SIZE
+#endif
+
+#if defined(TDS_INLINE_CAPACITY) && TDS_INLINE_CAPACITY < 1
+#error "TDS_INLINE_CAPACITY must be at least 1."
+#endif
+
 #define TDS_ENTRY_T TDS_JOIN2(TDS_TYPE, _entry)
 
 #ifdef TDS_DECLARE
@@ -16,9 +24,15 @@ typedef struct TDS_ENTRY_T {
 } TDS_ENTRY_T;
 
 typedef struct TDS_TYPE {
-    TDS_ENTRY_T* buckets;
+    TDS_ENTRY_T* buckets; // NULL while the values live in `inline_values`.
     TDS_SIZE_T count;
     TDS_SIZE_T capacity; // Always a prime number.
+#ifdef TDS_INLINE_CAPACITY
+    TDS_VALUE_T inline_values[TDS_INLINE_CAPACITY];
+#endif
+#ifdef TDS_ALLOCATOR
+    const tds_allocator_t* allocator;
+#endif
 } TDS_TYPE;
 
 int TDS_FUNCTION(contains)(const TDS_TYPE* set, TDS_VALUE_T value);
@@ -26,6 +40,13 @@ void TDS_FUNCTION(reserve)(TDS_TYPE* set, TDS_SIZE_T capacity);
 int TDS_FUNCTION(add)(TDS_TYPE* set, TDS_VALUE_T value);
 int TDS_FUNCTION(remove)(TDS_TYPE* set, TDS_VALUE_T value);
 TDS_SIZE_T TDS_FUNCTION(count)(const TDS_TYPE* set);
+#ifndef TDS_VALUE_FINI
+void TDS_FUNCTION(union_into)(TDS_TYPE* dst, const TDS_TYPE* a, const TDS_TYPE* b);
+void TDS_FUNCTION(intersect_into)(TDS_TYPE* dst, const TDS_TYPE* a, const TDS_TYPE* b);
+void TDS_FUNCTION(difference_into)(TDS_TYPE* dst, const TDS_TYPE* a, const TDS_TYPE* b);
+#endif
+TDS_SIZE_T TDS_FUNCTION(intersection_count)(const TDS_TYPE* a, const TDS_TYPE* b);
+int TDS_FUNCTION(is_subset)(const TDS_TYPE* a, const TDS_TYPE* b);
 void TDS_FUNCTION(clear)(TDS_TYPE* set);
 void TDS_FUNCTION(reclaim)(TDS_TYPE* set);
 void TDS_FUNCTION(fini)(TDS_TYPE* set);
@@ -70,85 +91,124 @@ static TDS_SIZE_T TDS_FUNCTION(prime_capacity)(TDS_SIZE_T capacity) {
     return TDS_MAX_VALUE(TDS_SIZE_T);
 }
 
+// Robin Hood insertion of an entry known not to be in `buckets` yet.
+static void TDS_FUNCTION(_place)(TDS_ENTRY_T* buckets, const TDS_SIZE_T capacity, TDS_ENTRY_T entry) {
+    entry.probe_sequence_length = 0;
+
+    TDS_SIZE_T index = entry.hash % capacity;
+    while (1) {
+        TDS_ENTRY_T* cur = buckets + index;
+        if (!cur->occupied) {
+            buckets[index] = entry;
+            return;
+        }
+
+        // Robin Hood: Swap if our probe distance is higher.
+        if (cur->probe_sequence_length < entry.probe_sequence_length) {
+            const TDS_ENTRY_T temp = *cur;
+            *cur = entry;
+            entry = temp;
+        }
+        index = (index + 1) % capacity;
+        entry.probe_sequence_length++;
+        TDS_ASSERT(entry.probe_sequence_length < capacity);
+    }
+}
+
 static void TDS_FUNCTION(rehash)(TDS_TYPE* set, const TDS_SIZE_T capacity) {
     TDS_ASSERT(set->count <= capacity);
 
-    TDS_ENTRY_T* new_buckets = TDS_CALLOC(capacity, sizeof(TDS_ENTRY_T));
+    TDS_ENTRY_T* new_buckets = tds_allocate(TDS_ALLOCATOR_OF(set), (size_t)capacity * sizeof(TDS_ENTRY_T), TDS_ALIGNMENT);
     if (set->buckets) {
         for (TDS_SIZE_T i = 0; i < set->capacity; i++) {
-            TDS_ENTRY_T entry = set->buckets[i];
-            if (!entry.occupied) {
-                continue;
-            }
-
-            entry.probe_sequence_length = 0;
-
-            // Insert entry.
-            TDS_SIZE_T index = entry.hash % capacity;
-            while (1) {
-                TDS_ENTRY_T* cur = new_buckets + index;
-                if (!cur->occupied) {
-                    new_buckets[index] = entry;
-                    break;
-                }
-
-                // Robin Hood: Swap if our probe distance is higher.
-                if (cur->probe_sequence_length < entry.probe_sequence_length) {
-                    const TDS_ENTRY_T temp = *cur;
-                    *cur = entry;
-                    entry = temp;
-                }
-                index = (index + 1) % capacity;
-                entry.probe_sequence_length++;
-                TDS_ASSERT(entry.probe_sequence_length < capacity);
+            if (set->buckets[i].occupied) {
+                TDS_FUNCTION(_place)(new_buckets, capacity, set->buckets[i]);
             }
         }
     }
+#ifdef TDS_INLINE_CAPACITY
+    else {
+        // Spilling out of the inline storage, whose values were never hashed.
+        for (TDS_SIZE_T i = 0; i < set->count; i++) {
+            const TDS_VALUE_T value = set->inline_values[i];
+            TDS_FUNCTION(_place)(new_buckets, capacity, (TDS_ENTRY_T){
+                .hash = rapidhash(&value, sizeof(value)),
+                .value = value,
+                .occupied = 1,
+            });
+        }
+    }
+#endif
 
-    TDS_FREE(set->buckets);
+    tds_deallocate(TDS_ALLOCATOR_OF(set), set->buckets, (size_t)set->capacity * sizeof(TDS_ENTRY_T), TDS_ALIGNMENT);
     set->buckets = new_buckets;
     set->capacity = capacity;
 }
 
-int TDS_FUNCTION(contains)(const TDS_TYPE* set, const TDS_VALUE_T value) {
+#ifdef TDS_INLINE_CAPACITY
+// Returns the index of `value` in the inline storage, or `set->count` if it isn't there.
+static TDS_SIZE_T TDS_FUNCTION(_inline_find)(const TDS_TYPE* set, const TDS_VALUE_T value) {
+    // No early exit, so compilers can turn this into a vectorized compare.
+    TDS_SIZE_T index = set->count;
+    for (TDS_SIZE_T i = 0; i < set->count; i++) {
+        index = set->inline_values[i] == value ? i : index;
+    }
+
+    return index;
+}
+#endif
+
+// Returns a pointer to the stored copy of `value`, or NULL. `hash` is ignored while the set uses its inline storage.
+static TDS_VALUE_T* TDS_FUNCTION(_find)(const TDS_TYPE* set, const TDS_VALUE_T value, const uint64_t hash) {
     if (!set->buckets) {
-        return 0;
+#ifdef TDS_INLINE_CAPACITY
+        const TDS_SIZE_T index = TDS_FUNCTION(_inline_find)(set, value);
+        return index < set->count ? (TDS_VALUE_T*)set->inline_values + index : NULL;
+#else
+        return NULL;
+#endif
     }
-    
-    const uint64_t hash = rapidhash(&value, sizeof(value));
+
     TDS_SIZE_T index = hash % set->capacity;
     // The "for" instead of a "while" loop is just to guard against infinite loops.
     for (TDS_SIZE_T i = 0; i < set->capacity; i++) {
         TDS_ENTRY_T* cur = set->buckets + index;
-    
+
         if (!cur->occupied) {
             // Value not found.
-            return 0;
+            return NULL;
         }
-    
+
         if (cur->hash == hash && cur->value == value) {
             // Value found.
-            return 1;
+            return &cur->value;
         }
-    
+
         index = (index + 1) % set->capacity;
     }
-    
+
     TDS_ASSERT(0);
-    return 0;
+    return NULL;
 }
 
-void TDS_FUNCTION(reserve)(TDS_TYPE* set, const TDS_SIZE_T capacity) {
-    TDS_ASSERT(set->count <= set->capacity);
+// `hash` is ignored while the value fits in the inline storage.
+static int TDS_FUNCTION(_add)(TDS_TYPE* set, const TDS_VALUE_T value, const uint64_t hash) {
+#ifdef TDS_INLINE_CAPACITY
+    if (!set->buckets) {
+        if (TDS_FUNCTION(_inline_find)(set, value) < set->count) {
+            return 0;
+        }
 
-    if (capacity <= set->capacity) {
-        return;
-    }
+        if (set->count < TDS_INLINE_CAPACITY) {
+            set->inline_values[set->count++] = value;
+            return 1;
+        }
 
-    TDS_FUNCTION(rehash)(set, TDS_FUNCTION(prime_capacity)(capacity));
-}
+        // Out of inline room, spill into the hash table.
+        TDS_FUNCTION(reserve)(set, TDS_FUNCTION(usable_capacity)(set->count * 2));
+    }
+#endif
 
-int TDS_FUNCTION(add)(TDS_TYPE* set, const TDS_VALUE_T value) {
     // Ensure the set has room for at least one more entry.
     // Check load factor > 0.75 by using integer math instead of floating-point math.
     // TODO: Use floating point math instead, for cases where we're approaching TDS_SIZE_T limits.
@@ -167,7 +227,7 @@ int TDS_FUNCTION(add)(TDS_TYPE* set, const TDS_VALUE_T value) {
 
     // Do the insertion.
     TDS_ENTRY_T new_entry = {
-        .hash = rapidhash(&value, sizeof(value)),
+        .hash = hash,
         .probe_sequence_length = 0,
         .value = value,
         .occupied = 1,
@@ -201,58 +261,266 @@ int TDS_FUNCTION(add)(TDS_TYPE* set, const TDS_VALUE_T value) {
     }
 }
 
-int TDS_FUNCTION(remove)(TDS_TYPE* set, const TDS_VALUE_T value) {
+// Removes a value found by `_find` without finalizing it.
+static void TDS_FUNCTION(_erase)(TDS_TYPE* set, TDS_VALUE_T* stored) {
+#ifdef TDS_INLINE_CAPACITY
+    if (!set->buckets) {
+        // Move the last value into the gap.
+        *stored = set->inline_values[--set->count];
+        return;
+    }
+#endif
+
+    TDS_SIZE_T index = (TDS_SIZE_T)(((char*)stored - (char*)set->buckets) / sizeof(TDS_ENTRY_T));
+    set->buckets[index].occupied = 0;
+    set->count--;
+
+    // Now, shift down the chain to maintain the probe sequence.
+    TDS_SIZE_T next_index = (index + 1) % set->capacity;
+    while (set->buckets[next_index].occupied) {
+        TDS_ENTRY_T* next_entry = set->buckets + next_index;
+
+        // If the next entry is where it should be, stop shifting.
+        if (next_entry->probe_sequence_length == 0) {
+            break;
+        }
+
+        // Move the entry to the previous slot, filling the gap.
+        set->buckets[index] = *next_entry;
+        set->buckets[index].probe_sequence_length--;
+        next_entry->occupied = 0;
+
+        // Update the indices for the next step in the probe chain.
+        index = next_index;
+        next_index = (index + 1) % set->capacity;
+    }
+}
+
+// Hashes `value` for a lookup in `set`. Values in the inline storage are found without hashing.
+static uint64_t TDS_FUNCTION(_hash)(const TDS_TYPE* set, const TDS_VALUE_T value) {
+#ifdef TDS_INLINE_CAPACITY
     if (!set->buckets) {
         return 0;
     }
+#endif
+    (void)set;
+    return rapidhash(&value, sizeof(value));
+}
 
-    const uint64_t hash = rapidhash(&value, sizeof(value));
-    TDS_SIZE_T index = hash % set->capacity;
-    for (TDS_SIZE_T i = 0; i < set->capacity; i++) {
-        TDS_ENTRY_T* cur = set->buckets + index;
+// Copies up to TDS_PROBE_BATCH entries of `set`, starting from position `*index`, and prefetches the buckets where they
+// would live in `other`, so that the probes that follow overlap their cache misses. Returns the number of copied
+// entries, zero once `set` is exhausted.
+static unsigned TDS_FUNCTION(_next_batch)(
+    const TDS_TYPE* set,
+    TDS_SIZE_T* index,
+    const TDS_TYPE* other,
+    TDS_ENTRY_T* batch
+) {
+    unsigned count = 0;
+#ifdef TDS_INLINE_CAPACITY
+    if (!set->buckets) {
+        // The batch may end up in a hash table, so inline values get hashed here.
+        while (count < TDS_PROBE_BATCH && *index < set->count) {
+            const TDS_VALUE_T value = set->inline_values[(*index)++];
+            batch[count++] = (TDS_ENTRY_T){
+                .hash = rapidhash(&value, sizeof(value)),
+                .value = value,
+                .occupied = 1,
+            };
+        }
+    }
+#endif
+    while (count < TDS_PROBE_BATCH && *index < set->capacity) {
+        const TDS_ENTRY_T* entry = set->buckets + (*index)++;
+        if (entry->occupied) {
+            batch[count++] = *entry;
+        }
+    }
 
-        if (!cur->occupied) {
-            // Value not found.
-            return 0;
+    if (other->buckets) {
+        for (unsigned i = 0; i < count; i++) {
+            TDS_PREFETCH(other->buckets + batch[i].hash % other->capacity);
         }
+    }
 
-        if (cur->hash == hash && cur->value == value) {
-            // Value found, delete it (if applicable) and remove it by marking as unoccupied.
+    return count;
+}
+
+int TDS_FUNCTION(contains)(const TDS_TYPE* set, const TDS_VALUE_T value) {
+    return TDS_FUNCTION(_find)(set, value, TDS_FUNCTION(_hash)(set, value)) != NULL;
+}
+
+void TDS_FUNCTION(reserve)(TDS_TYPE* set, const TDS_SIZE_T capacity) {
+    TDS_ASSERT(!set->buckets || set->count <= set->capacity);
+
+#ifdef TDS_INLINE_CAPACITY
+    if (!set->buckets && capacity <= TDS_INLINE_CAPACITY) {
+        return;
+    }
+#endif
+    if (capacity <= set->capacity) {
+        return;
+    }
+
+    TDS_FUNCTION(rehash)(set, TDS_FUNCTION(prime_capacity)(capacity));
+}
+
+int TDS_FUNCTION(add)(TDS_TYPE* set, const TDS_VALUE_T value) {
+#ifdef TDS_INLINE_CAPACITY
+    if (!set->buckets && set->count < TDS_INLINE_CAPACITY) {
+        // There's inline room left, so the value won't need a hash.
+        return TDS_FUNCTION(_add)(set, value, 0);
+    }
+#endif
+    return TDS_FUNCTION(_add)(set, value, rapidhash(&value, sizeof(value)));
+}
+
+int TDS_FUNCTION(remove)(TDS_TYPE* set, const TDS_VALUE_T value) {
+    TDS_VALUE_T* stored = TDS_FUNCTION(_find)(set, value, TDS_FUNCTION(_hash)(set, value));
+    if (!stored) {
+        return 0;
+    }
+
+    // Value found, delete it (if applicable) and remove it.
 #ifdef TDS_VALUE_FINI
-            TDS_VALUE_FINI((cur->value));
+    TDS_VALUE_FINI((*stored));
 #endif
-            cur->occupied = 0;
-            set->count--;
+    TDS_FUNCTION(_erase)(set, stored);
+    return 1;
+}
 
-            // Now, shift down the chain to maintain the probe sequence.
-            TDS_SIZE_T next_index = (index + 1) % set->capacity;
-            while (set->buckets[next_index].occupied) {
-                TDS_ENTRY_T* next_entry = set->buckets + next_index;
+// The operations that build a set copy values shallowly into `dst`, which would then finalize values its operands still
+// own, so they are only generated for plain values.
+#ifndef TDS_VALUE_FINI
+static void TDS_FUNCTION(_add_all)(TDS_TYPE* dst, const TDS_TYPE* src) {
+    TDS_ENTRY_T batch[TDS_PROBE_BATCH];
+    TDS_SIZE_T index = 0;
+    unsigned count;
+    while ((count = TDS_FUNCTION(_next_batch)(src, &index, dst, batch))) {
+        for (unsigned i = 0; i < count; i++) {
+            TDS_FUNCTION(_add)(dst, batch[i].value, batch[i].hash);
+        }
+    }
+}
 
-                // If the next entry is where it should be, stop shifting.
-                if (next_entry->probe_sequence_length == 0) {
-                    break;
-                }
+// Makes room for `count` values, without leaving the inline storage while they would still fit in it.
+static void TDS_FUNCTION(_reserve_count)(TDS_TYPE* set, const TDS_SIZE_T count) {
+#ifdef TDS_INLINE_CAPACITY
+    if (!set->buckets && count <= TDS_INLINE_CAPACITY) {
+        return;
+    }
+#endif
+    TDS_FUNCTION(reserve)(set, TDS_FUNCTION(usable_capacity)(count));
+}
+
+void TDS_FUNCTION(union_into)(TDS_TYPE* dst, const TDS_TYPE* a, const TDS_TYPE* b) {
+    if (dst == a || dst == b) {
+        const TDS_TYPE* other = dst == a ? b : a;
+        if (other == dst) {
+            return;
+        }
 
-                // Move the entry to the previous slot, filling the gap.
-                set->buckets[index] = *next_entry;
-                set->buckets[index].probe_sequence_length--;
-                next_entry->occupied = 0;
+        TDS_FUNCTION(_reserve_count)(dst, dst->count + other->count);
+        TDS_FUNCTION(_add_all)(dst, other);
+        return;
+    }
 
-                // Update the indices for the next step in the probe chain.
-                index = next_index;
-                next_index = (index + 1) % set->capacity;
+    // Copy the larger set with its stored hashes, then probe with the smaller one.
+    const TDS_TYPE* large = a->count >= b->count ? a : b;
+    const TDS_TYPE* small = large == a ? b : a;
+    TDS_FUNCTION(clear)(dst);
+    TDS_FUNCTION(_reserve_count)(dst, a->count + b->count);
+    TDS_FUNCTION(_add_all)(dst, large);
+    TDS_FUNCTION(_add_all)(dst, small);
+}
+
+void TDS_FUNCTION(intersect_into)(TDS_TYPE* dst, const TDS_TYPE* a, const TDS_TYPE* b) {
+    TDS_ASSERT(dst != a && dst != b);
+
+    const TDS_TYPE* large = a->count >= b->count ? a : b;
+    const TDS_TYPE* small = large == a ? b : a;
+    TDS_FUNCTION(clear)(dst);
+
+    TDS_ENTRY_T batch[TDS_PROBE_BATCH];
+    TDS_SIZE_T index = 0;
+    unsigned count;
+    while ((count = TDS_FUNCTION(_next_batch)(small, &index, large, batch))) {
+        for (unsigned i = 0; i < count; i++) {
+            if (TDS_FUNCTION(_find)(large, batch[i].value, batch[i].hash)) {
+                TDS_FUNCTION(_add)(dst, batch[i].value, batch[i].hash);
             }
+        }
+    }
+}
 
-            return 1;
+void TDS_FUNCTION(difference_into)(TDS_TYPE* dst, const TDS_TYPE* a, const TDS_TYPE* b) {
+    TDS_ASSERT(dst != a && dst != b);
+
+    TDS_FUNCTION(clear)(dst);
+
+    TDS_ENTRY_T batch[TDS_PROBE_BATCH];
+    TDS_SIZE_T index = 0;
+    unsigned count;
+    if (b->count < a->count) {
+        // Cheaper to copy `a` and probe with the smaller `b`.
+        TDS_FUNCTION(_reserve_count)(dst, a->count);
+        TDS_FUNCTION(_add_all)(dst, a);
+
+        while ((count = TDS_FUNCTION(_next_batch)(b, &index, dst, batch))) {
+            for (unsigned i = 0; i < count; i++) {
+                TDS_VALUE_T* stored = TDS_FUNCTION(_find)(dst, batch[i].value, batch[i].hash);
+                if (stored) {
+                    TDS_FUNCTION(_erase)(dst, stored);
+                }
+            }
         }
+        return;
+    }
 
-        index = (index + 1) % set->capacity;
+    while ((count = TDS_FUNCTION(_next_batch)(a, &index, b, batch))) {
+        for (unsigned i = 0; i < count; i++) {
+            if (!TDS_FUNCTION(_find)(b, batch[i].value, batch[i].hash)) {
+                TDS_FUNCTION(_add)(dst, batch[i].value, batch[i].hash);
+            }
+        }
     }
+}
+#endif
 
-    // This should be unreachable.
-    TDS_ASSERT(0);
-    return 0;
+TDS_SIZE_T TDS_FUNCTION(intersection_count)(const TDS_TYPE* a, const TDS_TYPE* b) {
+    const TDS_TYPE* large = a->count >= b->count ? a : b;
+    const TDS_TYPE* small = large == a ? b : a;
+
+    TDS_SIZE_T result = 0;
+    TDS_ENTRY_T batch[TDS_PROBE_BATCH];
+    TDS_SIZE_T index = 0;
+    unsigned count;
+    while ((count = TDS_FUNCTION(_next_batch)(small, &index, large, batch))) {
+        for (unsigned i = 0; i < count; i++) {
+            result += TDS_FUNCTION(_find)(large, batch[i].value, batch[i].hash) != NULL;
+        }
+    }
+
+    return result;
+}
+
+int TDS_FUNCTION(is_subset)(const TDS_TYPE* a, const TDS_TYPE* b) {
+    if (a->count > b->count) {
+        return 0;
+    }
+
+    TDS_ENTRY_T batch[TDS_PROBE_BATCH];
+    TDS_SIZE_T index = 0;
+    unsigned count;
+    while ((count = TDS_FUNCTION(_next_batch)(a, &index, b, batch))) {
+        for (unsigned i = 0; i < count; i++) {
+            if (!TDS_FUNCTION(_find)(b, batch[i].value, batch[i].hash)) {
+                return 0;
+            }
+        }
+    }
+
+    return 1;
 }
 
 TDS_SIZE_T TDS_FUNCTION(count)(const TDS_TYPE* set) {
@@ -261,6 +529,11 @@ TDS_SIZE_T TDS_FUNCTION(count)(const TDS_TYPE* set) {
 
 void TDS_FUNCTION(clear)(TDS_TYPE* set) {
 #if defined(TDS_VALUE_FINI)
+#ifdef TDS_INLINE_CAPACITY
+    for (TDS_SIZE_T i = 0; !set->buckets && i < set->count; i++) {
+        TDS_VALUE_FINI((set->inline_values[i]));
+    }
+#endif
     for (TDS_SIZE_T i = 0; i < set->capacity; i++) {
         TDS_ENTRY_T* entry = set->buckets + i;
         if (entry->occupied) {
@@ -275,14 +548,37 @@ void TDS_FUNCTION(clear)(TDS_TYPE* set) {
 }
 
 void TDS_FUNCTION(reclaim)(TDS_TYPE* set) {
+#ifdef TDS_INLINE_CAPACITY
+    if (!set->buckets) {
+        // The inline storage can't shrink.
+        return;
+    }
+#endif
     TDS_ASSERT(set->count <= set->capacity);
 
     if (set->count == 0) {
-        TDS_FREE(set->buckets);
-        *set = (TDS_TYPE){ 0 };
+        tds_deallocate(TDS_ALLOCATOR_OF(set), set->buckets, (size_t)set->capacity * sizeof(TDS_ENTRY_T), TDS_ALIGNMENT);
+        TDS_RESET(set);
         return;
     }
 
+#ifdef TDS_INLINE_CAPACITY
+    if (set->count <= TDS_INLINE_CAPACITY) {
+        // Move back into the inline storage.
+        set->count = 0;
+        for (TDS_SIZE_T i = 0; i < set->capacity; i++) {
+            if (set->buckets[i].occupied) {
+                set->inline_values[set->count++] = set->buckets[i].value;
+            }
+        }
+
+        tds_deallocate(TDS_ALLOCATOR_OF(set), set->buckets, (size_t)set->capacity * sizeof(TDS_ENTRY_T), TDS_ALIGNMENT);
+        set->buckets = NULL;
+        set->capacity = 0;
+        return;
+    }
+#endif
+
     const TDS_SIZE_T capacity = TDS_FUNCTION(prime_capacity)(TDS_FUNCTION(usable_capacity)(set->count));
     if (capacity == set->capacity) {
         return;
@@ -293,6 +589,11 @@ void TDS_FUNCTION(reclaim)(TDS_TYPE* set) {
 
 void TDS_FUNCTION(fini)(TDS_TYPE* set) {
 #if defined(TDS_VALUE_FINI)
+#ifdef TDS_INLINE_CAPACITY
+    for (TDS_SIZE_T i = 0; !set->buckets && i < set->count; i++) {
+        TDS_VALUE_FINI((set->inline_values[i]));
+    }
+#endif
     for (TDS_SIZE_T i = 0; i < set->capacity; i++) {
         TDS_ENTRY_T* entry = set->buckets + i;
         if (entry->occupied) {
@@ -300,8 +601,8 @@ void TDS_FUNCTION(fini)(TDS_TYPE* set) {
         }
     }
 #endif
-    TDS_FREE(set->buckets);
-    *set = (TDS_TYPE){ 0 };
+    tds_deallocate(TDS_ALLOCATOR_OF(set), set->buckets, (size_t)set->capacity * sizeof(TDS_ENTRY_T), TDS_ALIGNMENT);
+    TDS_RESET(set);
 }
 #endif
 
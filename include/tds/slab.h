@@ -0,0 +1,266 @@
+#pragma once
+#ifndef _TDS_SLAB_H_
+#define _TDS_SLAB_H_
+
+// A thread-caching size-class allocator meant to back TDS_CALLOC, TDS_REALLOC and TDS_FREE. This header deliberately
+// doesn't include "private/common.h", so it can be included before those macros are defined.
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "private/atomic.h"
+
+// Usable sizes of the size classes are the powers of two from 1 << TDS_SLAB_MIN_SHIFT to 1 << TDS_SLAB_MAX_SHIFT.
+// Bigger allocations go straight to the system allocator.
+#ifndef TDS_SLAB_MIN_SHIFT
+#define TDS_SLAB_MIN_SHIFT 4
+#endif
+
+#ifndef TDS_SLAB_MAX_SHIFT
+#define TDS_SLAB_MAX_SHIFT 15
+#endif
+
+// Number of blocks moved at once between a thread cache and the central depot.
+#ifndef TDS_SLAB_BATCH
+#define TDS_SLAB_BATCH 32
+#endif
+
+// Bytes requested from the system allocator whenever a size class runs dry. Spans are never returned to the system.
+#ifndef TDS_SLAB_SPAN_SIZE
+#define TDS_SLAB_SPAN_SIZE ((size_t)256 << 10)
+#endif
+
+// A free block holds two links, to the next block and to the next depot batch, so the smallest class needs room for
+// two pointers.
+#if TDS_SLAB_MIN_SHIFT < 4 || TDS_SLAB_MIN_SHIFT > TDS_SLAB_MAX_SHIFT
+#error "TDS_SLAB_MIN_SHIFT must be at least 4 and not greater than TDS_SLAB_MAX_SHIFT."
+#endif
+
+#define TDS_SLAB_CLASS_COUNT (TDS_SLAB_MAX_SHIFT - TDS_SLAB_MIN_SHIFT + 1)
+#define TDS_SLAB_LARGE ((size_t)-1)
+
+// Every block is preceded by this header. While a block sits in a free list, the first word of its user area links
+// to the next free block, and the first block of a depot batch also links to the next batch with its second word.
+typedef struct tds_slab_header_t {
+    size_t size_class; // TDS_SLAB_LARGE for allocations served by the system allocator.
+    size_t extra; // Usable size of large allocations, number of blocks in a depot batch.
+} tds_slab_header_t;
+
+typedef struct tds_slab_cache_t {
+    void* blocks[TDS_SLAB_CLASS_COUNT];
+    size_t counts[TDS_SLAB_CLASS_COUNT];
+} tds_slab_cache_t;
+
+typedef struct tds_slab_depot_t {
+    tds_spinlock_t locks[TDS_SLAB_CLASS_COUNT];
+    void* batches[TDS_SLAB_CLASS_COUNT];
+} tds_slab_depot_t;
+
+static TDS_THREAD_LOCAL tds_slab_cache_t tds_slab_cache;
+static tds_slab_depot_t tds_slab_depot;
+
+static inline tds_slab_header_t* tds_slab_header(void* pointer) {
+    return (tds_slab_header_t*)pointer - 1;
+}
+
+static inline void* tds_slab_next(void* block) {
+    void* next;
+    memcpy(&next, block, sizeof(next));
+    return next;
+}
+
+static inline void tds_slab_set_next(void* block, void* next) {
+    memcpy(block, &next, sizeof(next));
+}
+
+static inline void* tds_slab_next_batch(void* block) {
+    void* next;
+    memcpy(&next, (char*)block + sizeof(void*), sizeof(next));
+    return next;
+}
+
+static inline void tds_slab_set_next_batch(void* block, void* next) {
+    memcpy((char*)block + sizeof(void*), &next, sizeof(next));
+}
+
+static inline size_t tds_slab_size_class(const size_t size) {
+    size_t size_class = 0;
+    while (((size_t)1 << (size_class + TDS_SLAB_MIN_SHIFT)) < size) {
+        size_class++;
+    }
+    return size_class;
+}
+
+static inline void tds_slab_push_batch(const size_t size_class, void* batch, const size_t count) {
+    tds_slab_header(batch)->extra = count;
+    tds_spinlock_lock(tds_slab_depot.locks + size_class);
+    tds_slab_set_next_batch(batch, tds_slab_depot.batches[size_class]);
+    tds_slab_depot.batches[size_class] = batch;
+    tds_spinlock_unlock(tds_slab_depot.locks + size_class);
+}
+
+// Gives the thread cache a batch of `size_class` blocks. Returns 0 if the depot is empty and no new span can be allocated.
+static inline char tds_slab_refill(tds_slab_cache_t* cache, const size_t size_class) {
+    tds_spinlock_lock(tds_slab_depot.locks + size_class);
+    void* batch = tds_slab_depot.batches[size_class];
+    if (batch) {
+        tds_slab_depot.batches[size_class] = tds_slab_next_batch(batch);
+    }
+    tds_spinlock_unlock(tds_slab_depot.locks + size_class);
+
+    if (batch) {
+        cache->blocks[size_class] = batch;
+        cache->counts[size_class] = tds_slab_header(batch)->extra;
+        return 1;
+    }
+
+    // Carve a new span into batches. The first one goes to this thread, the rest to the depot.
+    const size_t stride = sizeof(tds_slab_header_t) + ((size_t)1 << (size_class + TDS_SLAB_MIN_SHIFT));
+    size_t batch_count = TDS_SLAB_SPAN_SIZE / stride / TDS_SLAB_BATCH;
+    if (batch_count == 0) {
+        batch_count = 1;
+    }
+
+    char* span = malloc(batch_count * TDS_SLAB_BATCH * stride);
+    if (!span) {
+        return 0;
+    }
+
+    for (size_t i = batch_count; i-- > 0;) {
+        char* first = span + i * TDS_SLAB_BATCH * stride;
+        void* head = NULL;
+        for (size_t j = TDS_SLAB_BATCH; j-- > 0;) {
+            tds_slab_header_t* header = (tds_slab_header_t*)(first + j * stride);
+            header->size_class = size_class;
+            tds_slab_set_next(header + 1, head);
+            head = header + 1;
+        }
+
+        if (i == 0) {
+            cache->blocks[size_class] = head;
+            cache->counts[size_class] = TDS_SLAB_BATCH;
+        } else {
+            tds_slab_push_batch(size_class, head, TDS_SLAB_BATCH);
+        }
+    }
+    return 1;
+}
+
+static inline void* tds_slab_malloc(const size_t size) {
+    if (size > ((size_t)1 << TDS_SLAB_MAX_SHIFT)) {
+        tds_slab_header_t* header = malloc(sizeof(tds_slab_header_t) + size);
+        if (!header) {
+            return NULL;
+        }
+        header->size_class = TDS_SLAB_LARGE;
+        header->extra = size;
+        return header + 1;
+    }
+
+    const size_t size_class = tds_slab_size_class(size);
+    tds_slab_cache_t* cache = &tds_slab_cache;
+    if (!cache->blocks[size_class] && !tds_slab_refill(cache, size_class)) {
+        return NULL;
+    }
+
+    void* block = cache->blocks[size_class];
+    cache->blocks[size_class] = tds_slab_next(block);
+    cache->counts[size_class]--;
+    return block;
+}
+
+static inline void tds_slab_free(void* pointer) {
+    if (!pointer) {
+        return;
+    }
+
+    tds_slab_header_t* header = tds_slab_header(pointer);
+    if (header->size_class == TDS_SLAB_LARGE) {
+        free(header);
+        return;
+    }
+
+    const size_t size_class = header->size_class;
+    tds_slab_cache_t* cache = &tds_slab_cache;
+    tds_slab_set_next(pointer, cache->blocks[size_class]);
+    cache->blocks[size_class] = pointer;
+    cache->counts[size_class]++;
+
+    if (cache->counts[size_class] >= 2 * TDS_SLAB_BATCH) {
+        // Keep the most recently freed blocks, which are likely still in cache, and hand the rest to the depot.
+        void* last = pointer;
+        for (size_t i = 1; i < TDS_SLAB_BATCH; i++) {
+            last = tds_slab_next(last);
+        }
+        void* batch = tds_slab_next(last);
+        tds_slab_set_next(last, NULL);
+        tds_slab_push_batch(size_class, batch, cache->counts[size_class] - TDS_SLAB_BATCH);
+        cache->counts[size_class] = TDS_SLAB_BATCH;
+    }
+}
+
+static inline void* tds_slab_calloc(const size_t count, const size_t size) {
+    if (size && count > (size_t)-1 / size) {
+        return NULL;
+    }
+
+    void* pointer = tds_slab_malloc(count * size);
+    if (pointer) {
+        memset(pointer, 0, count * size);
+    }
+    return pointer;
+}
+
+static inline void* tds_slab_realloc(void* pointer, const size_t size) {
+    if (!pointer) {
+        return tds_slab_malloc(size);
+    }
+
+    if (size == 0) {
+        tds_slab_free(pointer);
+        return NULL;
+    }
+
+    tds_slab_header_t* header = tds_slab_header(pointer);
+    size_t capacity;
+    if (header->size_class == TDS_SLAB_LARGE) {
+        if (size > ((size_t)1 << TDS_SLAB_MAX_SHIFT)) {
+            header = realloc(header, sizeof(tds_slab_header_t) + size);
+            if (!header) {
+                return NULL;
+            }
+            header->extra = size;
+            return header + 1;
+        }
+        capacity = header->extra;
+    } else {
+        capacity = (size_t)1 << (header->size_class + TDS_SLAB_MIN_SHIFT);
+        // Stay in place while the new size still belongs to the same size class.
+        if (size <= capacity && (size > capacity / 2 || header->size_class == 0)) {
+            return pointer;
+        }
+    }
+
+    void* new_pointer = tds_slab_malloc(size);
+    if (new_pointer) {
+        memcpy(new_pointer, pointer, size < capacity ? size : capacity);
+        tds_slab_free(pointer);
+    }
+    return new_pointer;
+}
+
+// Returns every block cached by the calling thread to the central depot. Call it before a thread exits, otherwise its
+// cached blocks can't be reused by other threads.
+static inline void tds_slab_thread_flush(void) {
+    tds_slab_cache_t* cache = &tds_slab_cache;
+    for (size_t size_class = 0; size_class < TDS_SLAB_CLASS_COUNT; size_class++) {
+        if (cache->blocks[size_class]) {
+            tds_slab_push_batch(size_class, cache->blocks[size_class], cache->counts[size_class]);
+            cache->blocks[size_class] = NULL;
+            cache->counts[size_class] = 0;
+        }
+    }
+}
+#endif
@@ -0,0 +1,171 @@
+#include "private/common.h"
+#include "private/begin.inc"
+
+// A vector that stores its first TDS_INLINE_CAPACITY elements inside its own struct and only allocates once it holds
+// more than that. It has the same API as vector.h. `array` is NULL while the inline storage is in use, so the struct
+// can be copied or moved freely.
+
+#ifndef TDS_TYPE
+#define TDS_TYPE TDS_DEFAULT_TYPE_W_VALUE(small_vec)
+#endif
+
+#ifndef TDS_ALIGNMENT
+#define TDS_ALIGNMENT 0
+#endif
+
+#ifndef TDS_INLINE_CAPACITY
+#define TDS_INLINE_CAPACITY 8
+#endif
+
+#if TDS_INLINE_CAPACITY < 1
+#error "TDS_INLINE_CAPACITY must be at least 1."
+#endif
+
+#ifdef TDS_DECLARE
+typedef struct TDS_TYPE {
+    TDS_VALUE_T* array;
+    TDS_SIZE_T count;
+    TDS_SIZE_T capacity; // Capacity of `array`, zero while the inline storage is in use.
+    TDS_VALUE_T inline_array[TDS_INLINE_CAPACITY];
+#ifdef TDS_ALLOCATOR
+    const tds_allocator_t* allocator;
+#endif
+} TDS_TYPE;
+
+void TDS_FUNCTION(append)(TDS_TYPE* vec, TDS_VALUE_T value);
+void TDS_FUNCTION(reserve)(TDS_TYPE* vec, TDS_SIZE_T capacity);
+TDS_VALUE_T* TDS_FUNCTION(grow)(TDS_TYPE* vec, TDS_SIZE_T count);
+void TDS_FUNCTION(remove)(TDS_TYPE* vec, TDS_SIZE_T index);
+TDS_VALUE_T TDS_FUNCTION(get)(const TDS_TYPE* vec, TDS_SIZE_T index);
+TDS_SIZE_T TDS_FUNCTION(count)(const TDS_TYPE* vec);
+TDS_VALUE_T* TDS_FUNCTION(first)(const TDS_TYPE* vec);
+void TDS_FUNCTION(clear)(TDS_TYPE* vec);
+void TDS_FUNCTION(reclaim)(TDS_TYPE* vec);
+void TDS_FUNCTION(fini)(TDS_TYPE* vec);
+#endif
+
+#ifdef TDS_IMPLEMENT
+static TDS_SIZE_T TDS_FUNCTION(_capacity)(const TDS_TYPE* vec) {
+    return vec->array ? vec->capacity : (TDS_SIZE_T)TDS_INLINE_CAPACITY;
+}
+
+void TDS_FUNCTION(append)(TDS_TYPE* vec, const TDS_VALUE_T value) {
+    TDS_VALUE_T* slot = TDS_FUNCTION(grow)(vec, 1);
+    *slot = value;
+}
+
+// Reserves exactly `capacity` elements, without rounding up. Capacities that fit inline don't allocate.
+void TDS_FUNCTION(reserve)(TDS_TYPE* vec, const TDS_SIZE_T capacity) {
+    TDS_ASSERT(vec->count <= TDS_FUNCTION(_capacity)(vec));
+
+    if (capacity <= TDS_FUNCTION(_capacity)(vec)) {
+        return;
+    }
+
+    if (vec->array) {
+        vec->array = tds_reallocate(
+            TDS_ALLOCATOR_OF(vec),
+            vec->array,
+            sizeof(TDS_VALUE_T) * vec->capacity,
+            sizeof(TDS_VALUE_T) * capacity,
+            TDS_ALIGNMENT);
+    } else {
+        // Spill the inline elements to the heap.
+        vec->array = tds_allocate(TDS_ALLOCATOR_OF(vec), sizeof(TDS_VALUE_T) * capacity, TDS_ALIGNMENT);
+        TDS_MEMCPY(vec->array, vec->inline_array, sizeof(TDS_VALUE_T) * vec->count);
+    }
+    vec->capacity = capacity;
+}
+
+TDS_VALUE_T* TDS_FUNCTION(grow)(TDS_TYPE* vec, const TDS_SIZE_T count) {
+    const TDS_SIZE_T old_count = vec->count;
+    const TDS_SIZE_T needed = old_count + count;
+    // Guard against overflow and negative counts.
+    TDS_ASSERT(needed >= old_count);
+
+    if (needed > TDS_FUNCTION(_capacity)(vec)) {
+        TDS_FUNCTION(reserve)(vec, TDS_GROWN_CAPACITY(TDS_FUNCTION(_capacity)(vec), needed));
+    }
+    vec->count = needed;
+
+    return TDS_FUNCTION(first)(vec) + old_count;
+}
+
+void TDS_FUNCTION(remove)(TDS_TYPE* vec, const TDS_SIZE_T index) {
+    TDS_ASSERT(index < vec->count);
+
+    TDS_VALUE_T* array = TDS_FUNCTION(first)(vec);
+#ifdef TDS_VALUE_FINI
+    TDS_VALUE_FINI(array[index]);
+#endif
+
+    if (index < vec->count - 1) {
+        // Shift elements to the left
+        TDS_MEMMOVE(&array[index], &array[index + 1], (size_t)(vec->count - index - 1) * sizeof(TDS_VALUE_T));
+    }
+    vec->count--;
+}
+
+TDS_VALUE_T TDS_FUNCTION(get)(const TDS_TYPE* vec, const TDS_SIZE_T index) {
+    TDS_ASSERT(index < vec->count);
+    return TDS_FUNCTION(first)(vec)[index];
+}
+
+TDS_SIZE_T TDS_FUNCTION(count)(const TDS_TYPE* vec) {
+    return vec->count;
+}
+
+TDS_VALUE_T* TDS_FUNCTION(first)(const TDS_TYPE* vec) {
+    return vec->array ? vec->array : (TDS_VALUE_T*)vec->inline_array;
+}
+
+void TDS_FUNCTION(clear)(TDS_TYPE* vec) {
+#ifdef TDS_VALUE_FINI
+    TDS_VALUE_T* array = TDS_FUNCTION(first)(vec);
+    for (TDS_SIZE_T i = 0; i < vec->count; i++) {
+        TDS_VALUE_FINI(array[i]);
+    }
+#endif
+    vec->count = 0;
+}
+
+// Shrinks the heap buffer to exactly `count` elements, or moves the elements back inline if they fit.
+void TDS_FUNCTION(reclaim)(TDS_TYPE* vec) {
+    TDS_ASSERT(vec->count <= TDS_FUNCTION(_capacity)(vec));
+
+    if (!vec->array || vec->count == vec->capacity) {
+        return;
+    }
+
+    if (vec->count <= TDS_INLINE_CAPACITY) {
+        TDS_VALUE_T* array = vec->array;
+        TDS_MEMCPY(vec->inline_array, array, sizeof(TDS_VALUE_T) * vec->count);
+        tds_deallocate(TDS_ALLOCATOR_OF(vec), array, sizeof(TDS_VALUE_T) * vec->capacity, TDS_ALIGNMENT);
+        vec->array = NULL;
+        vec->capacity = 0;
+        return;
+    }
+
+    vec->array = tds_reallocate(
+        TDS_ALLOCATOR_OF(vec),
+        vec->array,
+        sizeof(TDS_VALUE_T) * vec->capacity,
+        sizeof(TDS_VALUE_T) * vec->count,
+        TDS_ALIGNMENT);
+    vec->capacity = vec->count;
+}
+
+void TDS_FUNCTION(fini)(TDS_TYPE* vec) {
+#ifdef TDS_VALUE_FINI
+    TDS_VALUE_T* array = TDS_FUNCTION(first)(vec);
+    for (TDS_SIZE_T i = 0; i < vec->count; i++) {
+        TDS_VALUE_FINI(array[i]);
+    }
+#endif
+    tds_deallocate(TDS_ALLOCATOR_OF(vec), vec->array, sizeof(TDS_VALUE_T) * vec->capacity, TDS_ALIGNMENT);
+    TDS_RESET(vec);
+}
+#endif
+
+#include "private/end.inc"
+
@@ -0,0 +1,204 @@
+#include "private/common.h"
+#include "private/begin.inc"
+
+// A vector that stores each field of its elements in its own array, so loops over one field only load that field and
+// vectorize well. The fields are given as an X-macro, which is called with a macro that takes a type and a name:
+//
+//     #define TDS_TYPE particles
+//     #define TDS_FIELDS(X) X(float, x) X(float, y) X(uint32_t, id)
+//     #include <tds/soa-vector.h>
+//
+// generates `particles`, with `float* x`, `float* y` and `uint32_t* id` arrays, and `particles_value_t`, a struct with
+// one member per field used to append or read whole elements. All arrays share a single allocation.
+
+#ifndef TDS_TYPE
+#error "soa-vector.h requires TDS_TYPE."
+#endif
+
+#ifndef TDS_FIELDS
+#error "soa-vector.h requires TDS_FIELDS."
+#endif
+
+#ifdef TDS_VALUE_FINI
+#error "soa-vector.h doesn't support TDS_VALUE_FINI."
+#endif
+
+#ifndef TDS_ALIGNMENT
+#define TDS_ALIGNMENT TDS_CACHE_LINE_SIZE
+#endif
+
+#define TDS_SOA_VALUE_T TDS_JOIN2(TDS_TYPE, _value_t)
+// Every array starts at a multiple of this offset into the allocation, which keeps them aligned for SIMD loads.
+#define TDS_SOA_ARRAY_ALIGNMENT ((size_t)TDS_CACHE_LINE_SIZE)
+
+#ifdef TDS_DECLARE
+#define TDS_SOA_MEMBER(type, name) type name;
+#define TDS_SOA_ARRAY(type, name) type* name;
+typedef struct TDS_SOA_VALUE_T {
+    TDS_FIELDS(TDS_SOA_MEMBER)
+} TDS_SOA_VALUE_T;
+
+typedef struct TDS_TYPE {
+    TDS_FIELDS(TDS_SOA_ARRAY)
+    void* block; // The allocation holding every array.
+    TDS_SIZE_T count, capacity;
+#ifdef TDS_ALLOCATOR
+    const tds_allocator_t* allocator;
+#endif
+} TDS_TYPE;
+#undef TDS_SOA_MEMBER
+#undef TDS_SOA_ARRAY
+
+void TDS_FUNCTION(append)(TDS_TYPE* vec, TDS_SOA_VALUE_T value);
+void TDS_FUNCTION(reserve)(TDS_TYPE* vec, TDS_SIZE_T capacity);
+TDS_SIZE_T TDS_FUNCTION(grow)(TDS_TYPE* vec, TDS_SIZE_T count);
+TDS_SOA_VALUE_T TDS_FUNCTION(get)(const TDS_TYPE* vec, TDS_SIZE_T index);
+void TDS_FUNCTION(set)(TDS_TYPE* vec, TDS_SIZE_T index, TDS_SOA_VALUE_T value);
+void TDS_FUNCTION(remove)(TDS_TYPE* vec, TDS_SIZE_T index);
+void TDS_FUNCTION(remove_swap)(TDS_TYPE* vec, TDS_SIZE_T index);
+TDS_SIZE_T TDS_FUNCTION(count)(const TDS_TYPE* vec);
+void TDS_FUNCTION(clear)(TDS_TYPE* vec);
+void TDS_FUNCTION(reclaim)(TDS_TYPE* vec);
+void TDS_FUNCTION(fini)(TDS_TYPE* vec);
+#endif
+
+#ifdef TDS_IMPLEMENT
+static size_t TDS_FUNCTION(_align_offset)(const size_t offset) {
+    return (offset + TDS_SOA_ARRAY_ALIGNMENT - 1) & ~(TDS_SOA_ARRAY_ALIGNMENT - 1);
+}
+
+// Bytes needed for `capacity` elements, padding between the arrays included.
+static size_t TDS_FUNCTION(_block_size)(const TDS_SIZE_T capacity) {
+    size_t size = 0;
+#define TDS_SOA_SIZE(type, name) size = TDS_FUNCTION(_align_offset)(size) + (size_t)capacity * sizeof(type);
+    TDS_FIELDS(TDS_SOA_SIZE)
+#undef TDS_SOA_SIZE
+    return size;
+}
+
+// Moves the elements to a new allocation of `capacity` elements, or frees the storage if `capacity` is zero.
+static void TDS_FUNCTION(_relocate)(TDS_TYPE* vec, const TDS_SIZE_T capacity) {
+    TDS_ASSERT(vec->count <= capacity);
+
+    char* block = capacity ? tds_allocate(TDS_ALLOCATOR_OF(vec), TDS_FUNCTION(_block_size)(capacity), TDS_ALIGNMENT) : NULL;
+    size_t offset = 0;
+#define TDS_SOA_MOVE(type, name) {\
+        offset = TDS_FUNCTION(_align_offset)(offset);\
+        type* array = block ? (type*)(block + offset) : NULL;\
+        if (vec->count) {\
+            TDS_MEMCPY(array, vec->name, (size_t)vec->count * sizeof(type));\
+        }\
+        vec->name = array;\
+        offset += (size_t)capacity * sizeof(type);\
+    }
+    TDS_FIELDS(TDS_SOA_MOVE)
+#undef TDS_SOA_MOVE
+
+    tds_deallocate(TDS_ALLOCATOR_OF(vec), vec->block, TDS_FUNCTION(_block_size)(vec->capacity), TDS_ALIGNMENT);
+    vec->block = block;
+    vec->capacity = capacity;
+}
+
+void TDS_FUNCTION(append)(TDS_TYPE* vec, const TDS_SOA_VALUE_T value) {
+    TDS_FUNCTION(set)(vec, TDS_FUNCTION(grow)(vec, 1), value);
+}
+
+// Reserves exactly `capacity` elements, without rounding up.
+void TDS_FUNCTION(reserve)(TDS_TYPE* vec, const TDS_SIZE_T capacity) {
+    TDS_ASSERT(vec->count <= vec->capacity);
+
+    if (capacity <= vec->capacity) {
+        return;
+    }
+
+    TDS_FUNCTION(_relocate)(vec, capacity);
+}
+
+// Extends the vector by `count` elements, which are left for the caller to write through the arrays, and returns the
+// index of the first one.
+TDS_SIZE_T TDS_FUNCTION(grow)(TDS_TYPE* vec, const TDS_SIZE_T count) {
+    TDS_ASSERT(vec->count <= vec->capacity);
+
+    const TDS_SIZE_T old_count = vec->count;
+    const TDS_SIZE_T needed = old_count + count;
+    // Guard against overflow and negative counts.
+    TDS_ASSERT(needed >= old_count);
+
+    if (needed > vec->capacity) {
+        TDS_FUNCTION(_relocate)(vec, TDS_GROWN_CAPACITY(vec->capacity, needed));
+    }
+    vec->count = needed;
+
+    return old_count;
+}
+
+TDS_SOA_VALUE_T TDS_FUNCTION(get)(const TDS_TYPE* vec, const TDS_SIZE_T index) {
+    TDS_ASSERT(index < vec->count);
+
+    TDS_SOA_VALUE_T value;
+#define TDS_SOA_GET(type, name) value.name = vec->name[index];
+    TDS_FIELDS(TDS_SOA_GET)
+#undef TDS_SOA_GET
+    return value;
+}
+
+void TDS_FUNCTION(set)(TDS_TYPE* vec, const TDS_SIZE_T index, const TDS_SOA_VALUE_T value) {
+    TDS_ASSERT(index < vec->count);
+
+#define TDS_SOA_SET(type, name) vec->name[index] = value.name;
+    TDS_FIELDS(TDS_SOA_SET)
+#undef TDS_SOA_SET
+}
+
+void TDS_FUNCTION(remove)(TDS_TYPE* vec, const TDS_SIZE_T index) {
+    TDS_ASSERT(index < vec->count);
+
+    if (index < vec->count - 1) {
+        // Shift elements to the left
+        const size_t moved = (size_t)(vec->count - index - 1);
+#define TDS_SOA_SHIFT(type, name) TDS_MEMMOVE(&vec->name[index], &vec->name[index + 1], moved * sizeof(type));
+        TDS_FIELDS(TDS_SOA_SHIFT)
+#undef TDS_SOA_SHIFT
+    }
+    vec->count--;
+}
+
+// Removes the element at `index` in O(1) by moving the last element into its place. Doesn't preserve order.
+void TDS_FUNCTION(remove_swap)(TDS_TYPE* vec, const TDS_SIZE_T index) {
+    TDS_ASSERT(index < vec->count);
+
+    vec->count--;
+#define TDS_SOA_SWAP(type, name) vec->name[index] = vec->name[vec->count];
+    TDS_FIELDS(TDS_SOA_SWAP)
+#undef TDS_SOA_SWAP
+}
+
+TDS_SIZE_T TDS_FUNCTION(count)(const TDS_TYPE* vec) {
+    return vec->count;
+}
+
+void TDS_FUNCTION(clear)(TDS_TYPE* vec) {
+    vec->count = 0;
+}
+
+void TDS_FUNCTION(reclaim)(TDS_TYPE* vec) {
+    TDS_ASSERT(vec->count <= vec->capacity);
+
+    if (vec->count == vec->capacity) {
+        return;
+    }
+
+    TDS_FUNCTION(_relocate)(vec, vec->count);
+}
+
+void TDS_FUNCTION(fini)(TDS_TYPE* vec) {
+    tds_deallocate(TDS_ALLOCATOR_OF(vec), vec->block, TDS_FUNCTION(_block_size)(vec->capacity), TDS_ALIGNMENT);
+    TDS_RESET(vec);
+}
+#endif
+
+#include "private/end.inc"
+
+#undef TDS_FIELDS
+#undef TDS_SOA_VALUE_T
+#undef TDS_SOA_ARRAY_ALIGNMENT
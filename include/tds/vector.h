@@ -1,26 +1,133 @@
 #include "private/common.h"
+#ifdef TDS_PARALLEL
+#include "parallel.h"
+#endif
 #include "private/begin.inc"
 
 #ifndef TDS_TYPE
 #define TDS_TYPE TDS_DEFAULT_TYPE_W_VALUE(vec)
 #endif
 
+#ifndef TDS_ALIGNMENT
+#define TDS_ALIGNMENT 0
+#endif
+
+// Sorting and searching are generated for vectors defined with TDS_SORTABLE or TDS_VALUE_LESS. Without TDS_VALUE_LESS,
+// values are compared with `<`, so they must be of an arithmetic type, and integers are sorted with a radix sort.
+#if defined(TDS_VALUE_LESS) && !defined(TDS_SORTABLE)
+#define TDS_SORTABLE
+#endif
+
+#ifdef TDS_SORTABLE
+#ifndef TDS_VALUE_LESS
+#define TDS_VALUE_LESS(a, b) ((a) < (b))
+#define TDS_VALUE_ARITHMETIC
+#endif
+
+// Ranges shorter than this are insertion sorted.
+#define TDS_INSERTION_SORT_THRESHOLD 24
+// Ranges longer than this pick their pivot as the median of three medians.
+#define TDS_NINTHER_THRESHOLD 128
+// Integer vectors at least this long are radix sorted.
+#define TDS_RADIX_SORT_THRESHOLD 256
+#endif
+
+// Bulk numeric kernels are generated for vectors of arithmetic values defined with TDS_NUMERIC. They are plain C written
+// so that compilers vectorize them: every loop works on a cache line of independent lanes at a time, which also lets
+// floating point sums be vectorized without -ffast-math, and keeps its lanes in the type of the values. With GCC at -O3
+// they vectorize for baseline x86-64, except for 64-bit integer comparisons, which need SSE4.1 (-march=x86-64-v2).
+#ifdef TDS_NUMERIC
+#ifdef TDS_VALUE_FINI
+#error "TDS_NUMERIC doesn't support TDS_VALUE_FINI."
+#endif
+
+#define TDS_LANES (sizeof(TDS_VALUE_T) < TDS_CACHE_LINE_SIZE ? TDS_CACHE_LINE_SIZE / sizeof(TDS_VALUE_T) : 1)
+
+// Marks the loops over the lanes. GCC fully unrolls them otherwise, and then often fails to vectorize the result.
+#if defined(__GNUC__) && !defined(__clang__)
+#define TDS_LANE_LOOP _Pragma("GCC unroll 1")
+#else
+#define TDS_LANE_LOOP
+#endif
+
+// Blocks of TDS_LANES values counted before the lanes are added up, few enough that counters of any arithmetic type,
+// even signed char, can't overflow.
+#define TDS_COUNT_BLOCKS 127
+
+// Blocks `find` compares before checking whether any of them matched.
+#define TDS_FIND_BLOCKS 4
+#endif
+
 #ifdef TDS_DECLARE
 typedef struct TDS_TYPE {
     TDS_VALUE_T* array;
     TDS_SIZE_T count, capacity;
+#ifdef TDS_ALLOCATOR
+    const tds_allocator_t* allocator;
+#endif
 } TDS_TYPE;
 
 void TDS_FUNCTION(append)(TDS_TYPE* vec, TDS_VALUE_T value);
 void TDS_FUNCTION(reserve)(TDS_TYPE* vec, TDS_SIZE_T capacity);
 TDS_VALUE_T* TDS_FUNCTION(grow)(TDS_TYPE* vec, TDS_SIZE_T count);
+void TDS_FUNCTION(extend)(TDS_TYPE* vec, const TDS_VALUE_T* source, TDS_SIZE_T count);
+void TDS_FUNCTION(insert)(TDS_TYPE* vec, TDS_SIZE_T index, TDS_VALUE_T value);
+void TDS_FUNCTION(insert_many)(TDS_TYPE* vec, TDS_SIZE_T index, const TDS_VALUE_T* source, TDS_SIZE_T count);
+void TDS_FUNCTION(splice)(
+    TDS_TYPE* vec,
+    TDS_SIZE_T index,
+    TDS_TYPE* source,
+    TDS_SIZE_T source_index,
+    TDS_SIZE_T count);
 void TDS_FUNCTION(remove)(TDS_TYPE* vec, TDS_SIZE_T index);
+void TDS_FUNCTION(remove_swap)(TDS_TYPE* vec, TDS_SIZE_T index);
+void TDS_FUNCTION(remove_range)(TDS_TYPE* vec, TDS_SIZE_T index, TDS_SIZE_T count);
+TDS_SIZE_T TDS_FUNCTION(retain_if)(
+    TDS_TYPE* vec,
+    char (*predicate)(const TDS_VALUE_T* value, void* user_data),
+    void* user_data);
 TDS_VALUE_T TDS_FUNCTION(get)(const TDS_TYPE* vec, TDS_SIZE_T index);
 TDS_SIZE_T TDS_FUNCTION(count)(const TDS_TYPE* vec);
 TDS_VALUE_T* TDS_FUNCTION(first)(const TDS_TYPE* vec);
 void TDS_FUNCTION(clear)(TDS_TYPE* vec);
 void TDS_FUNCTION(reclaim)(TDS_TYPE* vec);
 void TDS_FUNCTION(fini)(TDS_TYPE* vec);
+#ifdef TDS_SORTABLE
+void TDS_FUNCTION(sort)(TDS_TYPE* vec);
+#ifdef TDS_VALUE_ARITHMETIC
+void TDS_FUNCTION(radix_sort)(TDS_TYPE* vec);
+#endif
+TDS_SIZE_T TDS_FUNCTION(lower_bound)(const TDS_TYPE* vec, TDS_VALUE_T value);
+TDS_VALUE_T* TDS_FUNCTION(binary_search)(const TDS_TYPE* vec, TDS_VALUE_T value);
+TDS_SIZE_T TDS_FUNCTION(unique)(TDS_TYPE* vec);
+#endif
+#ifdef TDS_NUMERIC
+TDS_VALUE_T TDS_FUNCTION(sum)(const TDS_TYPE* vec);
+char TDS_FUNCTION(min_max)(const TDS_TYPE* vec, TDS_VALUE_T* min, TDS_VALUE_T* max);
+TDS_SIZE_T TDS_FUNCTION(count_if_eq)(const TDS_TYPE* vec, TDS_VALUE_T value);
+TDS_VALUE_T* TDS_FUNCTION(find)(const TDS_TYPE* vec, TDS_VALUE_T value);
+TDS_SIZE_T TDS_FUNCTION(filter_into)(
+    const TDS_TYPE* vec,
+    TDS_TYPE* destination,
+    char (*predicate)(const TDS_VALUE_T* value, void* user_data),
+    void* user_data);
+void TDS_FUNCTION(fill)(TDS_TYPE* vec, TDS_VALUE_T value);
+#endif
+#ifdef TDS_PARALLEL
+void TDS_FUNCTION(parallel_for_each)(
+    TDS_TYPE* vec,
+    const tds_executor_t* executor,
+    void (*function)(TDS_VALUE_T* values, TDS_SIZE_T count, void* user_data),
+    void* user_data);
+TDS_VALUE_T TDS_FUNCTION(parallel_reduce)(
+    const TDS_TYPE* vec,
+    const tds_executor_t* executor,
+    TDS_VALUE_T (*reduce)(const TDS_VALUE_T* values, TDS_SIZE_T count, void* user_data),
+    void* user_data);
+#ifdef TDS_SORTABLE
+void TDS_FUNCTION(parallel_sort)(TDS_TYPE* vec, const tds_executor_t* executor);
+#endif
+#endif
 #endif
 
 #ifdef TDS_IMPLEMENT
@@ -29,6 +136,7 @@ void TDS_FUNCTION(append)(TDS_TYPE* vec, const TDS_VALUE_T value) {
     *slot = value;
 }
 
+// Reserves exactly `capacity` elements, without rounding up.
 void TDS_FUNCTION(reserve)(TDS_TYPE* vec, const TDS_SIZE_T capacity) {
     TDS_ASSERT(vec->count <= vec->capacity);
 
@@ -36,7 +144,12 @@ void TDS_FUNCTION(reserve)(TDS_TYPE* vec, const TDS_SIZE_T capacity) {
         return;
     }
 
-    vec->array = TDS_REALLOC(vec->array, sizeof(TDS_VALUE_T) * capacity);
+    vec->array = tds_reallocate(
+        TDS_ALLOCATOR_OF(vec),
+        vec->array,
+        sizeof(TDS_VALUE_T) * vec->capacity,
+        sizeof(TDS_VALUE_T) * capacity,
+        TDS_ALIGNMENT);
     vec->capacity = capacity;
 }
 
@@ -52,12 +165,80 @@ TDS_VALUE_T* TDS_FUNCTION(grow)(TDS_TYPE* vec, const TDS_SIZE_T count) {
     // Guard against overflow and negative counts.
     TDS_ASSERT(needed > old_count);
 
-    TDS_FUNCTION(reserve)(vec, needed);
+    if (needed > vec->capacity) {
+        TDS_FUNCTION(reserve)(vec, TDS_GROWN_CAPACITY(vec->capacity, needed));
+    }
     vec->count = needed;
 
     return vec->array + old_count;
 }
 
+// Appends `count` values copied from `source`, which must not point into the vector.
+void TDS_FUNCTION(extend)(TDS_TYPE* vec, const TDS_VALUE_T* source, const TDS_SIZE_T count) {
+    if (count == 0) {
+        return;
+    }
+
+    TDS_MEMCPY(TDS_FUNCTION(grow)(vec, count), source, (size_t)count * sizeof(TDS_VALUE_T));
+}
+
+// Opens a gap of `count` elements at `index`, shifting later elements right, and returns a pointer to it.
+static TDS_VALUE_T* TDS_FUNCTION(_open_gap)(TDS_TYPE* vec, const TDS_SIZE_T index, const TDS_SIZE_T count) {
+    TDS_ASSERT(index <= vec->count);
+
+    const TDS_SIZE_T old_count = vec->count;
+    TDS_FUNCTION(grow)(vec, count);
+    if (index < old_count) {
+        TDS_MEMMOVE(&vec->array[index + count], &vec->array[index], (size_t)(old_count - index) * sizeof(TDS_VALUE_T));
+    }
+
+    return vec->array + index;
+}
+
+// Inserts `value` at `index`, shifting later elements right.
+void TDS_FUNCTION(insert)(TDS_TYPE* vec, const TDS_SIZE_T index, const TDS_VALUE_T value) {
+    *TDS_FUNCTION(_open_gap)(vec, index, 1) = value;
+}
+
+// Inserts `count` values copied from `source` at `index`. `source` must not point into the vector.
+void TDS_FUNCTION(insert_many)(
+    TDS_TYPE* vec,
+    const TDS_SIZE_T index,
+    const TDS_VALUE_T* source,
+    const TDS_SIZE_T count
+) {
+    if (count == 0) {
+        TDS_ASSERT(index <= vec->count);
+        return;
+    }
+
+    TDS_MEMCPY(TDS_FUNCTION(_open_gap)(vec, index, count), source, (size_t)count * sizeof(TDS_VALUE_T));
+}
+
+// Moves `count` elements starting at `source_index` out of `source` and inserts them into `vec` at `index`. The moved
+// elements aren't finalized.
+void TDS_FUNCTION(splice)(
+    TDS_TYPE* vec,
+    const TDS_SIZE_T index,
+    TDS_TYPE* source,
+    const TDS_SIZE_T source_index,
+    const TDS_SIZE_T count
+) {
+    TDS_ASSERT(vec != source);
+    TDS_ASSERT(source_index <= source->count && count <= source->count - source_index);
+
+    TDS_FUNCTION(insert_many)(vec, index, source->array + source_index, count);
+
+    const TDS_SIZE_T end = source_index + count;
+    if (count > 0 && end < source->count) {
+        TDS_MEMMOVE(
+            &source->array[source_index],
+            &source->array[end],
+            (size_t)(source->count - end) * sizeof(TDS_VALUE_T));
+    }
+    source->count -= count;
+}
+
 void TDS_FUNCTION(remove)(TDS_TYPE* vec, const TDS_SIZE_T index) {
     TDS_ASSERT(index < vec->count);
 
@@ -72,6 +253,59 @@ void TDS_FUNCTION(remove)(TDS_TYPE* vec, const TDS_SIZE_T index) {
     vec->count--;
 }
 
+// Removes the element at `index` in O(1) by moving the last element into its place. Doesn't preserve order.
+void TDS_FUNCTION(remove_swap)(TDS_TYPE* vec, const TDS_SIZE_T index) {
+    TDS_ASSERT(index < vec->count);
+
+#ifdef TDS_VALUE_FINI
+    TDS_VALUE_FINI(vec->array[index]);
+#endif
+
+    vec->count--;
+    vec->array[index] = vec->array[vec->count];
+}
+
+// Removes `count` elements starting at `index` with a single shift of the elements after them.
+void TDS_FUNCTION(remove_range)(TDS_TYPE* vec, const TDS_SIZE_T index, const TDS_SIZE_T count) {
+    TDS_ASSERT(index <= vec->count && count <= vec->count - index);
+
+#ifdef TDS_VALUE_FINI
+    for (TDS_SIZE_T i = index; i < index + count; i++) {
+        TDS_VALUE_FINI(vec->array[i]);
+    }
+#endif
+
+    const TDS_SIZE_T end = index + count;
+    if (count > 0 && end < vec->count) {
+        TDS_MEMMOVE(&vec->array[index], &vec->array[end], (size_t)(vec->count - end) * sizeof(TDS_VALUE_T));
+    }
+    vec->count -= count;
+}
+
+// Keeps only the elements `predicate` returns nonzero for, preserving their order, in one pass. Returns how many
+// elements were removed.
+TDS_SIZE_T TDS_FUNCTION(retain_if)(
+    TDS_TYPE* vec,
+    char (*predicate)(const TDS_VALUE_T* value, void* user_data),
+    void* user_data
+) {
+    TDS_SIZE_T kept = 0;
+    for (TDS_SIZE_T i = 0; i < vec->count; i++) {
+        if (!predicate(&vec->array[i], user_data)) {
+#ifdef TDS_VALUE_FINI
+            TDS_VALUE_FINI(vec->array[i]);
+#endif
+            continue;
+        }
+
+        vec->array[kept++] = vec->array[i];
+    }
+
+    const TDS_SIZE_T removed = vec->count - kept;
+    vec->count = kept;
+    return removed;
+}
+
 TDS_VALUE_T TDS_FUNCTION(get)(const TDS_TYPE* vec, const TDS_SIZE_T index) {
     TDS_ASSERT(index < vec->count);
     return vec->array[index];
@@ -102,12 +336,17 @@ void TDS_FUNCTION(reclaim)(TDS_TYPE* vec) {
     }
 
     if (vec->count == 0) {
-        TDS_FREE(vec->array);
-        *vec = (TDS_TYPE){ 0 };
+        tds_deallocate(TDS_ALLOCATOR_OF(vec), vec->array, sizeof(TDS_VALUE_T) * vec->capacity, TDS_ALIGNMENT);
+        TDS_RESET(vec);
         return;
     }
 
-    vec->array = TDS_REALLOC(vec->array, sizeof(TDS_VALUE_T) * vec->count);
+    vec->array = tds_reallocate(
+        TDS_ALLOCATOR_OF(vec),
+        vec->array,
+        sizeof(TDS_VALUE_T) * vec->capacity,
+        sizeof(TDS_VALUE_T) * vec->count,
+        TDS_ALIGNMENT);
     vec->capacity = vec->count;
 }
 
@@ -117,9 +356,762 @@ void TDS_FUNCTION(fini)(TDS_TYPE* vec) {
         TDS_VALUE_FINI(vec->array[i]);
     }
 #endif
-    TDS_FREE(vec->array);
-    *vec = (TDS_TYPE){ 0 };
+    tds_deallocate(TDS_ALLOCATOR_OF(vec), vec->array, sizeof(TDS_VALUE_T) * vec->capacity, TDS_ALIGNMENT);
+    TDS_RESET(vec);
+}
+
+#ifdef TDS_SORTABLE
+static void TDS_FUNCTION(_swap)(TDS_VALUE_T* a, TDS_VALUE_T* b) {
+    const TDS_VALUE_T temporary = *a;
+    *a = *b;
+    *b = temporary;
+}
+
+static void TDS_FUNCTION(_sort2)(TDS_VALUE_T* a, TDS_VALUE_T* b) {
+    if (TDS_VALUE_LESS(*b, *a)) {
+        TDS_FUNCTION(_swap)(a, b);
+    }
+}
+
+static void TDS_FUNCTION(_sort3)(TDS_VALUE_T* a, TDS_VALUE_T* b, TDS_VALUE_T* c) {
+    TDS_FUNCTION(_sort2)(a, b);
+    TDS_FUNCTION(_sort2)(b, c);
+    TDS_FUNCTION(_sort2)(a, b);
+}
+
+// Sorts [begin, end). Unless `guarded`, the element before `begin` must not be greater than any element of the range,
+// which lets the inner loop skip the bounds check.
+static void TDS_FUNCTION(_insertion_sort)(TDS_VALUE_T* begin, TDS_VALUE_T* end, const char guarded) {
+    if (begin == end) {
+        return;
+    }
+
+    for (TDS_VALUE_T* current = begin + 1; current != end; current++) {
+        TDS_VALUE_T* sift = current;
+        if (TDS_VALUE_LESS(*sift, *(sift - 1))) {
+            const TDS_VALUE_T value = *sift;
+            do {
+                *sift = *(sift - 1);
+                sift--;
+            } while ((!guarded || sift != begin) && TDS_VALUE_LESS(value, *(sift - 1)));
+            *sift = value;
+        }
+    }
+}
+
+// Insertion sorts [begin, end) but gives up after moving a few elements. Returns whether the range got sorted.
+static char TDS_FUNCTION(_partial_insertion_sort)(TDS_VALUE_T* begin, TDS_VALUE_T* end) {
+    if (begin == end) {
+        return 1;
+    }
+
+    size_t moved = 0;
+    for (TDS_VALUE_T* current = begin + 1; current != end; current++) {
+        if (moved > 8) {
+            return 0;
+        }
+
+        TDS_VALUE_T* sift = current;
+        if (TDS_VALUE_LESS(*sift, *(sift - 1))) {
+            const TDS_VALUE_T value = *sift;
+            do {
+                *sift = *(sift - 1);
+                sift--;
+            } while (sift != begin && TDS_VALUE_LESS(value, *(sift - 1)));
+            *sift = value;
+            moved += (size_t)(current - sift);
+        }
+    }
+
+    return 1;
+}
+
+static void TDS_FUNCTION(_sift_down)(TDS_VALUE_T* heap, const size_t count, size_t parent) {
+    const TDS_VALUE_T value = heap[parent];
+    for (size_t child = parent * 2 + 1; child < count; child = parent * 2 + 1) {
+        if (child + 1 < count && TDS_VALUE_LESS(heap[child], heap[child + 1])) {
+            child++;
+        }
+        if (!TDS_VALUE_LESS(value, heap[child])) {
+            break;
+        }
+        heap[parent] = heap[child];
+        parent = child;
+    }
+    heap[parent] = value;
+}
+
+static void TDS_FUNCTION(_heap_sort)(TDS_VALUE_T* begin, TDS_VALUE_T* end) {
+    const size_t count = (size_t)(end - begin);
+    for (size_t i = count / 2; i-- > 0;) {
+        TDS_FUNCTION(_sift_down)(begin, count, i);
+    }
+    for (size_t i = count; i-- > 1;) {
+        TDS_FUNCTION(_swap)(begin, begin + i);
+        TDS_FUNCTION(_sift_down)(begin, i, 0);
+    }
+}
+
+// Partitions [begin, end) around the pivot in `*begin`, putting the elements equal to it on the right. Returns the
+// pivot's final position and sets `already_partitioned` if no element had to be swapped.
+static TDS_VALUE_T* TDS_FUNCTION(_partition_right)(TDS_VALUE_T* begin, TDS_VALUE_T* end, char* already_partitioned) {
+    const TDS_VALUE_T pivot = *begin;
+    TDS_VALUE_T* first = begin;
+    TDS_VALUE_T* last = end;
+
+    // The median-of-three pivot selection guarantees an element not less than the pivot before `end`.
+    while (TDS_VALUE_LESS(*++first, pivot)) {}
+    if (first - 1 == begin) {
+        while (first < last && !TDS_VALUE_LESS(*--last, pivot)) {}
+    } else {
+        while (!TDS_VALUE_LESS(*--last, pivot)) {}
+    }
+
+    *already_partitioned = first >= last;
+    while (first < last) {
+        TDS_FUNCTION(_swap)(first, last);
+        while (TDS_VALUE_LESS(*++first, pivot)) {}
+        while (!TDS_VALUE_LESS(*--last, pivot)) {}
+    }
+
+    TDS_VALUE_T* pivot_position = first - 1;
+    *begin = *pivot_position;
+    *pivot_position = pivot;
+    return pivot_position;
+}
+
+// Like `_partition_right`, but puts the elements equal to the pivot on the left. Used when the pivot equals the element
+// before the range, in which case everything equal to it is already in place.
+static TDS_VALUE_T* TDS_FUNCTION(_partition_left)(TDS_VALUE_T* begin, TDS_VALUE_T* end) {
+    const TDS_VALUE_T pivot = *begin;
+    TDS_VALUE_T* first = begin;
+    TDS_VALUE_T* last = end;
+
+    while (TDS_VALUE_LESS(pivot, *--last)) {}
+    if (last + 1 == end) {
+        while (first < last && !TDS_VALUE_LESS(pivot, *++first)) {}
+    } else {
+        while (!TDS_VALUE_LESS(pivot, *++first)) {}
+    }
+
+    while (first < last) {
+        TDS_FUNCTION(_swap)(first, last);
+        while (TDS_VALUE_LESS(pivot, *--last)) {}
+        while (!TDS_VALUE_LESS(pivot, *++first)) {}
+    }
+
+    *begin = *last;
+    *last = pivot;
+    return last;
+}
+
+// Pattern-defeating quicksort. Falls back to heap sort after `bad_allowed` badly unbalanced partitions, and `leftmost`
+// tells whether there is an element before `begin` that can serve as a sentinel.
+static void TDS_FUNCTION(_pdqsort)(TDS_VALUE_T* begin, TDS_VALUE_T* end, unsigned bad_allowed, char leftmost) {
+    for (;;) {
+        const size_t size = (size_t)(end - begin);
+        if (size < TDS_INSERTION_SORT_THRESHOLD) {
+            TDS_FUNCTION(_insertion_sort)(begin, end, leftmost);
+            return;
+        }
+
+        // Move the pivot to `begin`.
+        const size_t half = size / 2;
+        if (size > TDS_NINTHER_THRESHOLD) {
+            TDS_FUNCTION(_sort3)(begin, begin + half, end - 1);
+            TDS_FUNCTION(_sort3)(begin + 1, begin + (half - 1), end - 2);
+            TDS_FUNCTION(_sort3)(begin + 2, begin + (half + 1), end - 3);
+            TDS_FUNCTION(_sort3)(begin + (half - 1), begin + half, begin + (half + 1));
+            TDS_FUNCTION(_swap)(begin, begin + half);
+        } else {
+            TDS_FUNCTION(_sort3)(begin + half, begin, end - 1);
+        }
+
+        // Many elements equal to the pivot: skip past all of them at once.
+        if (!leftmost && !TDS_VALUE_LESS(*(begin - 1), *begin)) {
+            begin = TDS_FUNCTION(_partition_left)(begin, end) + 1;
+            continue;
+        }
+
+        char already_partitioned;
+        TDS_VALUE_T* pivot = TDS_FUNCTION(_partition_right)(begin, end, &already_partitioned);
+        const size_t left_size = (size_t)(pivot - begin);
+        const size_t right_size = (size_t)(end - (pivot + 1));
+
+        if (left_size < size / 8 || right_size < size / 8) {
+            if (--bad_allowed == 0) {
+                TDS_FUNCTION(_heap_sort)(begin, end);
+                return;
+            }
+
+            // Shuffle some elements around to break the pattern that caused the bad partition.
+            if (left_size >= TDS_INSERTION_SORT_THRESHOLD) {
+                TDS_FUNCTION(_swap)(begin, begin + left_size / 4);
+                TDS_FUNCTION(_swap)(pivot - 1, pivot - left_size / 4);
+                if (left_size > TDS_NINTHER_THRESHOLD) {
+                    TDS_FUNCTION(_swap)(begin + 1, begin + (left_size / 4 + 1));
+                    TDS_FUNCTION(_swap)(begin + 2, begin + (left_size / 4 + 2));
+                    TDS_FUNCTION(_swap)(pivot - 2, pivot - (left_size / 4 + 1));
+                    TDS_FUNCTION(_swap)(pivot - 3, pivot - (left_size / 4 + 2));
+                }
+            }
+            if (right_size >= TDS_INSERTION_SORT_THRESHOLD) {
+                TDS_FUNCTION(_swap)(pivot + 1, pivot + (1 + right_size / 4));
+                TDS_FUNCTION(_swap)(end - 1, end - right_size / 4);
+                if (right_size > TDS_NINTHER_THRESHOLD) {
+                    TDS_FUNCTION(_swap)(pivot + 2, pivot + (2 + right_size / 4));
+                    TDS_FUNCTION(_swap)(pivot + 3, pivot + (3 + right_size / 4));
+                    TDS_FUNCTION(_swap)(end - 2, end - (1 + right_size / 4));
+                    TDS_FUNCTION(_swap)(end - 3, end - (2 + right_size / 4));
+                }
+            }
+        } else if (already_partitioned
+            && TDS_FUNCTION(_partial_insertion_sort)(begin, pivot)
+            && TDS_FUNCTION(_partial_insertion_sort)(pivot + 1, end)) {
+            // The range was most likely already sorted.
+            return;
+        }
+
+        // Recurse into the left part and loop on the right one.
+        TDS_FUNCTION(_pdqsort)(begin, pivot, bad_allowed, leftmost);
+        begin = pivot + 1;
+        leftmost = 0;
+    }
+}
+
+#ifdef TDS_VALUE_ARITHMETIC
+// Integers are sorted by their bytes, with the sign bit flipped for signed types so negative values come first.
+static uint64_t TDS_FUNCTION(_radix_key)(const TDS_VALUE_T value) {
+    uint64_t key = (uint64_t)value;
+    if (TDS_IS_SIGNED(TDS_VALUE_T)) {
+        key ^= (uint64_t)1 << (sizeof(TDS_VALUE_T) * 8 - 1);
+    }
+    return key;
+}
+
+static char TDS_FUNCTION(_is_integer)(void) {
+    return !((TDS_VALUE_T)1 / 2 > 0) && sizeof(TDS_VALUE_T) <= sizeof(uint64_t);
+}
+
+// Least significant digit radix sort of `count` integers, a byte per pass, using `buffer` as scratch space. Passes in
+// which every value has the same byte are skipped.
+static void TDS_FUNCTION(_radix_sort)(TDS_VALUE_T* array, TDS_VALUE_T* buffer, const size_t count) {
+    size_t histograms[sizeof(TDS_VALUE_T)][256] = { { 0 } };
+    for (size_t i = 0; i < count; i++) {
+        const uint64_t key = TDS_FUNCTION(_radix_key)(array[i]);
+        for (size_t digit = 0; digit < sizeof(TDS_VALUE_T); digit++) {
+            histograms[digit][(key >> (digit * 8)) & 0xff]++;
+        }
+    }
+
+    TDS_VALUE_T* source = array;
+    TDS_VALUE_T* destination = buffer;
+    for (size_t digit = 0; digit < sizeof(TDS_VALUE_T); digit++) {
+        size_t* histogram = histograms[digit];
+        if (histogram[(TDS_FUNCTION(_radix_key)(source[0]) >> (digit * 8)) & 0xff] == count) {
+            continue;
+        }
+
+        // Turn the counts into starting offsets.
+        size_t offset = 0;
+        for (size_t bucket = 0; bucket < 256; bucket++) {
+            const size_t bucket_count = histogram[bucket];
+            histogram[bucket] = offset;
+            offset += bucket_count;
+        }
+
+        for (size_t i = 0; i < count; i++) {
+            destination[histogram[(TDS_FUNCTION(_radix_key)(source[i]) >> (digit * 8)) & 0xff]++] = source[i];
+        }
+
+        TDS_VALUE_T* swapped = source;
+        source = destination;
+        destination = swapped;
+    }
+
+    if (source != array) {
+        TDS_MEMCPY(array, source, count * sizeof(TDS_VALUE_T));
+    }
+}
+
+// Sorts an integer vector with a radix sort, allocating a temporary buffer. Values that aren't integers are sorted
+// with `sort`.
+void TDS_FUNCTION(radix_sort)(TDS_TYPE* vec) {
+    if (!TDS_FUNCTION(_is_integer)()) {
+        TDS_FUNCTION(sort)(vec);
+        return;
+    }
+
+    const size_t count = vec->count;
+    if (count < 2) {
+        return;
+    }
+
+    TDS_VALUE_T* buffer = tds_allocate(TDS_ALLOCATOR_OF(vec), count * sizeof(TDS_VALUE_T), TDS_ALIGNMENT);
+    TDS_FUNCTION(_radix_sort)(vec->array, buffer, count);
+    tds_deallocate(TDS_ALLOCATOR_OF(vec), buffer, count * sizeof(TDS_VALUE_T), TDS_ALIGNMENT);
+}
+#endif
+
+static void TDS_FUNCTION(_pdqsort_range)(TDS_VALUE_T* array, const size_t count) {
+    if (count < 2) {
+        return;
+    }
+
+    // Allow about log2(count) bad partitions before falling back to heap sort.
+    unsigned bad_allowed = 1;
+    for (size_t remaining = count; remaining > 1; remaining /= 2) {
+        bad_allowed++;
+    }
+    TDS_FUNCTION(_pdqsort)(array, array + count, bad_allowed, 1);
+}
+
+// Sorts the vector in ascending order by TDS_VALUE_LESS. Not stable.
+void TDS_FUNCTION(sort)(TDS_TYPE* vec) {
+#ifdef TDS_VALUE_ARITHMETIC
+    if (vec->count >= TDS_RADIX_SORT_THRESHOLD && TDS_FUNCTION(_is_integer)()) {
+        TDS_FUNCTION(radix_sort)(vec);
+        return;
+    }
+#endif
+
+    TDS_FUNCTION(_pdqsort_range)(vec->array, vec->count);
+}
+
+// Index of the first element of a sorted vector that isn't less than `value`, or `count` if there is none. The search
+// halves the range without branching on the comparisons.
+TDS_SIZE_T TDS_FUNCTION(lower_bound)(const TDS_TYPE* vec, const TDS_VALUE_T value) {
+    if (vec->count == 0) {
+        return 0;
+    }
+
+    const TDS_VALUE_T* base = vec->array;
+    TDS_SIZE_T length = vec->count;
+    while (length > 1) {
+        const TDS_SIZE_T half = length / 2;
+        base = TDS_VALUE_LESS(base[half], value) ? base + half : base;
+        length -= half;
+    }
+
+    return (TDS_SIZE_T)(base - vec->array) + (TDS_VALUE_LESS(*base, value) ? 1 : 0);
+}
+
+// Returns an element of a sorted vector equal to `value`, or NULL if there is none.
+TDS_VALUE_T* TDS_FUNCTION(binary_search)(const TDS_TYPE* vec, const TDS_VALUE_T value) {
+    const TDS_SIZE_T index = TDS_FUNCTION(lower_bound)(vec, value);
+    if (index == vec->count || TDS_VALUE_LESS(value, vec->array[index])) {
+        return NULL;
+    }
+
+    return vec->array + index;
+}
+
+// Removes consecutive duplicates, keeping the first of each run, so a sorted vector ends up with unique values. Returns
+// how many elements were removed.
+TDS_SIZE_T TDS_FUNCTION(unique)(TDS_TYPE* vec) {
+    if (vec->count < 2) {
+        return 0;
+    }
+
+    TDS_SIZE_T kept = 1;
+    for (TDS_SIZE_T i = 1; i < vec->count; i++) {
+        const TDS_VALUE_T* previous = &vec->array[kept - 1];
+        if (!TDS_VALUE_LESS(*previous, vec->array[i]) && !TDS_VALUE_LESS(vec->array[i], *previous)) {
+#ifdef TDS_VALUE_FINI
+            TDS_VALUE_FINI(vec->array[i]);
+#endif
+            continue;
+        }
+
+        vec->array[kept++] = vec->array[i];
+    }
+
+    const TDS_SIZE_T removed = vec->count - kept;
+    vec->count = kept;
+    return removed;
+}
+#endif
+
+#ifdef TDS_NUMERIC
+// Adds up the values in TDS_LANES separate sums, combined at the end. For floating point values, the result can differ
+// in the last bits from adding them up in order. Integers wrap around like they do in C.
+TDS_VALUE_T TDS_FUNCTION(sum)(const TDS_TYPE* vec) {
+    const TDS_VALUE_T* array = vec->array;
+    const size_t count = vec->count;
+    const size_t blocked = count - count % TDS_LANES;
+
+    TDS_VALUE_T lanes[TDS_LANES];
+    for (size_t j = 0; j < TDS_LANES; j++) {
+        lanes[j] = 0;
+    }
+    for (size_t i = 0; i < blocked; i += TDS_LANES) {
+        TDS_LANE_LOOP
+        for (size_t j = 0; j < TDS_LANES; j++) {
+            lanes[j] += array[i + j];
+        }
+    }
+
+    TDS_VALUE_T sum = 0;
+    for (size_t j = 0; j < TDS_LANES; j++) {
+        sum += lanes[j];
+    }
+    for (size_t i = blocked; i < count; i++) {
+        sum += array[i];
+    }
+    return sum;
+}
+
+// Finds the smallest and the largest value in a single pass. Returns 0 and leaves `min` and `max` alone if the vector is
+// empty. NaNs are skipped, unless the first value is one.
+char TDS_FUNCTION(min_max)(const TDS_TYPE* vec, TDS_VALUE_T* min, TDS_VALUE_T* max) {
+    if (!vec->count) {
+        return 0;
+    }
+
+    const TDS_VALUE_T* array = vec->array;
+    const size_t count = vec->count;
+    const size_t blocked = count - count % TDS_LANES;
+
+    TDS_VALUE_T lowest[TDS_LANES], highest[TDS_LANES];
+    for (size_t j = 0; j < TDS_LANES; j++) {
+        lowest[j] = highest[j] = array[0];
+    }
+    for (size_t i = 0; i < blocked; i += TDS_LANES) {
+        TDS_LANE_LOOP
+        for (size_t j = 0; j < TDS_LANES; j++) {
+            const TDS_VALUE_T value = array[i + j];
+            lowest[j] = value < lowest[j] ? value : lowest[j];
+            highest[j] = value > highest[j] ? value : highest[j];
+        }
+    }
+
+    TDS_VALUE_T low = array[0], high = array[0];
+    for (size_t j = 0; j < TDS_LANES; j++) {
+        low = lowest[j] < low ? lowest[j] : low;
+        high = highest[j] > high ? highest[j] : high;
+    }
+    for (size_t i = blocked; i < count; i++) {
+        low = array[i] < low ? array[i] : low;
+        high = array[i] > high ? array[i] : high;
+    }
+
+    *min = low;
+    *max = high;
+    return 1;
+}
+
+// Counts the values equal to `value` among `count` values, a multiple of TDS_LANES of at most TDS_COUNT_BLOCKS blocks.
+// The counters have the type of the values: comparing doubles into integer counters, or mixing widths, keeps GCC from
+// vectorizing the loop for baseline x86-64.
+static size_t TDS_FUNCTION(_count_blocks)(const TDS_VALUE_T* array, const size_t count, const TDS_VALUE_T value) {
+    TDS_VALUE_T lanes[TDS_LANES];
+    for (size_t j = 0; j < TDS_LANES; j++) {
+        lanes[j] = 0;
+    }
+    for (size_t i = 0; i < count; i += TDS_LANES) {
+        TDS_LANE_LOOP
+        for (size_t j = 0; j < TDS_LANES; j++) {
+            lanes[j] += (TDS_VALUE_T)(array[i + j] == value);
+        }
+    }
+
+    size_t matches = 0;
+    for (size_t j = 0; j < TDS_LANES; j++) {
+        matches += (size_t)lanes[j];
+    }
+    return matches;
+}
+
+TDS_SIZE_T TDS_FUNCTION(count_if_eq)(const TDS_TYPE* vec, const TDS_VALUE_T value) {
+    const TDS_VALUE_T* array = vec->array;
+    const size_t count = vec->count;
+    const size_t blocked = count - count % TDS_LANES;
+
+    size_t matches = 0;
+    for (size_t i = 0; i < blocked; i += TDS_COUNT_BLOCKS * TDS_LANES) {
+        const size_t chunk = blocked - i < TDS_COUNT_BLOCKS * TDS_LANES ? blocked - i : TDS_COUNT_BLOCKS * TDS_LANES;
+        matches += TDS_FUNCTION(_count_blocks)(array + i, chunk, value);
+    }
+    for (size_t i = blocked; i < count; i++) {
+        matches += array[i] == value;
+    }
+    return (TDS_SIZE_T)matches;
+}
+
+// Returns the first element equal to `value`, or NULL. Matches are counted TDS_FIND_BLOCKS blocks of TDS_LANES values at
+// a time, and only the blocks holding one are searched one value at a time.
+TDS_VALUE_T* TDS_FUNCTION(find)(const TDS_TYPE* vec, const TDS_VALUE_T value) {
+    TDS_VALUE_T* array = vec->array;
+    const size_t count = vec->count;
+    const size_t blocked = count - count % (TDS_FIND_BLOCKS * TDS_LANES);
+
+    size_t i = 0;
+    for (; i < blocked; i += TDS_FIND_BLOCKS * TDS_LANES) {
+        if (TDS_FUNCTION(_count_blocks)(array + i, TDS_FIND_BLOCKS * TDS_LANES, value)) {
+            break;
+        }
+    }
+
+    for (; i < count; i++) {
+        if (array[i] == value) {
+            return array + i;
+        }
+    }
+    return NULL;
+}
+
+// Appends the values for which `predicate` returns nonzero to `destination`, in order, and returns how many there were.
+// Values are copied without branching on the predicate, a block at a time. `destination` must be another vector.
+TDS_SIZE_T TDS_FUNCTION(filter_into)(
+    const TDS_TYPE* vec,
+    TDS_TYPE* destination,
+    char (*predicate)(const TDS_VALUE_T* value, void* user_data),
+    void* user_data
+) {
+    TDS_ASSERT(vec != destination);
+
+    const TDS_SIZE_T old_count = destination->count;
+    for (size_t i = 0; i < vec->count; i += TDS_LANES) {
+        const size_t block = vec->count - i < TDS_LANES ? vec->count - i : TDS_LANES;
+        if (destination->capacity - destination->count < block) {
+            const TDS_SIZE_T needed = destination->count + (TDS_SIZE_T)block;
+            TDS_FUNCTION(reserve)(destination, TDS_GROWN_CAPACITY(destination->capacity, needed));
+        }
+
+        TDS_VALUE_T* output = destination->array + destination->count;
+        size_t kept = 0;
+        for (size_t j = 0; j < block; j++) {
+            output[kept] = vec->array[i + j];
+            kept += predicate(&vec->array[i + j], user_data) != 0;
+        }
+        destination->count += (TDS_SIZE_T)kept;
+    }
+
+    return destination->count - old_count;
+}
+
+void TDS_FUNCTION(fill)(TDS_TYPE* vec, const TDS_VALUE_T value) {
+    TDS_VALUE_T* array = vec->array;
+    for (size_t i = 0; i < vec->count; i++) {
+        array[i] = value;
+    }
+}
+#endif
+
+#ifdef TDS_PARALLEL
+// Shared by the tasks of a parallel call. Task `i` covers [bounds(i), bounds(i + 1)).
+typedef struct TDS_JOIN2(TDS_TYPE, _parallel_job_t) {
+    TDS_VALUE_T* array;
+    TDS_VALUE_T* buffer;
+    size_t count, tasks;
+    void (*function)(TDS_VALUE_T* values, TDS_SIZE_T count, void* user_data);
+    TDS_VALUE_T (*reduce)(const TDS_VALUE_T* values, TDS_SIZE_T count, void* user_data);
+    TDS_VALUE_T* partials;
+    void* user_data;
+    size_t width; // Tasks per run being merged by `parallel_sort`.
+} TDS_JOIN2(TDS_TYPE, _parallel_job_t);
+
+static size_t TDS_FUNCTION(_task_begin)(const TDS_JOIN2(TDS_TYPE, _parallel_job_t)* job, const size_t task) {
+    if (task >= job->tasks) {
+        return job->count;
+    }
+
+    // The first `count % tasks` tasks get one extra element.
+    const size_t remainder = job->count % job->tasks;
+    return job->count / job->tasks * task + (task < remainder ? task : remainder);
+}
+
+static void TDS_FUNCTION(_for_each_task)(void* argument, const size_t task) {
+    const TDS_JOIN2(TDS_TYPE, _parallel_job_t)* job = argument;
+    const size_t begin = TDS_FUNCTION(_task_begin)(job, task);
+    job->function(job->array + begin, (TDS_SIZE_T)(TDS_FUNCTION(_task_begin)(job, task + 1) - begin), job->user_data);
+}
+
+// Calls `function` on consecutive chunks of the vector, concurrently, with a NULL `executor` meaning the default one.
+void TDS_FUNCTION(parallel_for_each)(
+    TDS_TYPE* vec,
+    const tds_executor_t* executor,
+    void (*function)(TDS_VALUE_T* values, TDS_SIZE_T count, void* user_data),
+    void* user_data
+) {
+    if (vec->count == 0) {
+        return;
+    }
+
+    if (!executor) {
+        executor = tds_default_executor();
+    }
+
+    TDS_JOIN2(TDS_TYPE, _parallel_job_t) job = {
+        .array = vec->array,
+        .count = vec->count,
+        .tasks = tds_parallel_task_count(executor, vec->count, 4),
+        .function = function,
+        .user_data = user_data,
+    };
+    if (job.tasks == 1) {
+        function(vec->array, vec->count, user_data);
+        return;
+    }
+
+    executor->run(executor->user_data, TDS_FUNCTION(_for_each_task), &job, job.tasks);
 }
+
+static void TDS_FUNCTION(_reduce_task)(void* argument, const size_t task) {
+    const TDS_JOIN2(TDS_TYPE, _parallel_job_t)* job = argument;
+    const size_t begin = TDS_FUNCTION(_task_begin)(job, task);
+    job->partials[task] = job->reduce(
+        job->array + begin,
+        (TDS_SIZE_T)(TDS_FUNCTION(_task_begin)(job, task + 1) - begin),
+        job->user_data);
+}
+
+// Reduces chunks of the vector with `reduce` concurrently, then reduces their results with `reduce` too, so it must
+// give the same result for a chunk as for the results of its parts, like a sum or a minimum does.
+TDS_VALUE_T TDS_FUNCTION(parallel_reduce)(
+    const TDS_TYPE* vec,
+    const tds_executor_t* executor,
+    TDS_VALUE_T (*reduce)(const TDS_VALUE_T* values, TDS_SIZE_T count, void* user_data),
+    void* user_data
+) {
+    if (!executor) {
+        executor = tds_default_executor();
+    }
+
+    TDS_JOIN2(TDS_TYPE, _parallel_job_t) job = {
+        .array = vec->array,
+        .count = vec->count,
+        .tasks = tds_parallel_task_count(executor, vec->count, 4),
+        .reduce = reduce,
+        .user_data = user_data,
+    };
+    if (job.tasks == 1) {
+        return reduce(vec->array, vec->count, user_data);
+    }
+
+    job.partials = tds_allocate(TDS_ALLOCATOR_OF(vec), job.tasks * sizeof(TDS_VALUE_T), TDS_ALIGNMENT);
+    executor->run(executor->user_data, TDS_FUNCTION(_reduce_task), &job, job.tasks);
+    const TDS_VALUE_T result = reduce(job.partials, (TDS_SIZE_T)job.tasks, user_data);
+    tds_deallocate(TDS_ALLOCATOR_OF(vec), job.partials, job.tasks * sizeof(TDS_VALUE_T), TDS_ALIGNMENT);
+    return result;
+}
+
+#ifdef TDS_SORTABLE
+static void TDS_FUNCTION(_sort_task)(void* argument, const size_t task) {
+    const TDS_JOIN2(TDS_TYPE, _parallel_job_t)* job = argument;
+    const size_t begin = TDS_FUNCTION(_task_begin)(job, task);
+    const size_t count = TDS_FUNCTION(_task_begin)(job, task + 1) - begin;
+#ifdef TDS_VALUE_ARITHMETIC
+    if (count >= TDS_RADIX_SORT_THRESHOLD && TDS_FUNCTION(_is_integer)()) {
+        TDS_FUNCTION(_radix_sort)(job->array + begin, job->buffer + begin, count);
+        return;
+    }
+#endif
+    TDS_FUNCTION(_pdqsort_range)(job->array + begin, count);
+}
+
+// Number of elements of `left` among the first `taken` elements of its merge with `right`, found by binary search over
+// the merge path so that every task can split the same merge without talking to the others. Ties take `left` first.
+static size_t TDS_FUNCTION(_co_rank)(
+    const TDS_VALUE_T* left,
+    const size_t left_count,
+    const TDS_VALUE_T* right,
+    const size_t right_count,
+    const size_t taken
+) {
+    size_t low = taken > right_count ? taken - right_count : 0;
+    size_t high = taken < left_count ? taken : left_count;
+    while (low < high) {
+        const size_t middle = low + (high - low) / 2;
+        if (!TDS_VALUE_LESS(right[taken - middle - 1], left[middle])) {
+            low = middle + 1;
+        } else {
+            high = middle;
+        }
+    }
+    return low;
+}
+
+// Writes the elements of `buffer` in the range of `task` by merging the pair of sorted runs of `width` tasks from `array`
+// that range belongs to. Every task of a round has output of its own, however few runs are left to merge.
+static void TDS_FUNCTION(_merge_task)(void* argument, const size_t task) {
+    const TDS_JOIN2(TDS_TYPE, _parallel_job_t)* job = argument;
+    const size_t pair = task / (2 * job->width);
+    const size_t begin = TDS_FUNCTION(_task_begin)(job, 2 * pair * job->width);
+    const size_t middle = TDS_FUNCTION(_task_begin)(job, (2 * pair + 1) * job->width);
+    const size_t end = TDS_FUNCTION(_task_begin)(job, (2 * pair + 2) * job->width);
+    const size_t output_begin = TDS_FUNCTION(_task_begin)(job, task) - begin;
+    const size_t output_end = TDS_FUNCTION(_task_begin)(job, task + 1) - begin;
+
+    const TDS_VALUE_T* left_run = job->array + begin;
+    const TDS_VALUE_T* right_run = job->array + middle;
+    const size_t left_count = middle - begin;
+    const size_t right_count = end - middle;
+    const size_t left_begin = TDS_FUNCTION(_co_rank)(left_run, left_count, right_run, right_count, output_begin);
+    const size_t left_end = TDS_FUNCTION(_co_rank)(left_run, left_count, right_run, right_count, output_end);
+
+    const TDS_VALUE_T* left = left_run + left_begin;
+    const TDS_VALUE_T* left_stop = left_run + left_end;
+    const TDS_VALUE_T* right = right_run + (output_begin - left_begin);
+    const TDS_VALUE_T* right_stop = right_run + (output_end - left_end);
+    TDS_VALUE_T* destination = job->buffer + begin + output_begin;
+    while (left != left_stop && right != right_stop) {
+        *destination++ = TDS_VALUE_LESS(*right, *left) ? *right++ : *left++;
+    }
+    TDS_MEMCPY(destination, left, (size_t)(left_stop - left) * sizeof(TDS_VALUE_T));
+    destination += left_stop - left;
+    TDS_MEMCPY(destination, right, (size_t)(right_stop - right) * sizeof(TDS_VALUE_T));
+}
+
+// Sorts chunks of the vector concurrently, then merges them pairwise in rounds. Every round splits its merges evenly
+// over all the tasks, so the last rounds, with few long runs, are as parallel as the first. Not stable.
+void TDS_FUNCTION(parallel_sort)(TDS_TYPE* vec, const tds_executor_t* executor) {
+    if (!executor) {
+        executor = tds_default_executor();
+    }
+
+    TDS_JOIN2(TDS_TYPE, _parallel_job_t) job = {
+        .array = vec->array,
+        .count = vec->count,
+        .tasks = tds_parallel_task_count(executor, vec->count, 1),
+    };
+    if (job.tasks == 1) {
+        TDS_FUNCTION(sort)(vec);
+        return;
+    }
+
+    TDS_VALUE_T* buffer = tds_allocate(TDS_ALLOCATOR_OF(vec), job.count * sizeof(TDS_VALUE_T), TDS_ALIGNMENT);
+    job.buffer = buffer;
+    executor->run(executor->user_data, TDS_FUNCTION(_sort_task), &job, job.tasks);
+
+    // Merging a lone run at the end is just a copy, so it needs no special case.
+    for (job.width = 1; job.width < job.tasks; job.width *= 2) {
+        executor->run(executor->user_data, TDS_FUNCTION(_merge_task), &job, job.tasks);
+
+        TDS_VALUE_T* swapped = job.array;
+        job.array = job.buffer;
+        job.buffer = swapped;
+    }
+
+    if (job.array != vec->array) {
+        TDS_MEMCPY(vec->array, job.array, job.count * sizeof(TDS_VALUE_T));
+    }
+    tds_deallocate(TDS_ALLOCATOR_OF(vec), buffer, job.count * sizeof(TDS_VALUE_T), TDS_ALIGNMENT);
+}
+#endif
+#endif
 #endif
 
 #include "private/end.inc"
+
+#undef TDS_SORTABLE
+#undef TDS_VALUE_ARITHMETIC
+#undef TDS_INSERTION_SORT_THRESHOLD
+#undef TDS_NINTHER_THRESHOLD
+#undef TDS_RADIX_SORT_THRESHOLD
+#undef TDS_PARALLEL
+#undef TDS_NUMERIC
+#undef TDS_LANES
+#undef TDS_LANE_LOOP
+#undef TDS_COUNT_BLOCKS
+#undef TDS_FIND_BLOCKS
@@ -3,6 +3,9 @@
 
 #include <munit.h>
 
+#include <tds/arena.h>
+#include <tds/slab.h>
+
 #define TDS_BIT_COUNT 1
 #include <tds/bitset.h>
 
@@ -30,6 +33,117 @@
 #define TDS_VALUE_T uint64_t
 #include <tds/vector.h>
 
+#define TDS_TYPE aligned_vec
+#define TDS_VALUE_T uint16_t
+#define TDS_ALIGNMENT 256
+#include <tds/vector.h>
+
+static unsigned vec_values_finalized;
+
+static void finalize_vec_value(const int value) {
+    (void)value;
+    vec_values_finalized++;
+}
+
+#define TDS_TYPE cleanup_vec
+#define TDS_VALUE_FINI(value) finalize_vec_value(value)
+#include <tds/vector.h>
+
+#define TDS_TYPE sorted_vec
+#define TDS_SORTABLE
+#include <tds/vector.h>
+
+#define TDS_TYPE sorted_i16
+#define TDS_VALUE_T int16_t
+#define TDS_SORTABLE
+#include <tds/vector.h>
+
+#define TDS_TYPE sorted_double
+#define TDS_VALUE_T double
+#define TDS_SORTABLE
+#include <tds/vector.h>
+
+typedef struct point_t {
+    int x, y;
+} point_t;
+
+// Sorted by `x` only, so there are plenty of elements that compare equal without being identical.
+#define TDS_TYPE point_vec
+#define TDS_VALUE_T point_t
+#define TDS_VALUE_LESS(a, b) ((a).x < (b).x)
+#include <tds/vector.h>
+
+// Small enough for the parallel paths to be taken with a few hundred elements.
+#define TDS_PARALLEL_GRAIN ((size_t)16)
+#include <tds/parallel.h>
+
+#define TDS_TYPE parallel_vec
+#define TDS_VALUE_T int64_t
+#define TDS_SORTABLE
+#define TDS_PARALLEL
+#include <tds/vector.h>
+
+#define TDS_TYPE parallel_points
+#define TDS_VALUE_T point_t
+#define TDS_VALUE_LESS(a, b) ((a).x < (b).x)
+#define TDS_PARALLEL
+#include <tds/vector.h>
+
+#define TDS_TYPE numeric_doubles
+#define TDS_VALUE_T double
+#define TDS_NUMERIC
+#include <tds/vector.h>
+
+#define TDS_TYPE numeric_bytes
+#define TDS_VALUE_T uint8_t
+#define TDS_NUMERIC
+#include <tds/vector.h>
+
+#ifndef _WIN32
+#include <tds/mapped-vector.h>
+
+#define TDS_TYPE mapped_bytes
+#define TDS_VALUE_T uint8_t
+#include <tds/mapped-vector.h>
+#endif
+
+#define TDS_TYPE particles
+#define TDS_FIELDS(X) X(float, x) X(double, y) X(uint16_t, id)
+#include <tds/soa-vector.h>
+
+#include <tds/segmented-vector.h>
+
+#define TDS_TYPE cleanup_segmented_vec
+#define TDS_SEGMENT_SHIFT 0
+#define TDS_VALUE_FINI(value) finalize_vec_value(value)
+#include <tds/segmented-vector.h>
+
+#define TDS_TYPE concurrent_ints
+#define TDS_VALUE_T int
+#define TDS_SEGMENT_SHIFT 1
+#include <tds/concurrent-vector.h>
+
+#include <tds/cow-vector.h>
+
+#define TDS_TYPE aligned_cow_vec
+#define TDS_VALUE_T double
+#define TDS_ALIGNMENT 64
+#include <tds/cow-vector.h>
+
+#include <tds/small-vector.h>
+
+static unsigned small_vec_values_finalized;
+
+static void finalize_small_vec_value(const int value) {
+    (void)value;
+    small_vec_values_finalized++;
+}
+
+#define TDS_TYPE tiny_vec
+#define TDS_INLINE_CAPACITY 2
+#define TDS_VALUE_FINI(value) finalize_small_vec_value(value)
+#include <tds/small-vector.h>
+
 #include <tds/queue.h>
 
 #define TDS_TYPE small_queue
@@ -65,6 +179,107 @@ static void finalize_queue_value(const int value) {
 
 #include <tds/set.h>
 
+#define TDS_TYPE small_set
+#define TDS_INLINE_CAPACITY 8
+#include <tds/set.h>
+
+#define TDS_TYPE small_map
+#define TDS_KEY_T int
+#define TDS_VALUE_T int
+#define TDS_INLINE_CAPACITY 8
+#include <tds/hashmap.h>
+
+// Hashes keys by parity only, so any two even or two odd keys collide.
+#define TDS_TYPE parity_map
+#define TDS_KEY_T int
+#define TDS_VALUE_T int
+#define TDS_HASH_KEY(key) ((uint64_t)(key) & 1)
+#include <tds/hashmap.h>
+
+#define TDS_TYPE cuckoo_int
+#define TDS_KEY_T int
+#define TDS_VALUE_T int
+#include <tds/cuckoo-hashmap.h>
+
+#define TDS_TYPE cuckoo_u16_to_u8
+#define TDS_KEY_T uint16_t
+#define TDS_VALUE_T uint8_t
+#define TDS_INITIAL_CAPACITY 1
+#include <tds/cuckoo-hashmap.h>
+
+#define TDS_TYPE cuckoo_same_hash
+#define TDS_HASH_KEY(key) ((uint64_t)(key) * 0)
+#include <tds/cuckoo-hashmap.h>
+
+#define TDS_KEY_T int
+#define TDS_VALUE_T int
+#include <tds/int-hashmap.h>
+
+#define TDS_TYPE int_hashmap_u32
+#define TDS_KEY_T uint32_t
+#define TDS_VALUE_T uint32_t
+#define TDS_EMPTY_KEY UINT32_MAX
+#include <tds/int-hashmap.h>
+
+#include <tds/cache.h>
+
+#define TDS_TYPE sieve_cache
+#define TDS_CACHE_SIEVE
+#include <tds/cache.h>
+
+static unsigned cache_values_finalized;
+
+static void finalize_cache_value(const int value) {
+    (void)value;
+    cache_values_finalized++;
+}
+
+#define TDS_TYPE clock_cache
+#define TDS_CACHE_CLOCK
+#define TDS_VALUE_FINI(value) finalize_cache_value(value)
+#include <tds/cache.h>
+
+#include <tds/expiring-map.h>
+
+#define TDS_TYPE coarse_expiring_map
+#define TDS_EXPIRING_TICK_SHIFT 4
+#define TDS_WHEEL_LEVELS 2
+#include <tds/expiring-map.h>
+
+#define TDS_TYPE flat_expiring_map
+#define TDS_WHEEL_LEVELS 1
+#include <tds/expiring-map.h>
+
+#include <tds/filter.h>
+
+#define TDS_XOR_FILTER
+#include <tds/filter.h>
+
+#include <keywords.h>
+#include <opcodes.h>
+#include <ids.h>
+#include <offsets.h>
+
+#define TDS_TYPE counted_vec
+#define TDS_ALLOCATOR
+#include <tds/vector.h>
+
+#define TDS_TYPE counted_queue
+#define TDS_ALLOCATOR
+#include <tds/queue.h>
+
+#define TDS_TYPE counted_hashmap
+#define TDS_ALLOCATOR
+#include <tds/hashmap.h>
+
+#define TDS_TYPE counted_set
+#define TDS_ALLOCATOR
+#include <tds/set.h>
+
+#define TDS_TYPE counted_pool
+#define TDS_ALLOCATOR
+#include <tds/dense-pool.h>
+
 #ifndef TESTS_NO_STATIC_ASSERT
 #include <assert.h>
 
@@ -424,158 +639,1879 @@ static MunitResult count(const MunitParameter* params, void* fixture) {
     return MUNIT_OK;
 }
 
-static MunitResult queue_fifo_and_wrap(const MunitParameter* params, void* fixture) {
+static MunitResult set_algebra(const MunitParameter* params, void* fixture) {
     (void)params;
-    test_data_structures_t* data_structures = fixture;
-    queue_int* queue = &data_structures->int_queue;
+    (void)fixture;
 
-    munit_assert_uint32(queue_int_count(queue), ==, 0);
-    munit_assert_null(queue_int_front(queue));
+    // Small random sets checked against bit masks of the same values.
+    uint64_t mask_a = 0, mask_b = 0;
+    set_int a = { 0 }, b = { 0 }, result = { 0 };
+    const int count_a = munit_rand_int_range(0, 48), count_b = munit_rand_int_range(0, 48);
+    for (int i = 0; i < count_a; i++) {
+        const int value = munit_rand_int_range(0, 63);
+        set_int_add(&a, value);
+        mask_a |= (uint64_t)1 << value;
+    }
+    for (int i = 0; i < count_b; i++) {
+        const int value = munit_rand_int_range(0, 63);
+        set_int_add(&b, value);
+        mask_b |= (uint64_t)1 << value;
+    }
 
-    queue_int_reserve(queue, 4);
-    for (int i = 0; i < 4; i++) {
-        queue_int_push(queue, i);
+    set_int_union_into(&result, &a, &b);
+    for (int i = 0; i < 64; i++) {
+        munit_assert_int(set_int_contains(&result, i), ==, !!((mask_a | mask_b) & (uint64_t)1 << i));
     }
-    munit_assert_int(queue_int_pop(queue), ==, 0);
-    munit_assert_int(queue_int_pop(queue), ==, 1);
 
-    queue_int_push(queue, 4);
-    queue_int_push(queue, 5);
-    munit_assert_uint32(queue->capacity, ==, 4);
-    munit_assert_uint32(queue->head, ==, 2);
-    for (int expected = 2; expected < 6; expected++) {
-        munit_assert_int(*queue_int_front(queue), ==, expected);
-        munit_assert_int(queue_int_pop(queue), ==, expected);
+    set_int_intersect_into(&result, &a, &b);
+    for (int i = 0; i < 64; i++) {
+        munit_assert_int(set_int_contains(&result, i), ==, !!((mask_a & mask_b) & (uint64_t)1 << i));
+    }
+    munit_assert_uint32(set_int_intersection_count(&a, &b), ==, set_int_count(&result));
+    munit_assert_uint32(set_int_intersection_count(&b, &a), ==, set_int_count(&result));
+    munit_assert_true(set_int_is_subset(&result, &a));
+    munit_assert_true(set_int_is_subset(&result, &b));
+    munit_assert_int(set_int_is_subset(&a, &b), ==, (mask_a & ~mask_b) == 0);
+
+    set_int_difference_into(&result, &a, &b);
+    for (int i = 0; i < 64; i++) {
+        munit_assert_int(set_int_contains(&result, i), ==, !!((mask_a & ~mask_b) & (uint64_t)1 << i));
+    }
+    set_int_difference_into(&result, &b, &a);
+    for (int i = 0; i < 64; i++) {
+        munit_assert_int(set_int_contains(&result, i), ==, !!((mask_b & ~mask_a) & (uint64_t)1 << i));
     }
 
-    munit_assert_null(queue_int_front(queue));
-    munit_assert_uint32(queue_int_count(queue), ==, 0);
+    // The destination of a union may be one of its operands.
+    set_int_union_into(&a, &a, &b);
+    for (int i = 0; i < 64; i++) {
+        munit_assert_int(set_int_contains(&a, i), ==, !!((mask_a | mask_b) & (uint64_t)1 << i));
+    }
+    munit_assert_true(set_int_is_subset(&b, &a));
+
+    set_int_fini(&a);
+    set_int_fini(&b);
+    set_int_fini(&result);
     return MUNIT_OK;
 }
 
-static MunitResult queue_growth_and_storage(const MunitParameter* params, void* fixture) {
+static MunitResult inline_storage(const MunitParameter* params, void* fixture) {
     (void)params;
     test_data_structures_t* data_structures = fixture;
-    small_queue* queue = &data_structures->small_queue;
 
-    for (uint16_t i = 0; i < 4; i++) {
-        small_queue_push(queue, i);
+    // Random operations mirrored on containers without inline storage.
+    small_set set = { 0 };
+    small_map map = { 0 };
+    for (int i = 0; i < 64; i++) {
+        const int value = munit_rand_int_range(0, 15);
+        if (munit_rand_int_range(0, 3) == 0) {
+            munit_assert_int(small_set_remove(&set, value), ==, set_int_remove(&data_structures->int_set, value));
+            munit_assert_int(small_map_remove(&map, value), ==, hashmap_int_int_remove(&data_structures->int_hashmap, value));
+        } else {
+            munit_assert_int(small_set_add(&set, value), ==, set_int_add(&data_structures->int_set, value));
+            munit_assert_int(small_map_set(&map, value, i), ==, hashmap_int_int_set(&data_structures->int_hashmap, value, i));
+        }
+
+        munit_assert_uint32(small_set_count(&set), ==, set_int_count(&data_structures->int_set));
+        munit_assert_uint32(small_map_count(&map), ==, hashmap_int_int_count(&data_structures->int_hashmap));
+        for (int j = 0; j < 16; j++) {
+            munit_assert_int(small_set_contains(&set, j), ==, set_int_contains(&data_structures->int_set, j));
+            const int* expected = hashmap_int_int_get(&data_structures->int_hashmap, j);
+            const int* value = small_map_get(&map, j);
+            munit_assert_int(!value, ==, !expected);
+            if (value) {
+                munit_assert_int(*value, ==, *expected);
+            }
+        }
+
+        // Iteration sees every entry exactly once.
+        unsigned seen = 0;
+        small_map_iter_t it = small_map_iter(&map);
+        while (small_map_next(&it)) {
+            munit_assert_int(*it.value, ==, *hashmap_int_int_get(&data_structures->int_hashmap, it.key));
+            seen++;
+        }
+        munit_assert_uint32(seen, ==, small_map_count(&map));
+
+        // Nothing is allocated until the inline storage overflows, and reclaiming moves small containers back into it.
+        if (small_set_count(&set) <= 8) {
+            small_set_reclaim(&set);
+            munit_assert_null(set.buckets);
+        }
+        if (small_map_count(&map) <= 8) {
+            small_map_reclaim(&map);
+            munit_assert_null(map.buckets);
+        }
     }
-    munit_assert_uint8(queue->capacity, ==, 4);
-    small_queue_push(queue, 4);
-    munit_assert_uint8(queue->capacity, ==, 8);
-    munit_assert_uint8(queue->head, ==, 0);
 
-    munit_assert_uint16(small_queue_pop(queue), ==, 0);
-    munit_assert_uint16(small_queue_pop(queue), ==, 1);
-    for (uint16_t i = 5; i < 10; i++) {
-        small_queue_push(queue, i);
+    // Set operations across inline and spilled operands.
+    small_set few = { 0 }, many = { 0 }, result = { 0 };
+    for (int i = 0; i < 4; i++) {
+        small_set_add(&few, i * 4);
     }
-    munit_assert_uint8(queue->head, ==, 2);
-    small_queue_push(queue, 10);
-    munit_assert_uint8(queue->capacity, ==, 16);
-    munit_assert_uint8(queue->head, ==, 0);
-    for (uint16_t expected = 2; expected <= 10; expected++) {
-        munit_assert_uint16(small_queue_pop(queue), ==, expected);
+    for (int i = 0; i < 32; i++) {
+        small_set_add(&many, i);
     }
+    munit_assert_null(few.buckets);
+    munit_assert_not_null(many.buckets);
+    munit_assert_true(small_set_is_subset(&few, &many));
+    munit_assert_uint32(small_set_intersection_count(&few, &many), ==, 4);
+    small_set_intersect_into(&result, &many, &few);
+    munit_assert_uint32(small_set_count(&result), ==, 4);
+    small_set_difference_into(&result, &many, &few);
+    munit_assert_uint32(small_set_count(&result), ==, 28);
+    munit_assert_false(small_set_contains(&result, 8));
+    small_set_union_into(&few, &few, &many);
+    munit_assert_uint32(small_set_count(&few), ==, 32);
+
+    small_set_fini(&set);
+    small_set_fini(&few);
+    small_set_fini(&many);
+    small_set_fini(&result);
+    small_map_fini(&map);
+    return MUNIT_OK;
+}
 
-    small_queue_reserve(queue, 12);
-    small_queue_push(queue, 20);
-    small_queue_push(queue, 21);
-    small_queue_reclaim(queue);
-    munit_assert_uint8(queue->capacity, ==, 2);
-    munit_assert_uint8(queue->head, ==, 0);
-    munit_assert_uint16(small_queue_pop(queue), ==, 20);
-    munit_assert_uint16(small_queue_pop(queue), ==, 21);
-    small_queue_reclaim(queue);
-    munit_assert_null(queue->array);
-    munit_assert_uint8(queue->capacity, ==, 0);
+static MunitResult cuckoo_hashmap(const MunitParameter* params, void* fixture) {
+    (void)params;
+    test_data_structures_t* data_structures = fixture;
+
+    // Buckets are padded so that none straddles two cache lines.
+    munit_assert_size(sizeof(cuckoo_int_bucket), ==, 64);
+    munit_assert_size(sizeof(cuckoo_u16_to_u8_bucket), ==, 16);
+
+    // Random operations mirrored on a Robin Hood hash map.
+    cuckoo_int map = { 0 };
+    for (int i = 0; i < 128; i++) {
+        const int key = munit_rand_int_range(0, 127);
+        if (munit_rand_int_range(0, 3) == 0) {
+            munit_assert_int(cuckoo_int_remove(&map, key), ==, hashmap_int_int_remove(&data_structures->int_hashmap, key));
+        } else {
+            munit_assert_int(cuckoo_int_set(&map, key, i), ==, hashmap_int_int_set(&data_structures->int_hashmap, key, i));
+        }
+    }
+
+    munit_assert_uint32(cuckoo_int_count(&map), ==, hashmap_int_int_count(&data_structures->int_hashmap));
+    for (int key = 0; key < 128; key++) {
+        const int* expected = hashmap_int_int_get(&data_structures->int_hashmap, key);
+        const int* value = cuckoo_int_get(&map, key);
+        munit_assert_int(!value, ==, !expected);
+        if (value) {
+            munit_assert_int(*value, ==, *expected);
+        }
+    }
+
+    unsigned seen = 0;
+    cuckoo_int_iter_t it = cuckoo_int_iter(&map);
+    while (cuckoo_int_next(&it)) {
+        munit_assert_int(*it.value, ==, *hashmap_int_int_get(&data_structures->int_hashmap, it.key));
+        seen++;
+    }
+    munit_assert_uint32(seen, ==, cuckoo_int_count(&map));
+
+    cuckoo_int_reclaim(&map);
+    munit_assert_uint32(cuckoo_int_count(&map), ==, seen);
+    cuckoo_int_clear(&map);
+    munit_assert_null(cuckoo_int_get(&map, 0));
+    cuckoo_int_fini(&map);
+
+    // Filling a table that starts with a single bucket goes through evictions, the stash and many rehashes.
+    cuckoo_u16_to_u8 small = { 0 };
+    const uint16_t offset = (uint16_t)munit_rand_int_range(0, 1 << 15);
+    for (uint16_t i = 0; i < 300; i++) {
+        munit_assert_true(cuckoo_u16_to_u8_set(&small, (uint16_t)(offset + i), (uint8_t)i));
+    }
+    for (uint16_t i = 0; i < 300; i++) {
+        munit_assert_uint8(*cuckoo_u16_to_u8_get(&small, (uint16_t)(offset + i)), ==, (uint8_t)i);
+    }
+    munit_assert_uint32(cuckoo_u16_to_u8_count(&small), ==, 300);
+    cuckoo_u16_to_u8_fini(&small);
+
+    // Keys that all share a hash overflow their two buckets into the stash, which grows instead of the table.
+    cuckoo_same_hash same = { 0 };
+    for (int i = 0; i < 100; i++) {
+        munit_assert_true(cuckoo_same_hash_set(&same, i, -i));
+    }
+    munit_assert_uint32(same.bucket_count, <=, 64);
+    for (int i = 0; i < 100; i += 2) {
+        munit_assert_true(cuckoo_same_hash_remove(&same, i));
+    }
+    munit_assert_uint32(cuckoo_same_hash_count(&same), ==, 50);
+    cuckoo_same_hash_reclaim(&same);
+    for (int i = 0; i < 100; i++) {
+        const int* value = cuckoo_same_hash_get(&same, i);
+        munit_assert_int(!value, ==, i % 2 == 0);
+        munit_assert_true(!value || *value == -i);
+    }
+    cuckoo_same_hash_fini(&same);
 
-    small_queue_push(queue, 30);
-    small_queue_clear(queue);
-    munit_assert_uint8(queue->count, ==, 0);
-    munit_assert_not_null(queue->array);
     return MUNIT_OK;
 }
 
-static MunitResult queue_cleanup(const MunitParameter* params, void* fixture) {
+static MunitResult frozen_hashmap(const MunitParameter* params, void* fixture) {
     (void)params;
     test_data_structures_t* data_structures = fixture;
-    cleanup_queue* queue = &data_structures->cleanup_queue;
 
-    queue_values_finalized = 0;
-    cleanup_queue_push(queue, 1);
-    cleanup_queue_push(queue, 2);
-    cleanup_queue_push(queue, 3);
-    munit_assert_int(cleanup_queue_pop(queue), ==, 1);
-    munit_assert_uint(queue_values_finalized, ==, 0);
-    cleanup_queue_clear(queue);
-    munit_assert_uint(queue_values_finalized, ==, 2);
+    hashmap_int_int_frozen_t frozen = { 0 };
+    munit_assert_true(hashmap_int_int_freeze(&data_structures->int_hashmap, &frozen));
+    munit_assert_uint32(hashmap_int_int_frozen_count(&frozen), ==, 0);
+    munit_assert_null(hashmap_int_int_frozen_get(&frozen, 0));
+
+    const int count = munit_rand_int_range(1, 300);
+    for (int i = 0; i < count; i++) {
+        hashmap_int_int_set(&data_structures->int_hashmap, munit_rand_int_range(0, 1000), i);
+    }
+    // Freezing again releases the previous table.
+    munit_assert_true(hashmap_int_int_freeze(&data_structures->int_hashmap, &frozen));
+    munit_assert_uint32(hashmap_int_int_frozen_count(&frozen), ==, hashmap_int_int_count(&data_structures->int_hashmap));
+
+    int keys[100];
+    int* values[100];
+    for (int i = 0; i < 100; i++) {
+        keys[i] = i * 10 + munit_rand_int_range(0, 9);
+    }
+    hashmap_int_int_frozen_get_many(&frozen, keys, 100, values);
+    for (int i = 0; i < 100; i++) {
+        const int* expected = hashmap_int_int_get(&data_structures->int_hashmap, keys[i]);
+        munit_assert_int(!values[i], ==, !expected);
+        munit_assert_ptr_equal(values[i], hashmap_int_int_frozen_get(&frozen, keys[i]));
+        if (expected) {
+            munit_assert_int(*values[i], ==, *expected);
+        }
+    }
+    hashmap_int_int_frozen_fini(&frozen);
+
+    // Maps still in inline storage can be frozen too.
+    small_map map = { 0 };
+    small_map_frozen_t small_frozen = { 0 };
+    for (int i = 0; i < 5; i++) {
+        small_map_set(&map, i * 3, i);
+    }
+    small_map_freeze(&map, &small_frozen);
+    for (int i = 0; i < 15; i++) {
+        const int* value = small_map_frozen_get(&small_frozen, i);
+        munit_assert_int(!value, ==, i % 3 != 0);
+        if (value) {
+            munit_assert_int(*value, ==, i / 3);
+        }
+    }
+    small_map_frozen_fini(&small_frozen);
+    small_map_fini(&map);
+
+    // Keys with equal hashes can't be separated, so freezing them fails and leaves the table empty.
+    parity_map parity = { 0 };
+    parity_map_frozen_t parity_frozen = { 0 };
+    parity_map_set(&parity, 1, 1);
+    parity_map_set(&parity, 2, 2);
+    munit_assert_true(parity_map_freeze(&parity, &parity_frozen));
+    munit_assert_int(*parity_map_frozen_get(&parity_frozen, 2), ==, 2);
+    parity_map_set(&parity, 4, 4);
+    munit_assert_false(parity_map_freeze(&parity, &parity_frozen));
+    munit_assert_uint32(parity_map_frozen_count(&parity_frozen), ==, 0);
+    munit_assert_null(parity_map_frozen_get(&parity_frozen, 2));
+    parity_map_frozen_fini(&parity_frozen);
+    parity_map_fini(&parity);
 
-    cleanup_queue_push(queue, 4);
-    cleanup_queue_push(queue, 5);
-    cleanup_queue_fini(queue);
-    munit_assert_uint(queue_values_finalized, ==, 4);
     return MUNIT_OK;
 }
 
-static MunitResult bitset(const MunitParameter* params, void* fixture) {
+static MunitResult perfect_hash_table(const MunitParameter* params, void* fixture) {
     (void)params;
     (void)fixture;
 
-    bitset_1_t one = { 0 };
-    munit_assert_false(bitset_1_t_any(&one));
-    munit_assert_true(bitset_1_t_none(&one));
-    munit_assert_false(bitset_1_t_get(&one, 0));
-    bitset_1_t_set_all(&one);
-    munit_assert_true(bitset_1_t_any(&one));
-    munit_assert_false(bitset_1_t_none(&one));
-    munit_assert_true(bitset_1_t_get(&one, 0));
-    bitset_1_t_clear(&one, 0);
-    munit_assert_false(bitset_1_t_any(&one));
-    munit_assert_true(bitset_1_t_none(&one));
+    munit_assert_uint32(keywords_count(), ==, 35);
+    munit_assert_string_equal(*keywords_get("while"), "WHILE");
+    munit_assert_string_equal(*keywords_get("_Bool"), "BOOL");
+    munit_assert_null(keywords_get("whilst"));
+    munit_assert_null(keywords_get(""));
 
-    bitset_64_t exact_word = { 0 };
-    bitset_64_t_set(&exact_word, 0);
-    bitset_64_t_set(&exact_word, 63);
-    munit_assert_true(bitset_64_t_get(&exact_word, 0));
-    munit_assert_true(bitset_64_t_get(&exact_word, 63));
-    bitset_64_t_clear_all(&exact_word);
-    munit_assert_false(bitset_64_t_any(&exact_word));
-    munit_assert_true(bitset_64_t_none(&exact_word));
+    static const uint16_t lengths[][2] = { { 0x00, 1 }, { 0x01, 3 }, { 0x3e, 2 }, { 0xfe, 2 } };
+    for (size_t i = 0; i < TDS_COUNTOF(lengths); i++) {
+        munit_assert_uint8(*opcodes_get(lengths[i][0]), ==, lengths[i][1]);
+    }
+    unsigned found = 0;
+    for (unsigned opcode = 0; opcode < 0x200; opcode++) {
+        found += opcodes_get((uint16_t)opcode) != NULL;
+    }
+    munit_assert_uint(found, ==, opcodes_count());
 
-    bitset_65_t across_words = { 0 };
-    bitset_65_t_set(&across_words, 63);
-    bitset_65_t_set(&across_words, 64);
-    munit_assert_true(bitset_65_t_get(&across_words, 63));
-    munit_assert_true(bitset_65_t_get(&across_words, 64));
-    bitset_65_t_clear(&across_words, 63);
-    munit_assert_false(bitset_65_t_get(&across_words, 63));
-    munit_assert_true(bitset_65_t_any(&across_words));
-    munit_assert_false(bitset_65_t_none(&across_words));
+    // Keys are hashed as their key type, so unsigned keys past INT64_MAX and negative signed ones are found.
+    munit_assert_int(*ids_get(UINT64_MAX), ==, 3);
+    munit_assert_int(*ids_get((uint64_t)1 << 63), ==, 2);
+    munit_assert_null(ids_get(1));
+    munit_assert_int(*offsets_get(-128), ==, 128);
+    munit_assert_int(*offsets_get(-1), ==, 1);
+    munit_assert_null(offsets_get(1));
 
-    bitset_65_t_set_all(&across_words);
-    for (uint32_t i = 0; i < 65; i++) {
-        munit_assert_true(bitset_65_t_get(&across_words, i));
-        bitset_65_t_clear(&across_words, i);
+    return MUNIT_OK;
+}
+
+static MunitResult int_hashmap(const MunitParameter* params, void* fixture) {
+    (void)params;
+    test_data_structures_t* data_structures = fixture;
+
+    // Random operations over a small key range, so that clusters form and removals shift them, mirrored on a Robin
+    // Hood hash map. Zero is the empty key and can't be stored.
+    int_hashmap_int_int map = { 0 };
+    for (int i = 0; i < 256; i++) {
+        const int key = munit_rand_int_range(1, 64);
+        if (munit_rand_int_range(0, 2) == 0) {
+            munit_assert_int(int_hashmap_int_int_remove(&map, key), ==, hashmap_int_int_remove(&data_structures->int_hashmap, key));
+        } else {
+            munit_assert_int(int_hashmap_int_int_set(&map, key, i), ==, hashmap_int_int_set(&data_structures->int_hashmap, key, i));
+        }
     }
-    munit_assert_false(bitset_65_t_any(&across_words));
-    munit_assert_true(bitset_65_t_none(&across_words));
 
-    small_bitset small = { 0 };
-    small_bitset_set_all(&small);
-    for (uint32_t i = 0; i < 10; i++) {
-        munit_assert_true(small_bitset_get(&small, i));
-        small_bitset_clear(&small, i);
+    munit_assert_uint32(int_hashmap_int_int_count(&map), ==, hashmap_int_int_count(&data_structures->int_hashmap));
+    for (int key = 0; key <= 64; key++) {
+        const int* expected = hashmap_int_int_get(&data_structures->int_hashmap, key);
+        const int* value = int_hashmap_int_int_get(&map, key);
+        munit_assert_int(!value, ==, !expected);
+        if (value) {
+            munit_assert_int(*value, ==, *expected);
+        }
     }
-    munit_assert_false(small_bitset_any(&small));
-    munit_assert_true(small_bitset_none(&small));
+    munit_assert_int(int_hashmap_int_int_remove(&map, 0), ==, 0);
+
+    unsigned seen = 0;
+    int_hashmap_int_int_iter_t it = int_hashmap_int_int_iter(&map);
+    while (int_hashmap_int_int_next(&it)) {
+        munit_assert_int(*it.value, ==, *hashmap_int_int_get(&data_structures->int_hashmap, it.key));
+        seen++;
+    }
+    munit_assert_uint32(seen, ==, int_hashmap_int_int_count(&map));
+
+    int_hashmap_int_int_reclaim(&map);
+    munit_assert_uint32(int_hashmap_int_int_count(&map), ==, seen);
+    int_hashmap_int_int_clear(&map);
+    munit_assert_null(int_hashmap_int_int_get(&map, 1));
+    int_hashmap_int_int_fini(&map);
+
+    // With another empty key, zero is an ordinary key. Slots are two words.
+    munit_assert_size(sizeof(int_hashmap_u32_entry), ==, 8);
+    int_hashmap_u32 wide = { 0 };
+    for (uint32_t i = 0; i < 200; i++) {
+        munit_assert_true(int_hashmap_u32_set(&wide, i * 7, i));
+    }
+    for (uint32_t i = 0; i < 200; i += 2) {
+        munit_assert_true(int_hashmap_u32_remove(&wide, i * 7));
+    }
+    for (uint32_t i = 0; i < 200; i++) {
+        const uint32_t* value = int_hashmap_u32_get(&wide, i * 7);
+        munit_assert_int(!value, ==, i % 2 == 0);
+        if (value) {
+            munit_assert_uint32(*value, ==, i);
+        }
+    }
+    munit_assert_uint32(int_hashmap_u32_count(&wide), ==, 100);
+    int_hashmap_u32_fini(&wide);
 
     return MUNIT_OK;
 }
 
-#define TDS_TEST(fun) {\
-    .name = "/"#fun,\
+static MunitResult cache(const MunitParameter* params, void* fixture) {
+    (void)params;
+    (void)fixture;
+
+    // LRU evicts the least recently used key. Peeking doesn't count as a use.
+    cache_int_int lru = { 0 };
+    cache_int_int_reserve(&lru, 3);
+    for (int key = 1; key <= 3; key++) {
+        munit_assert_true(cache_int_int_set(&lru, key, key * 10));
+    }
+    munit_assert_int(*cache_int_int_get(&lru, 1), ==, 10);
+    munit_assert_int(*cache_int_int_peek(&lru, 2), ==, 20);
+    munit_assert_true(cache_int_int_set(&lru, 4, 40));
+    munit_assert_null(cache_int_int_peek(&lru, 2));
+    munit_assert_false(cache_int_int_set(&lru, 3, 31));
+    munit_assert_true(cache_int_int_set(&lru, 5, 50));
+    munit_assert_null(cache_int_int_peek(&lru, 1));
+    munit_assert_int(*cache_int_int_peek(&lru, 3), ==, 31);
+    munit_assert_uint32(cache_int_int_count(&lru), ==, 3);
+    cache_int_int_fini(&lru);
+
+    // SIEVE gives used keys a second chance and keeps the hand where it stopped.
+    sieve_cache sieve = { 0 };
+    sieve_cache_reserve(&sieve, 3);
+    for (int key = 1; key <= 3; key++) {
+        sieve_cache_set(&sieve, key, key);
+    }
+    sieve_cache_get(&sieve, 1);
+    sieve_cache_set(&sieve, 4, 4);
+    munit_assert_null(sieve_cache_peek(&sieve, 2));
+    sieve_cache_set(&sieve, 5, 5);
+    munit_assert_null(sieve_cache_peek(&sieve, 3));
+    munit_assert_not_null(sieve_cache_peek(&sieve, 1));
+    munit_assert_not_null(sieve_cache_peek(&sieve, 4));
+
+    // Random operations never exceed the capacity and keep the index and the queue in sync.
+    for (int i = 0; i < 200; i++) {
+        const int key = munit_rand_int_range(0, 15);
+        const int operation = munit_rand_int_range(0, 3);
+        if (operation == 0) {
+            sieve_cache_remove(&sieve, key);
+        } else if (operation == 1) {
+            const int* value = sieve_cache_get(&sieve, key);
+            if (value) {
+                munit_assert_int(*value, ==, key);
+            }
+        } else {
+            sieve_cache_set(&sieve, key, key);
+        }
+        munit_assert_uint32(sieve_cache_count(&sieve), <=, 3);
+    }
+    unsigned seen = 0;
+    sieve_cache_iter_t it = sieve_cache_iter(&sieve);
+    while (sieve_cache_next(&it)) {
+        munit_assert_int(*it.value, ==, it.key);
+        seen++;
+    }
+    munit_assert_uint32(seen, ==, sieve_cache_count(&sieve));
+    sieve_cache_fini(&sieve);
+
+    // CLOCK puts new keys in place of the evicted ones. Evicted values are finalized.
+    clock_cache clock = { 0 };
+    cache_values_finalized = 0;
+    clock_cache_reserve(&clock, 3);
+    for (int key = 1; key <= 3; key++) {
+        clock_cache_set(&clock, key, key);
+    }
+    clock_cache_get(&clock, 1);
+    clock_cache_get(&clock, 2);
+    clock_cache_set(&clock, 4, 4);
+    munit_assert_null(clock_cache_peek(&clock, 3));
+    clock_cache_set(&clock, 5, 5);
+    munit_assert_null(clock_cache_peek(&clock, 1));
+    munit_assert_uint(cache_values_finalized, ==, 2);
+    munit_assert_true(clock_cache_remove(&clock, 2));
+    munit_assert_uint(cache_values_finalized, ==, 3);
+    munit_assert_true(clock_cache_set(&clock, 6, 6));
+    munit_assert_uint32(clock_cache_count(&clock), ==, 3);
+    clock_cache_clear(&clock);
+    munit_assert_uint(cache_values_finalized, ==, 6);
+    munit_assert_uint32(clock_cache_capacity(&clock), ==, 3);
+    clock_cache_fini(&clock);
+
+    return MUNIT_OK;
+}
+
+static MunitResult expiring_map(const MunitParameter* params, void* fixture) {
+    (void)params;
+    (void)fixture;
+
+    expiring_map_int_int map = { 0 };
+    for (int key = 1; key <= 10; key++) {
+        munit_assert_true(expiring_map_int_int_set(&map, key, key));
+        munit_assert_true(expiring_map_int_int_set_ttl(&map, key, (uint64_t)key));
+    }
+    munit_assert_false(expiring_map_int_int_set_ttl(&map, 11, 1));
+    munit_assert_uint32(expiring_map_int_int_advance(&map, 5), ==, 5);
+    munit_assert_null(expiring_map_int_int_get(&map, 5));
+    munit_assert_int(*expiring_map_int_int_get(&map, 6), ==, 6);
+    munit_assert_uint32(expiring_map_int_int_advance(&map, 6), ==, 1);
+    munit_assert_uint32(expiring_map_int_int_count(&map), ==, 4);
+
+    // Times far beyond the wheel wait in the overflow list.
+    munit_assert_true(expiring_map_int_int_set(&map, 100, 100));
+    munit_assert_true(expiring_map_int_int_set_ttl(&map, 100, (uint64_t)1 << 30));
+    munit_assert_uint32(expiring_map_int_int_advance(&map, ((uint64_t)1 << 30) + 5), ==, 4);
+    munit_assert_uint32(expiring_map_int_int_advance(&map, ((uint64_t)1 << 30) + 6), ==, 1);
+    munit_assert_uint32(expiring_map_int_int_count(&map), ==, 0);
+    expiring_map_int_int_fini(&map);
+
+    // Random time to live and clock steps, some beyond the two levels of the wheel, checked against the expiry times.
+    coarse_expiring_map coarse = { 0 };
+    uint64_t expiries[32] = { 0 };
+    uint64_t now = 0;
+    for (int round = 0; round < 60; round++) {
+        const int key = munit_rand_int_range(0, 31);
+        coarse_expiring_map_set(&coarse, key, key);
+        const uint64_t ttl = (uint64_t)munit_rand_int_range(1, 100000);
+        munit_assert_true(coarse_expiring_map_set_ttl(&coarse, key, ttl));
+        expiries[key] = now + ttl;
+
+        now += (uint64_t)munit_rand_int_range(0, 4000);
+        coarse_expiring_map_advance(&coarse, now);
+        // Expired entries are removed on the first 16-unit tick boundary after their expiry time.
+        unsigned kept = 0;
+        for (int i = 0; i < 32; i++) {
+            kept += expiries[i] && ((expiries[i] - 1) >> 4) + 1 > now >> 4;
+        }
+        munit_assert_uint32(coarse_expiring_map_count(&coarse), ==, kept);
+        for (int i = 0; i < 32; i++) {
+            const int* value = coarse_expiring_map_get(&coarse, i);
+            munit_assert_int(!value, ==, !expiries[i] || expiries[i] <= now);
+            if (!value) {
+                // Removed now if it wasn't already.
+                expiries[i] = 0;
+            }
+        }
+    }
+    coarse_expiring_map_fini(&coarse);
+
+    // Expired entries can be looked up lazily before `advance` removes them.
+    coarse = (coarse_expiring_map){ 0 };
+    coarse_expiring_map_set(&coarse, 1, 1);
+    coarse_expiring_map_set_ttl(&coarse, 1, 17);
+    munit_assert_uint32(coarse_expiring_map_advance(&coarse, 17), ==, 0);
+    munit_assert_uint32(coarse_expiring_map_count(&coarse), ==, 1);
+    munit_assert_null(coarse_expiring_map_get(&coarse, 1));
+    munit_assert_uint32(coarse_expiring_map_count(&coarse), ==, 0);
+    coarse_expiring_map_fini(&coarse);
+
+    // Overflow entries are picked up in the turn they're due in, so a one-level wheel skips the empty turns between.
+    flat_expiring_map flat = { 0 };
+    const uint64_t far = (uint64_t)1 << 50;
+    for (int key = 0; key < 4; key++) {
+        flat_expiring_map_set(&flat, key, key);
+        munit_assert_true(flat_expiring_map_set_ttl(&flat, key, far * (uint64_t)(key + 1) + (uint64_t)key));
+    }
+    munit_assert_true(flat_expiring_map_remove(&flat, 0));
+    munit_assert_uint32(flat_expiring_map_advance(&flat, far * 2), ==, 0);
+    munit_assert_uint32(flat_expiring_map_advance(&flat, far * 2 + 1), ==, 1);
+    munit_assert_uint32(flat_expiring_map_advance(&flat, far * 4 + 3), ==, 2);
+    munit_assert_uint32(flat_expiring_map_count(&flat), ==, 0);
+    flat_expiring_map_fini(&flat);
+
+    return MUNIT_OK;
+}
+
+static MunitResult vector_growth(const MunitParameter* params, void* fixture) {
+    (void)params;
+    test_data_structures_t* data_structures = fixture;
+    vec_int* vec = &data_structures->int_vec;
+
+    vec_int_append(vec, 0);
+    munit_assert_uint32(vec->capacity, ==, 4);
+
+    // Growth is geometric, so filling the vector only reallocates a logarithmic number of times.
+    unsigned reallocations = 0;
+    for (int i = 1; i < 10000; i++) {
+        const uint32_t capacity = vec->capacity;
+        vec_int_append(vec, i);
+        reallocations += vec->capacity != capacity;
+        munit_assert_uint32(vec->capacity, >=, vec->count);
+    }
+    munit_assert_uint(reallocations, <=, 24);
+    for (int i = 0; i < 10000; i++) {
+        munit_assert_int(vec_int_get(vec, i), ==, i);
+    }
+
+    // A `grow` bigger than the growth factor gets exactly what it asked for.
+    vec_int_clear(vec);
+    vec_int_reclaim(vec);
+    vec_int_grow(vec, 1000);
+    munit_assert_uint32(vec->capacity, ==, 1000);
+
+    // `reserve` is exact.
+    vec_int_reserve(vec, 1234);
+    munit_assert_uint32(vec->capacity, ==, 1234);
+    vec_int_reserve(vec, 10);
+    munit_assert_uint32(vec->capacity, ==, 1234);
+
+    // Growth saturates at the largest representable size.
+    vec_uint16_t* small = &data_structures->uint16_vec;
+    for (int8_t i = 0; i < INT8_MAX; i++) {
+        vec_uint16_t_append(small, (uint16_t)i);
+    }
+    munit_assert_int8(small->count, ==, INT8_MAX);
+    munit_assert_int8(small->capacity, ==, INT8_MAX);
+    munit_assert_uint16(vec_uint16_t_get(small, INT8_MAX - 1), ==, INT8_MAX - 1);
+
+    return MUNIT_OK;
+}
+
+static char is_even(const int* value, void* user_data) {
+    (*(unsigned*)user_data)++;
+    return *value % 2 == 0;
+}
+
+static MunitResult vector_insertion(const MunitParameter* params, void* fixture) {
+    (void)params;
+    test_data_structures_t* data_structures = fixture;
+    vec_int* vec = &data_structures->int_vec;
+
+    // Checked against a plain array with the same operations applied by hand.
+    int model[512];
+    uint32_t count = 0;
+    const int values[] = { 10, 11, 12, 13, 14, 15, 16 };
+
+    vec_int_extend(vec, values, 0);
+    munit_assert_null(vec_int_first(vec));
+    vec_int_extend(vec, values, 3);
+    memcpy(model, values, 3 * sizeof(int));
+    count = 3;
+
+    for (int step = 0; step < 40; step++) {
+        const uint32_t index = (uint32_t)munit_rand_int_range(0, (int)count);
+        const uint32_t n = (uint32_t)munit_rand_int_range(0, (int)TDS_COUNTOF(values));
+        if (step % 2) {
+            vec_int_insert(vec, index, step);
+            memmove(&model[index + 1], &model[index], (count - index) * sizeof(int));
+            model[index] = step;
+            count++;
+        } else {
+            vec_int_insert_many(vec, index, values, n);
+            memmove(&model[index + n], &model[index], (count - index) * sizeof(int));
+            memcpy(&model[index], values, n * sizeof(int));
+            count += n;
+        }
+    }
+    vec_int_extend(vec, values, 2);
+    memcpy(&model[count], values, 2 * sizeof(int));
+    count += 2;
+
+    munit_assert_uint32(vec_int_count(vec), ==, count);
+    munit_assert_memory_equal(count * sizeof(int), vec_int_first(vec), model);
+
+    // Move a range into a second vector, then everything back to the front of the first one.
+    vec_int other = { 0 };
+    vec_int_append(&other, -1);
+    vec_int_append(&other, -2);
+    vec_int_splice(&other, 1, vec, 2, 5);
+    munit_assert_uint32(vec_int_count(vec), ==, count - 5);
+    munit_assert_uint32(vec_int_count(&other), ==, 7);
+    munit_assert_int(vec_int_get(&other, 0), ==, -1);
+    munit_assert_memory_equal(5 * sizeof(int), vec_int_first(&other) + 1, &model[2]);
+    munit_assert_int(vec_int_get(&other, 6), ==, -2);
+    munit_assert_int(vec_int_get(vec, 2), ==, model[7]);
+
+    vec_int_splice(vec, 0, &other, 0, vec_int_count(&other));
+    munit_assert_uint32(vec_int_count(&other), ==, 0);
+    munit_assert_uint32(vec_int_count(vec), ==, count + 2);
+    munit_assert_int(vec_int_get(vec, 0), ==, -1);
+    munit_assert_int(vec_int_get(vec, 6), ==, -2);
+    munit_assert_int(vec_int_get(vec, 7), ==, model[0]);
+    vec_int_fini(&other);
+
+    return MUNIT_OK;
+}
+
+static MunitResult vector_removal(const MunitParameter* params, void* fixture) {
+    (void)params;
+    (void)fixture;
+
+    vec_values_finalized = 0;
+    cleanup_vec vec = { 0 };
+    const int count = munit_rand_int_range(10, 200);
+    for (int i = 0; i < count; i++) {
+        cleanup_vec_append(&vec, i);
+    }
+
+    cleanup_vec_remove_swap(&vec, 0);
+    munit_assert_uint(vec_values_finalized, ==, 1);
+    munit_assert_int(cleanup_vec_get(&vec, 0), ==, count - 1);
+    munit_assert_int(cleanup_vec_get(&vec, 1), ==, 1);
+    cleanup_vec_remove_swap(&vec, vec.count - 1);
+    munit_assert_uint32(vec.count, ==, count - 2);
+    munit_assert_int(cleanup_vec_get(&vec, vec.count - 1), ==, count - 3);
+
+    // Now holds count - 1, 1, 2, ..., count - 3.
+    cleanup_vec_remove_range(&vec, 1, 3);
+    munit_assert_uint(vec_values_finalized, ==, 5);
+    munit_assert_uint32(vec.count, ==, count - 5);
+    munit_assert_int(cleanup_vec_get(&vec, 0), ==, count - 1);
+    for (uint32_t i = 1; i < vec.count; i++) {
+        munit_assert_int(cleanup_vec_get(&vec, i), ==, (int)i + 3);
+    }
+    cleanup_vec_remove_range(&vec, vec.count, 0);
+    cleanup_vec_remove_range(&vec, vec.count - 2, 2);
+    munit_assert_uint32(vec.count, ==, count - 7);
+    munit_assert_uint(vec_values_finalized, ==, 7);
+
+    unsigned calls = 0;
+    const uint32_t before = vec.count;
+    uint32_t odd = 0;
+    for (uint32_t i = 0; i < vec.count; i++) {
+        odd += cleanup_vec_get(&vec, i) % 2 != 0;
+    }
+    munit_assert_uint32(cleanup_vec_retain_if(&vec, is_even, &calls), ==, odd);
+    munit_assert_uint(calls, ==, before);
+    munit_assert_uint(vec_values_finalized, ==, 7 + odd);
+    munit_assert_uint32(vec.count, ==, before - odd);
+    for (uint32_t i = 0; i < vec.count; i++) {
+        munit_assert_int(cleanup_vec_get(&vec, i) % 2, ==, 0);
+        if (i > 1) {
+            munit_assert_int(cleanup_vec_get(&vec, i), >, cleanup_vec_get(&vec, i - 1));
+        }
+    }
+
+    cleanup_vec_fini(&vec);
+    munit_assert_uint(vec_values_finalized, ==, (unsigned)count);
+
+    return MUNIT_OK;
+}
+
+static int compare_ints(const void* a, const void* b) {
+    const int x = *(const int*)a, y = *(const int*)b;
+    return (x > y) - (x < y);
+}
+
+static MunitResult vector_sorting(const MunitParameter* params, void* fixture) {
+    (void)params;
+    (void)fixture;
+
+    // Both sort paths, on random, sorted, reversed and low-cardinality input, checked against qsort.
+    static int model[1000];
+    const uint32_t count = munit_rand_int_range(0, 1) ? 1000 : (uint32_t)munit_rand_int_range(0, 200);
+    const int pattern = munit_rand_int_range(0, 3);
+    const int range = pattern == 3 ? 4 : 1 << 24;
+    sorted_vec vec = { 0 };
+    sorted_i16 shorts = { 0 };
+    sorted_double doubles = { 0 };
+    for (uint32_t i = 0; i < count; i++) {
+        int value = munit_rand_int_range(-range / 2, range / 2);
+        if (pattern == 1) {
+            value = (int)i;
+        } else if (pattern == 2) {
+            value = (int)(count - i);
+        }
+        model[i] = value;
+        sorted_vec_append(&vec, value);
+        sorted_i16_append(&shorts, (int16_t)value);
+        sorted_double_append(&doubles, value / 2.0);
+    }
+    qsort(model, count, sizeof(int), compare_ints);
+
+    sorted_vec_sort(&vec);
+    sorted_double_sort(&doubles);
+    for (uint32_t i = 0; i < count; i++) {
+        munit_assert_int(sorted_vec_get(&vec, i), ==, model[i]);
+        munit_assert_double(sorted_double_get(&doubles, i), ==, model[i] / 2.0);
+    }
+    sorted_i16_radix_sort(&shorts);
+    for (uint32_t i = 1; i < count; i++) {
+        munit_assert_int16(sorted_i16_get(&shorts, i - 1), <=, sorted_i16_get(&shorts, i));
+    }
+
+    for (int probe = 0; probe < 20; probe++) {
+        const int value = count && probe % 2 ? model[munit_rand_uint32() % count] : munit_rand_int_range(-range / 2, range / 2);
+        uint32_t expected = 0;
+        while (expected < count && model[expected] < value) {
+            expected++;
+        }
+        munit_assert_uint32(sorted_vec_lower_bound(&vec, value), ==, expected);
+        const int* found = sorted_vec_binary_search(&vec, value);
+        if (expected < count && model[expected] == value) {
+            munit_assert_not_null(found);
+            munit_assert_int(*found, ==, value);
+        } else {
+            munit_assert_null(found);
+        }
+    }
+
+    uint32_t distinct = count > 0;
+    for (uint32_t i = 1; i < count; i++) {
+        distinct += model[i] != model[i - 1];
+    }
+    munit_assert_uint32(sorted_vec_unique(&vec), ==, count - distinct);
+    munit_assert_uint32(sorted_vec_count(&vec), ==, distinct);
+    for (uint32_t i = 1; i < distinct; i++) {
+        munit_assert_int(sorted_vec_get(&vec, i - 1), <, sorted_vec_get(&vec, i));
+    }
+
+    // A custom comparison on a struct.
+    point_vec points = { 0 };
+    for (int i = 0; i < 300; i++) {
+        point_vec_append(&points, (point_t){ .x = munit_rand_int_range(0, 20), .y = i });
+    }
+    point_vec_sort(&points);
+    for (uint32_t i = 1; i < points.count; i++) {
+        munit_assert_int(points.array[i - 1].x, <=, points.array[i].x);
+    }
+    munit_assert_uint32(point_vec_lower_bound(&points, (point_t){ .x = 21 }), ==, 300);
+    point_vec_unique(&points);
+    munit_assert_uint32(points.count, <=, 21);
+
+    sorted_vec_fini(&vec);
+    sorted_i16_fini(&shorts);
+    sorted_double_fini(&doubles);
+    point_vec_fini(&points);
+
+    return MUNIT_OK;
+}
+
+// Runs the tasks backwards on the calling thread, so nothing can depend on them running in order.
+static void run_backwards(void* user_data, void (*task)(void* argument, size_t index), void* argument, size_t count) {
+    (*(unsigned*)user_data)++;
+    while (count-- > 0) {
+        task(argument, count);
+    }
+}
+
+static void negate_chunk(int64_t* values, const uint32_t count, void* user_data) {
+    (*(unsigned*)user_data)++;
+    for (uint32_t i = 0; i < count; i++) {
+        values[i] = -values[i];
+    }
+}
+
+static int64_t sum_chunk(const int64_t* values, const uint32_t count, void* user_data) {
+    (void)user_data;
+    int64_t sum = 0;
+    for (uint32_t i = 0; i < count; i++) {
+        sum += values[i];
+    }
+    return sum;
+}
+
+static MunitResult vector_parallel(const MunitParameter* params, void* fixture) {
+    (void)params;
+    (void)fixture;
+
+    unsigned runs = 0;
+    const tds_executor_t backwards = { .run = run_backwards, .concurrency = 8, .user_data = &runs };
+    // The default executor starts threads, so only use it now and then.
+    const tds_executor_t* executor = munit_rand_int_range(0, 99) ? &backwards : NULL;
+
+    parallel_vec vec = { 0 };
+    const int count = munit_rand_int_range(0, 1000);
+    int64_t sum = 0;
+    for (int i = 0; i < count; i++) {
+        const int64_t value = munit_rand_int_range(-1000, 1000) * (int64_t)(count > 500 ? 1 : 1 << 20);
+        parallel_vec_append(&vec, value);
+        sum += value;
+    }
+
+    munit_assert_int64(parallel_vec_parallel_reduce(&vec, executor, sum_chunk, NULL), ==, sum);
+    unsigned chunks = 0;
+    parallel_vec_parallel_for_each(&vec, executor, negate_chunk, &chunks);
+    if (executor) {
+        const unsigned expected = count < 32 ? 1 : (count / 16 < 32 ? (unsigned)count / 16 : 32);
+        munit_assert_uint(chunks, ==, count == 0 ? 0 : expected);
+    }
+    munit_assert_int64(parallel_vec_parallel_reduce(&vec, executor, sum_chunk, NULL), ==, -sum);
+
+    parallel_vec_parallel_sort(&vec, executor);
+    for (uint32_t i = 1; i < vec.count; i++) {
+        munit_assert_int64(parallel_vec_get(&vec, i - 1), <=, parallel_vec_get(&vec, i));
+    }
+    munit_assert_int64(parallel_vec_parallel_reduce(&vec, executor, sum_chunk, NULL), ==, -sum);
+    if (executor && count >= 32) {
+        munit_assert_uint(runs, >, 3);
+    }
+
+    parallel_points points = { 0 };
+    for (int i = 0; i < count; i++) {
+        parallel_points_append(&points, (point_t){ .x = munit_rand_int_range(0, 50), .y = i });
+    }
+    parallel_points_parallel_sort(&points, executor);
+    for (uint32_t i = 1; i < points.count; i++) {
+        munit_assert_int(points.array[i - 1].x, <=, points.array[i].x);
+    }
+    // Merges split at ties must still output every point exactly once.
+    char seen[1000] = { 0 };
+    for (uint32_t i = 0; i < points.count; i++) {
+        munit_assert_false(seen[points.array[i].y]);
+        seen[points.array[i].y] = 1;
+    }
+
+    parallel_vec_fini(&vec);
+    parallel_points_fini(&points);
+
+    return MUNIT_OK;
+}
+
+static char is_odd_byte(const uint8_t* value, void* user_data) {
+    (void)user_data;
+    return *value % 2;
+}
+
+static char is_above(const double* value, void* user_data) {
+    return *value > *(const double*)user_data;
+}
+
+static MunitResult vector_numeric(const MunitParameter* params, void* fixture) {
+    (void)params;
+    (void)fixture;
+
+    numeric_bytes bytes = { 0 };
+    numeric_bytes odd = { 0 };
+    double minimum = 0, maximum = 0;
+    munit_assert_false(numeric_bytes_min_max(&bytes, NULL, NULL));
+    munit_assert_uint8(numeric_bytes_sum(&bytes), ==, 0);
+    munit_assert_null(numeric_bytes_find(&bytes, 0));
+
+    // Sizes that aren't multiples of the block size, to cover the tails.
+    const uint32_t count = (uint32_t)munit_rand_int_range(1, 300);
+    uint8_t sum = 0, low = UINT8_MAX, high = 0;
+    uint32_t sevens = 0, odd_count = 0, first_seven = count;
+    for (uint32_t i = 0; i < count; i++) {
+        const uint8_t value = (uint8_t)(munit_rand_uint32() % 200 + 1);
+        numeric_bytes_append(&bytes, value);
+        sum += value;
+        low = value < low ? value : low;
+        high = value > high ? value : high;
+        sevens += value == 7;
+        odd_count += value % 2;
+        if (value == 7 && first_seven == count) {
+            first_seven = i;
+        }
+    }
+
+    munit_assert_uint8(numeric_bytes_sum(&bytes), ==, sum);
+    uint8_t found_low, found_high;
+    munit_assert_true(numeric_bytes_min_max(&bytes, &found_low, &found_high));
+    munit_assert_uint8(found_low, ==, low);
+    munit_assert_uint8(found_high, ==, high);
+    munit_assert_uint32(numeric_bytes_count_if_eq(&bytes, 7), ==, sevens);
+    munit_assert_uint32(numeric_bytes_count_if_eq(&bytes, 0), ==, 0);
+    if (sevens) {
+        munit_assert_ptr_equal(numeric_bytes_find(&bytes, 7), bytes.array + first_seven);
+    } else {
+        munit_assert_null(numeric_bytes_find(&bytes, 7));
+    }
+    const uint8_t* last = numeric_bytes_find(&bytes, bytes.array[count - 1]);
+    munit_assert_not_null(last);
+    munit_assert_uint8(*last, ==, bytes.array[count - 1]);
+    for (const uint8_t* value = bytes.array; value < last; value++) {
+        munit_assert_uint8(*value, !=, *last);
+    }
+
+    numeric_bytes_append(&odd, 1);
+    munit_assert_uint32(numeric_bytes_filter_into(&bytes, &odd, is_odd_byte, NULL), ==, odd_count);
+    munit_assert_uint32(odd.count, ==, odd_count + 1);
+    uint32_t next = 0;
+    for (uint32_t i = 1; i < odd.count; i++) {
+        munit_assert_uint8(odd.array[i] % 2, ==, 1);
+        while (bytes.array[next] != odd.array[i]) {
+            next++;
+        }
+        next++;
+    }
+
+    numeric_bytes_fill(&bytes, 3);
+    munit_assert_uint32(numeric_bytes_count_if_eq(&bytes, 3), ==, count);
+    munit_assert_uint8(numeric_bytes_sum(&bytes), ==, (uint8_t)(3 * count));
+
+    // Byte-sized lane counters are added up often enough not to wrap around.
+    const uint32_t long_count = count + 20000;
+    numeric_bytes_grow(&bytes, 20000);
+    numeric_bytes_fill(&bytes, 5);
+    munit_assert_uint32(numeric_bytes_count_if_eq(&bytes, 5), ==, long_count);
+    munit_assert_ptr_equal(numeric_bytes_find(&bytes, 5), bytes.array);
+    bytes.array[long_count - 1] = 6;
+    munit_assert_ptr_equal(numeric_bytes_find(&bytes, 6), bytes.array + long_count - 1);
+    munit_assert_uint32(numeric_bytes_count_if_eq(&bytes, 5), ==, long_count - 1);
+
+    numeric_doubles doubles = { 0 };
+    double total = 0;
+    for (uint32_t i = 0; i < count; i++) {
+        const double value = (double)(munit_rand_uint32() % 1000) / 8 - 50;
+        numeric_doubles_append(&doubles, value);
+        total += value;
+    }
+    // Multiples of 1/8 this small add up exactly in any order.
+    munit_assert_double(numeric_doubles_sum(&doubles), ==, total);
+    munit_assert_true(numeric_doubles_min_max(&doubles, &minimum, &maximum));
+    numeric_doubles above = { 0 };
+    const double threshold = (minimum + maximum) / 2;
+    numeric_doubles_filter_into(&doubles, &above, is_above, (void*)&threshold);
+    for (uint32_t i = 0; i < doubles.count; i++) {
+        munit_assert_double(doubles.array[i], >=, minimum);
+        munit_assert_double(doubles.array[i], <=, maximum);
+        munit_assert_true(numeric_doubles_find(&doubles, doubles.array[i]) <= doubles.array + i);
+    }
+    for (uint32_t i = 0; i < above.count; i++) {
+        munit_assert_double(above.array[i], >, threshold);
+    }
+
+    numeric_bytes_fini(&bytes);
+    numeric_bytes_fini(&odd);
+    numeric_doubles_fini(&doubles);
+    numeric_doubles_fini(&above);
+
+    return MUNIT_OK;
+}
+
+#ifndef _WIN32
+static MunitResult mapped_vector(const MunitParameter* params, void* fixture) {
+    (void)params;
+    (void)fixture;
+
+    char path[] = "/tmp/tds-mapped-vector-XXXXXX";
+    const int file = mkstemp(path);
+    munit_assert_int(file, >=, 0);
+    close(file);
+
+    mapped_vec_int vec = { 0 };
+    munit_assert_true(mapped_vec_int_open(&vec, path));
+    munit_assert_uint32(mapped_vec_int_count(&vec), ==, 0);
+    const int count = munit_rand_int_range(2, 5000);
+    for (int i = 0; i < count; i++) {
+        munit_assert_true(mapped_vec_int_append(&vec, i * 3));
+    }
+    int* slot = mapped_vec_int_grow(&vec, 2);
+    munit_assert_not_null(slot);
+    slot[0] = -1;
+    slot[1] = -2;
+    mapped_vec_int_remove(&vec, 0);
+    munit_assert_true(mapped_vec_int_sync(&vec));
+    mapped_vec_int_fini(&vec);
+    munit_assert_null(vec.header);
+
+    // The elements are still there after reopening, and the file grows again from where it was.
+    munit_assert_true(mapped_vec_int_open(&vec, path));
+    munit_assert_uint32(mapped_vec_int_count(&vec), ==, count + 1);
+    munit_assert_int(mapped_vec_int_get(&vec, 0), ==, 3);
+    munit_assert_int(mapped_vec_int_get(&vec, count - 2), ==, (count - 1) * 3);
+    munit_assert_int(mapped_vec_int_get(&vec, count), ==, -2);
+    munit_assert_true(mapped_vec_int_append(&vec, 7));
+    mapped_vec_int_reclaim(&vec);
+    munit_assert_uint32(vec.capacity, >=, vec.count);
+    munit_assert_int(mapped_vec_int_first(&vec)[count + 1], ==, 7);
+
+    // Edits in the middle keep the stored count in step, so they survive reopening too.
+    static const int extra[] = { 100, 101, 102 };
+    munit_assert_true(mapped_vec_int_insert(&vec, 0, -3));
+    munit_assert_true(mapped_vec_int_insert_many(&vec, 1, extra, 3));
+    munit_assert_true(mapped_vec_int_extend(&vec, extra, 3));
+    munit_assert_uint32(mapped_vec_int_count(&vec), ==, count + 9);
+    munit_assert_int(mapped_vec_int_get(&vec, 0), ==, -3);
+    munit_assert_int(mapped_vec_int_get(&vec, 3), ==, 102);
+    munit_assert_int(mapped_vec_int_get(&vec, 4), ==, 3);
+    mapped_vec_int_remove_range(&vec, 1, 3);
+    mapped_vec_int_remove_swap(&vec, 0);
+    munit_assert_int(mapped_vec_int_get(&vec, 0), ==, 102);
+    // The odd values left are the odd multiples of 3, -1, 7 and 101.
+    unsigned calls = 0;
+    munit_assert_uint32(mapped_vec_int_retain_if(&vec, is_even, &calls), ==, count / 2 + 3);
+    const uint32_t kept = mapped_vec_int_count(&vec);
+    mapped_vec_int_fini(&vec);
+    munit_assert_true(mapped_vec_int_open(&vec, path));
+    munit_assert_uint32(mapped_vec_int_count(&vec), ==, kept);
+    for (uint32_t i = 0; i < kept; i++) {
+        munit_assert_int(mapped_vec_int_get(&vec, i) % 2, ==, 0);
+    }
+    mapped_vec_int_clear(&vec);
+    mapped_vec_int_fini(&vec);
+
+    // A file of another value size is rejected.
+    mapped_bytes bytes = { 0 };
+    munit_assert_false(mapped_bytes_open(&bytes, path));
+    munit_assert_null(bytes.header);
+    unlink(path);
+
+    // Without a file, the vector lives in anonymous memory.
+    for (int i = 0; i < 10000; i++) {
+        mapped_bytes_append(&bytes, (uint8_t)i);
+    }
+    munit_assert_uint8(mapped_bytes_get(&bytes, 9999), ==, (uint8_t)9999);
+    mapped_bytes_clear(&bytes);
+    mapped_bytes_reclaim(&bytes);
+    munit_assert_null(mapped_bytes_first(&bytes));
+    mapped_bytes_append(&bytes, 1);
+    mapped_bytes_fini(&bytes);
+
+    return MUNIT_OK;
+}
+#endif
+
+static MunitResult soa_vector(const MunitParameter* params, void* fixture) {
+    (void)params;
+    (void)fixture;
+
+    particles vec = { 0 };
+    const int count = munit_rand_int_range(1, 300);
+    for (int i = 0; i < count; i++) {
+        particles_append(&vec, (particles_value_t){ .x = (float)i, .y = i * 2.0, .id = (uint16_t)i });
+    }
+    munit_assert_uint32(particles_count(&vec), ==, count);
+    munit_assert_size((uintptr_t)vec.x % TDS_CACHE_LINE_SIZE, ==, 0);
+    munit_assert_size((uintptr_t)vec.y % TDS_CACHE_LINE_SIZE, ==, 0);
+    munit_assert_size((uintptr_t)vec.id % TDS_CACHE_LINE_SIZE, ==, 0);
+
+    // Each field is a plain array.
+    double sum = 0;
+    for (int i = 0; i < count; i++) {
+        munit_assert_float(vec.x[i], ==, (float)i);
+        munit_assert_uint16(vec.id[i], ==, i);
+        sum += vec.y[i];
+    }
+    munit_assert_double(sum, ==, (double)count * (count - 1));
+
+    const uint32_t first = particles_grow(&vec, 2);
+    munit_assert_uint32(first, ==, count);
+    vec.x[first] = -1.0f;
+    vec.y[first] = -2.0;
+    vec.id[first] = 1000;
+    particles_set(&vec, first + 1, (particles_value_t){ .x = 5.0f, .y = 6.0, .id = 7 });
+
+    particles_remove_swap(&vec, 0);
+    particles_value_t value = particles_get(&vec, 0);
+    munit_assert_float(value.x, ==, 5.0f);
+    munit_assert_double(value.y, ==, 6.0);
+    munit_assert_uint16(value.id, ==, 7);
+    particles_remove(&vec, 0);
+    munit_assert_uint32(particles_count(&vec), ==, count);
+    value = particles_get(&vec, (uint32_t)count - 1);
+    munit_assert_uint16(value.id, ==, 1000);
+    if (count > 1) {
+        munit_assert_uint16(particles_get(&vec, 0).id, ==, 1);
+    }
+
+    particles_reclaim(&vec);
+    munit_assert_uint32(vec.capacity, ==, count);
+    munit_assert_double(particles_get(&vec, (uint32_t)count - 1).y, ==, -2.0);
+    particles_reserve(&vec, 1000);
+    munit_assert_uint32(vec.capacity, ==, 1000);
+    munit_assert_float(particles_get(&vec, (uint32_t)count - 1).x, ==, -1.0f);
+    particles_clear(&vec);
+    particles_reclaim(&vec);
+    munit_assert_null(vec.block);
+    particles_fini(&vec);
+
+    return MUNIT_OK;
+}
+
+static MunitResult segmented_vector(const MunitParameter* params, void* fixture) {
+    (void)params;
+    (void)fixture;
+
+    segmented_vec_int vec = { 0 };
+    const int count = munit_rand_int_range(1, 2000);
+    int* first = segmented_vec_int_append(&vec, 0);
+    int* middle = first;
+    for (int i = 1; i < count; i++) {
+        int* slot = segmented_vec_int_append(&vec, i);
+        if (i == count / 2) {
+            middle = slot;
+        }
+    }
+
+    // Growing never moved anything.
+    munit_assert_ptr_equal(segmented_vec_int_at(&vec, 0), first);
+    munit_assert_ptr_equal(segmented_vec_int_at(&vec, (uint32_t)count / 2), middle);
+    munit_assert_int(*middle, ==, count / 2);
+    for (int i = 0; i < count; i++) {
+        munit_assert_int(segmented_vec_int_get(&vec, (uint32_t)i), ==, i);
+    }
+
+    // Chunks come in order and double in size.
+    segmented_vec_int_iter_t it = segmented_vec_int_iter(&vec);
+    int expected = 0;
+    uint32_t size = 8;
+    while (segmented_vec_int_next(&it)) {
+        munit_assert_uint32(it.count, <=, size);
+        for (uint32_t i = 0; i < it.count; i++) {
+            munit_assert_int(it.values[i], ==, expected++);
+        }
+        size *= 2;
+    }
+    munit_assert_int(expected, ==, count);
+
+    segmented_vec_int_remove_swap(&vec, 0);
+    munit_assert_int(*first, ==, count - 1);
+    munit_assert_uint32(segmented_vec_int_count(&vec), ==, count - 1);
+    segmented_vec_int_reserve(&vec, 5000);
+    munit_assert_uint32(vec.capacity, >=, 5000);
+    munit_assert_ptr_equal(segmented_vec_int_at(&vec, 0), first);
+    segmented_vec_int_reclaim(&vec);
+    munit_assert_uint32(vec.capacity, <, 2 * (uint32_t)count + 8);
+    segmented_vec_int_clear(&vec);
+    segmented_vec_int_reclaim(&vec);
+    munit_assert_null(vec.segments[0]);
+    munit_assert_uint32(vec.capacity, ==, 0);
+    segmented_vec_int_fini(&vec);
+
+    vec_values_finalized = 0;
+    cleanup_segmented_vec cleanup = { 0 };
+    for (int i = 0; i < 100; i++) {
+        cleanup_segmented_vec_append(&cleanup, i);
+    }
+    munit_assert_uint32(cleanup.capacity, ==, 127);
+    cleanup_segmented_vec_remove_swap(&cleanup, 50);
+    munit_assert_int(cleanup_segmented_vec_get(&cleanup, 50), ==, 99);
+    munit_assert_uint(vec_values_finalized, ==, 1);
+    cleanup_segmented_vec_fini(&cleanup);
+    munit_assert_uint(vec_values_finalized, ==, 100);
+
+    return MUNIT_OK;
+}
+
+#define CONCURRENT_WRITERS 4
+#define CONCURRENT_PUSHES 300
+
+typedef struct concurrent_writer_t {
+    concurrent_ints* vec;
+    int writer;
+} concurrent_writer_t;
+
+// Pushes increasing values tagged with the writer, some of them in batches.
+static void* concurrent_write(void* argument) {
+    const concurrent_writer_t* writer = argument;
+    for (int i = 0; i < CONCURRENT_PUSHES;) {
+        if (i % 7 == 0 && i + 5 <= CONCURRENT_PUSHES) {
+            int batch[5];
+            for (int j = 0; j < 5; j++) {
+                batch[j] = writer->writer << 16 | (i + j);
+            }
+            concurrent_ints_push_many(writer->vec, batch, 5);
+            i += 5;
+        } else {
+            concurrent_ints_push(writer->vec, writer->writer << 16 | i);
+            i++;
+        }
+    }
+    return NULL;
+}
+
+// Every writer's values must appear in the order it pushed them, without gaps.
+static void check_concurrent_ints(const concurrent_ints* vec, const char complete) {
+    int seen[CONCURRENT_WRITERS] = { 0 };
+    concurrent_ints_iter_t it = concurrent_ints_iter(vec);
+    while (concurrent_ints_next(&it)) {
+        for (uint32_t i = 0; i < it.count; i++) {
+            const int writer = it.values[i] >> 16;
+            munit_assert_int(writer, <, CONCURRENT_WRITERS);
+            munit_assert_int(it.values[i] & 0xFFFF, ==, seen[writer]++);
+        }
+    }
+    for (int writer = 0; complete && writer < CONCURRENT_WRITERS; writer++) {
+        munit_assert_int(seen[writer], ==, CONCURRENT_PUSHES);
+    }
+}
+
+static MunitResult concurrent_vector(const MunitParameter* params, void* fixture) {
+    (void)params;
+    (void)fixture;
+
+    concurrent_ints vec = { 0 };
+    if (munit_rand_uint32() % 2) {
+        concurrent_ints_reserve(&vec, 100);
+        munit_assert_not_null(vec.segments[5]);
+        munit_assert_null(vec.segments[6]);
+    }
+
+    concurrent_writer_t writers[CONCURRENT_WRITERS];
+    for (int i = 0; i < CONCURRENT_WRITERS; i++) {
+        writers[i] = (concurrent_writer_t){ .vec = &vec, .writer = i };
+    }
+
+#ifdef TDS_PTHREADS
+    pthread_t threads[CONCURRENT_WRITERS];
+    for (int i = 0; i < CONCURRENT_WRITERS; i++) {
+        munit_assert_int(pthread_create(&threads[i], NULL, concurrent_write, &writers[i]), ==, 0);
+    }
+    // Read while the writers are still pushing.
+    check_concurrent_ints(&vec, 0);
+    for (int i = 0; i < CONCURRENT_WRITERS; i++) {
+        pthread_join(threads[i], NULL);
+    }
+#else
+    for (int i = 0; i < CONCURRENT_WRITERS; i++) {
+        concurrent_write(&writers[i]);
+    }
+#endif
+
+    munit_assert_uint32(concurrent_ints_count(&vec), ==, CONCURRENT_WRITERS * CONCURRENT_PUSHES);
+    check_concurrent_ints(&vec, 1);
+
+    const uint32_t index = munit_rand_uint32() % concurrent_ints_count(&vec);
+    munit_assert_int(*concurrent_ints_at(&vec, index), ==, concurrent_ints_get(&vec, index));
+    munit_assert_uint32(concurrent_ints_push(&vec, -1), ==, CONCURRENT_WRITERS * CONCURRENT_PUSHES);
+
+    int* first = concurrent_ints_at(&vec, 0);
+    concurrent_ints_clear(&vec);
+    munit_assert_uint32(concurrent_ints_count(&vec), ==, 0);
+    concurrent_ints_push(&vec, 42);
+    munit_assert_ptr_equal(concurrent_ints_at(&vec, 0), first);
+    concurrent_ints_reclaim(&vec);
+    munit_assert_not_null(vec.segments[0]);
+    munit_assert_null(vec.segments[1]);
+    munit_assert_int(concurrent_ints_get(&vec, 0), ==, 42);
+    concurrent_ints_fini(&vec);
+
+    return MUNIT_OK;
+}
+
+static MunitResult cow_vector(const MunitParameter* params, void* fixture) {
+    (void)params;
+    (void)fixture;
+
+    cow_vec_int original = { 0 };
+    munit_assert_false(cow_vec_int_is_shared(&original));
+    cow_vec_int empty = cow_vec_int_clone(&original);
+    munit_assert_null(cow_vec_int_first(&empty));
+    cow_vec_int_append(&empty, 1);
+    munit_assert_null(cow_vec_int_first(&original));
+    cow_vec_int_fini(&empty);
+
+    const int count = munit_rand_int_range(3, 200);
+    for (int i = 0; i < count; i++) {
+        cow_vec_int_append(&original, i);
+    }
+
+    // Clones share the buffer until they change.
+    cow_vec_int copy = cow_vec_int_clone(&original);
+    cow_vec_int other = cow_vec_int_clone(&copy);
+    munit_assert_true(cow_vec_int_is_shared(&original));
+    munit_assert_ptr_equal(cow_vec_int_first(&copy), cow_vec_int_first(&original));
+    munit_assert_size(original.buffer->header.references, ==, 3);
+
+    cow_vec_int_append(&copy, -1);
+    munit_assert_ptr_not_equal(cow_vec_int_first(&copy), cow_vec_int_first(&original));
+    munit_assert_false(cow_vec_int_is_shared(&copy));
+    munit_assert_size(original.buffer->header.references, ==, 2);
+    munit_assert_uint32(cow_vec_int_count(&copy), ==, count + 1);
+    munit_assert_uint32(cow_vec_int_count(&original), ==, count);
+
+    const uint32_t index = munit_rand_uint32() % (uint32_t)count;
+    cow_vec_int_remove(&other, index);
+    munit_assert_false(cow_vec_int_is_shared(&original));
+    munit_assert_uint32(cow_vec_int_count(&other), ==, count - 1);
+    for (uint32_t i = 0; i < (uint32_t)count - 1; i++) {
+        munit_assert_int(cow_vec_int_get(&other, i), ==, (int)(i < index ? i : i + 1));
+    }
+
+    // A vector that owns its buffer changes it in place.
+    const int* elements = cow_vec_int_first(&original);
+    cow_vec_int_set(&original, 0, 100);
+    cow_vec_int_remove_swap(&original, 1);
+    munit_assert_ptr_equal(cow_vec_int_first(&original), elements);
+    munit_assert_int(cow_vec_int_get(&original, 0), ==, 100);
+    munit_assert_int(cow_vec_int_get(&original, 1), ==, count - 1);
+    for (int i = 0; i < count; i++) {
+        munit_assert_int(cow_vec_int_get(&copy, (uint32_t)i), ==, i);
+    }
+    munit_assert_int(cow_vec_int_get(&copy, (uint32_t)count), ==, -1);
+
+    cow_vec_int_fini(&copy);
+    copy = cow_vec_int_clone(&original);
+    *cow_vec_int_grow(&copy, 1) = 7;
+    munit_assert_int(cow_vec_int_first_mut(&copy)[copy.count - 1], ==, 7);
+    munit_assert_uint32(original.count, ==, count - 1);
+
+    // Clearing a shared vector lets go of the buffer.
+    cow_vec_int second = cow_vec_int_clone(&original);
+    cow_vec_int_clear(&second);
+    munit_assert_null(second.buffer);
+    munit_assert_false(cow_vec_int_is_shared(&original));
+    cow_vec_int_reclaim(&original);
+    munit_assert_uint32(original.capacity, ==, original.count);
+    cow_vec_int_reserve(&original, 500);
+    munit_assert_uint32(original.capacity, ==, 500);
+
+    cow_vec_int_fini(&second);
+    cow_vec_int_fini(&original);
+    cow_vec_int_fini(&copy);
+    cow_vec_int_fini(&other);
+
+    // Growing an empty vector by nothing doesn't allocate.
+    aligned_cow_vec aligned = { 0 };
+    munit_assert_null(aligned_cow_vec_grow(&aligned, 0));
+    munit_assert_null(aligned.buffer);
+
+    // The elements start at the buffer's alignment, after the padded reference count.
+    aligned_cow_vec_append(&aligned, 1.5);
+    munit_assert_size((uintptr_t)aligned_cow_vec_first(&aligned) % 64, ==, 0);
+    aligned_cow_vec shared = aligned_cow_vec_clone(&aligned);
+    aligned_cow_vec_append(&aligned, 2.5);
+    munit_assert_size((uintptr_t)aligned_cow_vec_first(&aligned) % 64, ==, 0);
+    munit_assert_double(aligned_cow_vec_get(&shared, 0), ==, 1.5);
+    aligned_cow_vec_fini(&shared);
+    aligned_cow_vec_fini(&aligned);
+
+    return MUNIT_OK;
+}
+
+static MunitResult small_vector(const MunitParameter* params, void* fixture) {
+    (void)params;
+    (void)fixture;
+
+    // Up to 8 elements live inside the struct.
+    small_vec_int vec = { 0 };
+    for (int i = 0; i < 8; i++) {
+        small_vec_int_append(&vec, i);
+    }
+    munit_assert_null(vec.array);
+    munit_assert_ptr_equal(small_vec_int_first(&vec), vec.inline_array);
+
+    // Copying the struct keeps it valid while it's inline.
+    small_vec_int copy = vec;
+    munit_assert_int(small_vec_int_get(&copy, 7), ==, 7);
+
+    const int count = munit_rand_int_range(9, 100);
+    for (int i = 8; i < count; i++) {
+        small_vec_int_append(&vec, i);
+    }
+    munit_assert_not_null(vec.array);
+    munit_assert_uint32(small_vec_int_count(&vec), ==, count);
+    for (int i = 0; i < count; i++) {
+        munit_assert_int(small_vec_int_get(&vec, i), ==, i);
+    }
+
+    int* slot = small_vec_int_grow(&vec, 3);
+    slot[0] = -1;
+    slot[2] = -3;
+    munit_assert_int(small_vec_int_first(&vec)[count + 2], ==, -3);
+
+    // Once it's small enough again, reclaim moves it back inline.
+    while (small_vec_int_count(&vec) > 5) {
+        small_vec_int_remove(&vec, 0);
+    }
+    small_vec_int_reclaim(&vec);
+    munit_assert_null(vec.array);
+    munit_assert_uint32(vec.capacity, ==, 0);
+    munit_assert_int(small_vec_int_get(&vec, 4), ==, -3);
+    munit_assert_int(small_vec_int_get(&vec, 2), ==, -1);
+    small_vec_int_reserve(&vec, 8);
+    munit_assert_null(vec.array);
+    small_vec_int_reserve(&vec, 20);
+    munit_assert_uint32(vec.capacity, ==, 20);
+    munit_assert_int(small_vec_int_get(&vec, 4), ==, -3);
+    small_vec_int_fini(&vec);
+    munit_assert_uint32(small_vec_int_count(&vec), ==, 0);
+
+    small_vec_values_finalized = 0;
+    tiny_vec tiny = { 0 };
+    tiny_vec_append(&tiny, 1);
+    tiny_vec_append(&tiny, 2);
+    tiny_vec_append(&tiny, 3);
+    tiny_vec_remove(&tiny, 0);
+    munit_assert_uint(small_vec_values_finalized, ==, 1);
+    munit_assert_int(tiny_vec_get(&tiny, 0), ==, 2);
+    tiny_vec_reclaim(&tiny);
+    munit_assert_null(tiny.array);
+    tiny_vec_clear(&tiny);
+    munit_assert_uint(small_vec_values_finalized, ==, 3);
+    tiny_vec_append(&tiny, 4);
+    tiny_vec_fini(&tiny);
+    munit_assert_uint(small_vec_values_finalized, ==, 4);
+
+    return MUNIT_OK;
+}
+
+static MunitResult queue_fifo_and_wrap(const MunitParameter* params, void* fixture) {
+    (void)params;
+    test_data_structures_t* data_structures = fixture;
+    queue_int* queue = &data_structures->int_queue;
+
+    munit_assert_uint32(queue_int_count(queue), ==, 0);
+    munit_assert_null(queue_int_front(queue));
+
+    queue_int_reserve(queue, 4);
+    for (int i = 0; i < 4; i++) {
+        queue_int_push(queue, i);
+    }
+    munit_assert_int(queue_int_pop(queue), ==, 0);
+    munit_assert_int(queue_int_pop(queue), ==, 1);
+
+    queue_int_push(queue, 4);
+    queue_int_push(queue, 5);
+    munit_assert_uint32(queue->capacity, ==, 4);
+    munit_assert_uint32(queue->head, ==, 2);
+    for (int expected = 2; expected < 6; expected++) {
+        munit_assert_int(*queue_int_front(queue), ==, expected);
+        munit_assert_int(queue_int_pop(queue), ==, expected);
+    }
+
+    munit_assert_null(queue_int_front(queue));
+    munit_assert_uint32(queue_int_count(queue), ==, 0);
+    return MUNIT_OK;
+}
+
+static MunitResult queue_growth_and_storage(const MunitParameter* params, void* fixture) {
+    (void)params;
+    test_data_structures_t* data_structures = fixture;
+    small_queue* queue = &data_structures->small_queue;
+
+    for (uint16_t i = 0; i < 4; i++) {
+        small_queue_push(queue, i);
+    }
+    munit_assert_uint8(queue->capacity, ==, 4);
+    small_queue_push(queue, 4);
+    munit_assert_uint8(queue->capacity, ==, 8);
+    munit_assert_uint8(queue->head, ==, 0);
+
+    munit_assert_uint16(small_queue_pop(queue), ==, 0);
+    munit_assert_uint16(small_queue_pop(queue), ==, 1);
+    for (uint16_t i = 5; i < 10; i++) {
+        small_queue_push(queue, i);
+    }
+    munit_assert_uint8(queue->head, ==, 2);
+    small_queue_push(queue, 10);
+    munit_assert_uint8(queue->capacity, ==, 16);
+    munit_assert_uint8(queue->head, ==, 0);
+    for (uint16_t expected = 2; expected <= 10; expected++) {
+        munit_assert_uint16(small_queue_pop(queue), ==, expected);
+    }
+
+    small_queue_reserve(queue, 12);
+    small_queue_push(queue, 20);
+    small_queue_push(queue, 21);
+    small_queue_reclaim(queue);
+    munit_assert_uint8(queue->capacity, ==, 2);
+    munit_assert_uint8(queue->head, ==, 0);
+    munit_assert_uint16(small_queue_pop(queue), ==, 20);
+    munit_assert_uint16(small_queue_pop(queue), ==, 21);
+    small_queue_reclaim(queue);
+    munit_assert_null(queue->array);
+    munit_assert_uint8(queue->capacity, ==, 0);
+
+    small_queue_push(queue, 30);
+    small_queue_clear(queue);
+    munit_assert_uint8(queue->count, ==, 0);
+    munit_assert_not_null(queue->array);
+    return MUNIT_OK;
+}
+
+static MunitResult queue_cleanup(const MunitParameter* params, void* fixture) {
+    (void)params;
+    test_data_structures_t* data_structures = fixture;
+    cleanup_queue* queue = &data_structures->cleanup_queue;
+
+    queue_values_finalized = 0;
+    cleanup_queue_push(queue, 1);
+    cleanup_queue_push(queue, 2);
+    cleanup_queue_push(queue, 3);
+    munit_assert_int(cleanup_queue_pop(queue), ==, 1);
+    munit_assert_uint(queue_values_finalized, ==, 0);
+    cleanup_queue_clear(queue);
+    munit_assert_uint(queue_values_finalized, ==, 2);
+
+    cleanup_queue_push(queue, 4);
+    cleanup_queue_push(queue, 5);
+    cleanup_queue_fini(queue);
+    munit_assert_uint(queue_values_finalized, ==, 4);
+    return MUNIT_OK;
+}
+
+static MunitResult bitset(const MunitParameter* params, void* fixture) {
+    (void)params;
+    (void)fixture;
+
+    bitset_1_t one = { 0 };
+    munit_assert_false(bitset_1_t_any(&one));
+    munit_assert_true(bitset_1_t_none(&one));
+    munit_assert_false(bitset_1_t_get(&one, 0));
+    bitset_1_t_set_all(&one);
+    munit_assert_true(bitset_1_t_any(&one));
+    munit_assert_false(bitset_1_t_none(&one));
+    munit_assert_true(bitset_1_t_get(&one, 0));
+    bitset_1_t_clear(&one, 0);
+    munit_assert_false(bitset_1_t_any(&one));
+    munit_assert_true(bitset_1_t_none(&one));
+
+    bitset_64_t exact_word = { 0 };
+    bitset_64_t_set(&exact_word, 0);
+    bitset_64_t_set(&exact_word, 63);
+    munit_assert_true(bitset_64_t_get(&exact_word, 0));
+    munit_assert_true(bitset_64_t_get(&exact_word, 63));
+    bitset_64_t_clear_all(&exact_word);
+    munit_assert_false(bitset_64_t_any(&exact_word));
+    munit_assert_true(bitset_64_t_none(&exact_word));
+
+    bitset_65_t across_words = { 0 };
+    bitset_65_t_set(&across_words, 63);
+    bitset_65_t_set(&across_words, 64);
+    munit_assert_true(bitset_65_t_get(&across_words, 63));
+    munit_assert_true(bitset_65_t_get(&across_words, 64));
+    bitset_65_t_clear(&across_words, 63);
+    munit_assert_false(bitset_65_t_get(&across_words, 63));
+    munit_assert_true(bitset_65_t_any(&across_words));
+    munit_assert_false(bitset_65_t_none(&across_words));
+
+    bitset_65_t_set_all(&across_words);
+    for (uint32_t i = 0; i < 65; i++) {
+        munit_assert_true(bitset_65_t_get(&across_words, i));
+        bitset_65_t_clear(&across_words, i);
+    }
+    munit_assert_false(bitset_65_t_any(&across_words));
+    munit_assert_true(bitset_65_t_none(&across_words));
+
+    small_bitset small = { 0 };
+    small_bitset_set_all(&small);
+    for (uint32_t i = 0; i < 10; i++) {
+        munit_assert_true(small_bitset_get(&small, i));
+        small_bitset_clear(&small, i);
+    }
+    munit_assert_false(small_bitset_any(&small));
+    munit_assert_true(small_bitset_none(&small));
+
+    return MUNIT_OK;
+}
+
+static MunitResult aligned_storage(const MunitParameter* params, void* fixture) {
+    (void)params;
+    test_data_structures_t* data_structures = fixture;
+
+    hashmap_int_int_set(&data_structures->int_hashmap, 1, 2);
+    set_int_add(&data_structures->int_set, 3);
+    munit_assert_size((uintptr_t)data_structures->int_hashmap.buckets % TDS_CACHE_LINE_SIZE, ==, 0);
+    munit_assert_size((uintptr_t)data_structures->int_set.buckets % TDS_CACHE_LINE_SIZE, ==, 0);
+
+    aligned_vec vec = { 0 };
+    for (uint16_t i = 0; i < 100; i++) {
+        aligned_vec_append(&vec, i);
+        munit_assert_size((uintptr_t)aligned_vec_first(&vec) % 256, ==, 0);
+    }
+    for (uint16_t i = 0; i < 100; i++) {
+        munit_assert_uint16(aligned_vec_get(&vec, i), ==, i);
+    }
+    aligned_vec_remove(&vec, 0);
+    aligned_vec_reclaim(&vec);
+    munit_assert_size((uintptr_t)aligned_vec_first(&vec) % 256, ==, 0);
+    munit_assert_uint16(aligned_vec_get(&vec, 98), ==, 99);
+    aligned_vec_fini(&vec);
+
+    return MUNIT_OK;
+}
+
+typedef struct counting_allocator_t {
+    size_t live_bytes, allocations;
+} counting_allocator_t;
+
+static void* counting_allocate(void* user_data, const size_t size, const size_t alignment) {
+    counting_allocator_t* counter = user_data;
+    counter->live_bytes += size;
+    counter->allocations++;
+    return tds_allocate(NULL, size, alignment);
+}
+
+static void counting_deallocate(void* user_data, void* pointer, const size_t size, const size_t alignment) {
+    counting_allocator_t* counter = user_data;
+    munit_assert_size(counter->live_bytes, >=, size);
+    counter->live_bytes -= size;
+    tds_deallocate(NULL, pointer, size, alignment);
+}
+
+static MunitResult allocator(const MunitParameter* params, void* fixture) {
+    (void)params;
+    (void)fixture;
+
+    counting_allocator_t counter = { 0 };
+    const tds_allocator_t counting = {
+        .allocate = counting_allocate,
+        .deallocate = counting_deallocate,
+        .user_data = &counter,
+    };
+
+    counted_vec vec = { .allocator = &counting };
+    counted_queue queue = { .allocator = &counting };
+    counted_hashmap map = { .allocator = &counting };
+    counted_set set = { .allocator = &counting };
+    counted_pool pool = { .allocator = &counting };
+
+    for (int i = 0; i < 100; i++) {
+        counted_vec_append(&vec, i);
+        counted_queue_push(&queue, i);
+        counted_hashmap_set(&map, i, i * 2);
+        counted_set_add(&set, i);
+        counted_pool_append(&pool, i);
+    }
+    munit_assert_size(counter.live_bytes, >, 0);
+    munit_assert_size((uintptr_t)map.buckets % TDS_CACHE_LINE_SIZE, ==, 0);
+    for (int i = 0; i < 100; i++) {
+        munit_assert_int(counted_vec_get(&vec, i), ==, i);
+        munit_assert_int(counted_queue_pop(&queue), ==, i);
+        munit_assert_int(*counted_hashmap_get(&map, i), ==, i * 2);
+        munit_assert_true(counted_set_contains(&set, i));
+        munit_assert_int(counted_pool_get(&pool, i), ==, i);
+    }
+
+    counted_vec_fini(&vec);
+    counted_queue_reclaim(&queue);
+    counted_hashmap_fini(&map);
+    counted_set_fini(&set);
+    counted_pool_fini(&pool);
+    munit_assert_size(counter.live_bytes, ==, 0);
+    munit_assert_ptr_equal(vec.allocator, &counting);
+    munit_assert_ptr_equal(queue.allocator, &counting);
+    munit_assert_ptr_equal(map.allocator, &counting);
+
+    const size_t allocations = counter.allocations;
+    counted_vec_append(&vec, 1);
+    munit_assert_size(counter.allocations, ==, allocations + 1);
+    counted_vec_fini(&vec);
+    munit_assert_size(counter.live_bytes, ==, 0);
+
+    return MUNIT_OK;
+}
+
+static MunitResult arena(const MunitParameter* params, void* fixture) {
+    (void)params;
+    (void)fixture;
+
+    tds_arena_t arena = { 0 };
+    const tds_allocator_t* allocator = tds_arena_allocator(&arena);
+
+    counted_vec vec = { .allocator = allocator };
+    counted_vec_append(&vec, 0);
+    const int* first = counted_vec_first(&vec);
+    for (int i = 1; i < 1000; i++) {
+        counted_vec_append(&vec, i);
+    }
+    // The buffer is the most recent allocation, so it grows in place.
+    munit_assert_ptr_equal(counted_vec_first(&vec), first);
+
+    const tds_arena_mark_t mark = tds_arena_mark(&arena);
+    counted_hashmap map = { .allocator = allocator };
+    counted_pool pool = { .allocator = allocator };
+    for (int i = 0; i < 100; i++) {
+        counted_hashmap_set(&map, i, i);
+        counted_pool_append(&pool, i);
+    }
+    munit_assert_int(*counted_hashmap_get(&map, 99), ==, 99);
+    tds_arena_rewind(&arena, mark);
+    munit_assert_size(arena.chunk->used, ==, mark.used);
+    for (int i = 0; i < 1000; i++) {
+        munit_assert_int(counted_vec_get(&vec, i), ==, i);
+    }
+
+    void* big = tds_arena_alloc(&arena, TDS_ARENA_CHUNK_SIZE * 2, 64);
+    munit_assert_size((uintptr_t)big % 64, ==, 0);
+    tds_arena_chunk_t* big_chunk = arena.chunk;
+
+    tds_arena_reset(&arena);
+    munit_assert_null(arena.chunk);
+    counted_queue queue = { .allocator = allocator };
+    for (int i = 0; i < 10; i++) {
+        counted_queue_push(&queue, i);
+    }
+    munit_assert_not_null(arena.chunk);
+    munit_assert_ptr_not_equal(arena.chunk, big_chunk);
+    // Released chunks are reused instead of allocating new ones.
+    big = tds_arena_alloc(&arena, TDS_ARENA_CHUNK_SIZE * 2, 0);
+    munit_assert_ptr_equal(arena.chunk, big_chunk);
+    munit_assert_null(arena.spare);
+    tds_arena_fini(&arena);
+
+    tds_frame_arena_t frames = { 0 };
+    int* previous = tds_arena_alloc(tds_frame_arena_current(&frames), sizeof(int), 0);
+    *previous = 42;
+    tds_frame_arena_swap(&frames);
+    int* current = tds_arena_alloc(tds_frame_arena_current(&frames), sizeof(int), 0);
+    *current = 7;
+    munit_assert_int(*previous, ==, 42);
+    munit_assert_ptr_not_equal(tds_frame_arena_current(&frames), tds_frame_arena_previous(&frames));
+    tds_frame_arena_swap(&frames);
+    munit_assert_int(*current, ==, 7);
+    munit_assert_null(tds_frame_arena_current(&frames)->chunk);
+    tds_frame_arena_fini(&frames);
+
+    return MUNIT_OK;
+}
+
+static MunitResult slab(const MunitParameter* params, void* fixture) {
+    (void)params;
+    (void)fixture;
+
+    unsigned char* bytes = tds_slab_calloc(10, 3);
+    for (int i = 0; i < 30; i++) {
+        munit_assert_uint8(bytes[i], ==, 0);
+        bytes[i] = (unsigned char)i;
+    }
+    // Growing within the 32 byte size class stays in place.
+    munit_assert_ptr_equal(tds_slab_realloc(bytes, 32), bytes);
+    unsigned char* grown = tds_slab_realloc(bytes, 100);
+    munit_assert_ptr_not_equal(grown, bytes);
+    for (int i = 0; i < 30; i++) {
+        munit_assert_uint8(grown[i], ==, i);
+    }
+    tds_slab_free(grown);
+    // Freed blocks are reused first.
+    munit_assert_ptr_equal(tds_slab_malloc(128), grown);
+    tds_slab_free(grown);
+
+    unsigned char* large = tds_slab_malloc(100000);
+    large[0] = 3;
+    large[99999] = 7;
+    large = tds_slab_realloc(large, 200000);
+    munit_assert_uint8(large[99999], ==, 7);
+    unsigned char* small = tds_slab_realloc(large, 16);
+    munit_assert_uint8(small[0], ==, 3);
+    tds_slab_free(small);
+
+    // Go through the depot a few times.
+    void* blocks[5 * TDS_SLAB_BATCH];
+    for (int round = 0; round < 2; round++) {
+        for (size_t i = 0; i < TDS_COUNTOF(blocks); i++) {
+            blocks[i] = tds_slab_malloc(64);
+            TDS_MEMSET(blocks[i], (int)i, 64);
+        }
+        for (size_t i = 0; i < TDS_COUNTOF(blocks); i++) {
+            munit_assert_uint8(((unsigned char*)blocks[i])[63], ==, (unsigned char)i);
+            tds_slab_free(blocks[i]);
+        }
+        tds_slab_thread_flush();
+    }
+
+    return MUNIT_OK;
+}
+
+static MunitResult bloom_filter(const MunitParameter* params, void* fixture) {
+    (void)params;
+    (void)fixture;
+
+    bloom_filter_int filter = { 0 };
+    munit_assert_false(bloom_filter_int_contains(&filter, 1));
+
+    const int offset = munit_rand_int_range(0, 1 << 20);
+    bloom_filter_int_reserve(&filter, 500);
+    for (int i = 0; i < 500; i++) {
+        bloom_filter_int_add(&filter, offset + i * 2);
+    }
+    munit_assert_uint32(bloom_filter_int_count(&filter), ==, 500);
+
+    // No false negatives, and about 1% false positives at the default 10 bits per key.
+    unsigned false_positives = 0;
+    for (int i = 0; i < 500; i++) {
+        munit_assert_true(bloom_filter_int_contains(&filter, offset + i * 2));
+        false_positives += bloom_filter_int_contains(&filter, offset + i * 2 + 1);
+    }
+    munit_assert_uint32(false_positives, <, 40);
+
+    bloom_filter_int_clear(&filter);
+    munit_assert_false(bloom_filter_int_contains(&filter, offset));
+    bloom_filter_int_fini(&filter);
+
+    // A filter that was never reserved is sized for TDS_FILTER_DEFAULT_CAPACITY keys, not a single block.
+    for (int i = 0; i < 500; i++) {
+        bloom_filter_int_add(&filter, offset + i * 2);
+    }
+    munit_assert_uint32(filter.block_count, >, 1);
+    false_positives = 0;
+    for (int i = 0; i < 500; i++) {
+        false_positives += bloom_filter_int_contains(&filter, offset + i * 2 + 1);
+    }
+    munit_assert_uint32(false_positives, <, 40);
+    bloom_filter_int_fini(&filter);
+    return MUNIT_OK;
+}
+
+static MunitResult xor_filter(const MunitParameter* params, void* fixture) {
+    (void)params;
+    (void)fixture;
+
+    xor_filter_int filter = { 0 };
+    munit_assert_false(xor_filter_int_contains(&filter, 1));
+
+    // Every key shows up twice, duplicates must not break construction.
+    int keys[500];
+    const int offset = munit_rand_int_range(0, 1 << 20);
+    for (int i = 0; i < 500; i++) {
+        keys[i] = offset + (i % 250) * 2;
+    }
+    munit_assert_true(xor_filter_int_build(&filter, keys, 500));
+    munit_assert_uint32(xor_filter_int_count(&filter), ==, 250);
+
+    // No false negatives, and about 0.4% false positives with 8-bit fingerprints.
+    unsigned false_positives = 0;
+    for (int i = 0; i < 250; i++) {
+        munit_assert_true(xor_filter_int_contains(&filter, offset + i * 2));
+        false_positives += xor_filter_int_contains(&filter, offset + i * 2 + 1);
+    }
+    munit_assert_uint32(false_positives, <, 12);
+
+    xor_filter_int_fini(&filter);
+    munit_assert_true(xor_filter_int_build(&filter, NULL, 0));
+    xor_filter_int_fini(&filter);
+    return MUNIT_OK;
+}
+
+#define TDS_TEST(fun) {\
+    .name = "/"#fun,\
     .test = (fun),\
     .setup = setup,\
     .tear_down = tear_down,\
@@ -594,6 +2530,15 @@ int main(const int argc, char* const* argv) {
         TDS_TEST(remove_test),
         TDS_TEST(get_set),
         TDS_TEST(count),
+        TDS_TEST(aligned_storage),
+        TDS_TEST(set_algebra),
+        TDS_TEST(inline_storage),
+        TDS_TEST(cuckoo_hashmap),
+        TDS_TEST(frozen_hashmap),
+        TDS_TEST(perfect_hash_table),
+        TDS_TEST(int_hashmap),
+        TDS_TEST(cache),
+        TDS_TEST(expiring_map),
         { 0 },
     };
 
@@ -603,6 +2548,22 @@ int main(const int argc, char* const* argv) {
         { 0 },
     };
 
+    MunitTest allocators[] = {
+        {
+            .name = "/per-instance",
+            .test = allocator,
+        },
+        {
+            .name = "/arena",
+            .test = arena,
+        },
+        {
+            .name = "/slab",
+            .test = slab,
+        },
+        { 0 },
+    };
+
     MunitTest bitsets[] = {
         {
             .name = "/operations",
@@ -611,6 +2572,36 @@ int main(const int argc, char* const* argv) {
         { 0 },
     };
 
+    MunitTest filters[] = {
+        {
+            .name = "/bloom",
+            .test = bloom_filter,
+        },
+        {
+            .name = "/xor",
+            .test = xor_filter,
+        },
+        { 0 },
+    };
+
+    MunitTest vectors[] = {
+        TDS_TEST(vector_growth),
+        TDS_TEST(vector_removal),
+        TDS_TEST(vector_insertion),
+        TDS_TEST(vector_sorting),
+        TDS_TEST(vector_parallel),
+        TDS_TEST(vector_numeric),
+#ifndef _WIN32
+        TDS_TEST(mapped_vector),
+#endif
+        TDS_TEST(segmented_vector),
+        TDS_TEST(concurrent_vector),
+        TDS_TEST(cow_vector),
+        TDS_TEST(small_vector),
+        TDS_TEST(soa_vector),
+        { 0 },
+    };
+
     MunitTest queues[] = {
         TDS_TEST(queue_fifo_and_wrap),
         TDS_TEST(queue_growth_and_storage),
@@ -627,14 +2618,26 @@ int main(const int argc, char* const* argv) {
             .prefix = "/dense-pool",
             .tests = dense_pool,
         },
+        {
+            .prefix = "/allocator",
+            .tests = allocators,
+        },
         {
             .prefix = "/bitset",
             .tests = bitsets,
         },
+        {
+            .prefix = "/vector",
+            .tests = vectors,
+        },
         {
             .prefix = "/queue",
             .tests = queues,
         },
+        {
+            .prefix = "/filter",
+            .tests = filters,
+        },
         { 0 },
     };
 
@@ -0,0 +1,423 @@
+// Generates a header with a static, read-only table indexed by a minimal perfect hash, for tables known at compile
+// time. The input has one entry per line: a key, whitespace, and a C expression for its value, which is copied to the
+// output verbatim. Blank lines and lines starting with `#` are ignored. String keys can't contain whitespace, and
+// integer keys must be in the range of the key type.
+//
+// Usage: tds-perfect-hash [--type NAME] [--key-type string|INTEGER_TYPE] [--value-type TYPE] INPUT OUTPUT
+//
+// The generated header follows the conventions of the other headers: it generates `<type>_get` and `<type>_count`, and
+// honors TDS_TYPE, TDS_DECLARE and TDS_IMPLEMENT. String keys are hashed with `rapidhash` over their bytes and integer
+// keys with `tds_mix64`, so a table generated on one machine is valid on any other.
+
+#include <ctype.h>
+#include <errno.h>
+#include <inttypes.h>
+#include <limits.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <rapidhash.h>
+#include <tds/private/common.h>
+
+#define KEYS_PER_BUCKET 4
+#define LINE_SIZE 4096
+
+typedef struct entry_t {
+    char* key; // As written in the input.
+    uint64_t integer; // For integer keys, the key converted to the key type and then to uint64_t, as `get` does.
+    char* value;
+    uint64_t hash;
+    unsigned line;
+} entry_t;
+
+typedef struct bucket_t {
+    size_t index, begin, size;
+} bucket_t;
+
+typedef struct integer_type_t {
+    const char* name;
+    int is_signed;
+    size_t size;
+} integer_type_t;
+
+// Key types whose range the tool knows, so it can reject keys that wouldn't survive the conversion to them.
+static const integer_type_t integer_types[] = {
+    { "int8_t", 1, 1 },
+    { "int16_t", 1, 2 },
+    { "int32_t", 1, 4 },
+    { "int64_t", 1, 8 },
+    { "uint8_t", 0, 1 },
+    { "uint16_t", 0, 2 },
+    { "uint32_t", 0, 4 },
+    { "uint64_t", 0, 8 },
+    { "char", CHAR_MIN < 0, sizeof(char) },
+    { "signed char", 1, sizeof(signed char) },
+    { "unsigned char", 0, sizeof(unsigned char) },
+    { "short", 1, sizeof(short) },
+    { "unsigned short", 0, sizeof(unsigned short) },
+    { "int", 1, sizeof(int) },
+    { "unsigned", 0, sizeof(unsigned) },
+    { "unsigned int", 0, sizeof(unsigned int) },
+    { "long", 1, sizeof(long) },
+    { "unsigned long", 0, sizeof(unsigned long) },
+    { "long long", 1, sizeof(long long) },
+    { "unsigned long long", 0, sizeof(unsigned long long) },
+    { "size_t", 0, sizeof(size_t) },
+};
+
+static const char* program = "tds-perfect-hash";
+
+static void fail(const char* message, const char* detail) {
+    fprintf(stderr, "%s: %s%s%s\n", program, message, detail ? ": " : "", detail ? detail : "");
+    exit(EXIT_FAILURE);
+}
+
+static char* duplicate(const char* string, const size_t length) {
+    char* copy = malloc(length + 1);
+    if (!copy) {
+        fail("out of memory", NULL);
+    }
+    memcpy(copy, string, length);
+    copy[length] = '\0';
+    return copy;
+}
+
+// The same reductions as `freeze` in hashmap.h.
+static size_t reduce(const uint64_t value, const size_t range) {
+    return (size_t)(((value & 0xffffffff) * range) >> 32);
+}
+
+static size_t slot_of(const uint64_t hash, const uint32_t pilot, const size_t count) {
+    return reduce(tds_mix64(hash ^ (pilot * 0x9e3779b97f4a7c15ull)) >> 32, count);
+}
+
+static int compare_hashes(const void* a, const void* b) {
+    const uint64_t x = ((const entry_t*)a)->hash, y = ((const entry_t*)b)->hash;
+    return (x > y) - (x < y);
+}
+
+static int compare_buckets(const void* a, const void* b) {
+    const bucket_t* x = a;
+    const bucket_t* y = b;
+    // Biggest first, ties by index so the output doesn't depend on the sort implementation.
+    if (x->size != y->size) {
+        return x->size < y->size ? 1 : -1;
+    }
+    return (x->index > y->index) - (x->index < y->index);
+}
+
+// Parses an integer key of `type`, failing unless it's in the type's range. Returns the key converted to the type and
+// then to uint64_t, which for signed types sign-extends negative keys.
+static uint64_t parse_integer(const char* key, const integer_type_t* type, const unsigned line_number) {
+    const unsigned bits = (unsigned)type->size * 8;
+    char* end;
+    errno = 0;
+    uint64_t integer;
+    int in_range;
+    if (type->is_signed) {
+        const long long value = strtoll(key, &end, 0);
+        const long long max = (long long)(((uint64_t)1 << (bits - 1)) - 1);
+        in_range = value >= -max - 1 && value <= max;
+        integer = (uint64_t)value;
+    } else {
+        const unsigned long long value = strtoull(key, &end, 0);
+        // strtoull accepts a minus sign and negates the key.
+        in_range = key[0] != '-' && (bits == 64 || value >> bits == 0);
+        integer = (uint64_t)value;
+    }
+
+    if (*end) {
+        fprintf(stderr, "%s: line %u: invalid integer key '%s'\n", program, line_number, key);
+        exit(EXIT_FAILURE);
+    }
+    if (errno == ERANGE || !in_range) {
+        fprintf(stderr, "%s: line %u: key '%s' is out of range for %s\n", program, line_number, key, type->name);
+        exit(EXIT_FAILURE);
+    }
+    return integer;
+}
+
+static entry_t* parse(FILE* input, const integer_type_t* integer_type, size_t* count) {
+    size_t capacity = 64;
+    entry_t* entries = malloc(capacity * sizeof(entry_t));
+    char line[LINE_SIZE];
+    unsigned line_number = 0;
+    *count = 0;
+
+    while (fgets(line, sizeof(line), input)) {
+        line_number++;
+        if (!strchr(line, '\n') && !feof(input)) {
+            fail("line too long", NULL);
+        }
+
+        char* cursor = line;
+        while (isspace((unsigned char)*cursor)) {
+            cursor++;
+        }
+        if (*cursor == '\0' || *cursor == '#') {
+            continue;
+        }
+
+        const char* key = cursor;
+        while (*cursor && !isspace((unsigned char)*cursor)) {
+            cursor++;
+        }
+        const size_t key_length = (size_t)(cursor - key);
+        while (isspace((unsigned char)*cursor)) {
+            cursor++;
+        }
+        const char* value = cursor;
+        size_t value_length = strlen(value);
+        while (value_length && isspace((unsigned char)value[value_length - 1])) {
+            value_length--;
+        }
+        if (value_length == 0) {
+            fprintf(stderr, "%s: line %u: missing value\n", program, line_number);
+            exit(EXIT_FAILURE);
+        }
+
+        if (*count == capacity) {
+            capacity *= 2;
+            entries = realloc(entries, capacity * sizeof(entry_t));
+        }
+        if (!entries) {
+            fail("out of memory", NULL);
+        }
+
+        entry_t* entry = entries + (*count)++;
+        entry->key = duplicate(key, key_length);
+        entry->value = duplicate(value, value_length);
+        entry->line = line_number;
+        if (!integer_type) {
+            entry->integer = 0;
+            entry->hash = rapidhash(entry->key, key_length);
+        } else {
+            entry->integer = parse_integer(entry->key, integer_type, line_number);
+            entry->hash = tds_mix64(entry->integer);
+        }
+    }
+
+    return entries;
+}
+
+static void write_string(FILE* output, const char* string) {
+    fputc('"', output);
+    for (; *string; string++) {
+        if (*string == '"' || *string == '\\') {
+            fputc('\\', output);
+        }
+        fputc(*string, output);
+    }
+    fputc('"', output);
+}
+
+int main(int argc, char** argv) {
+    const char* type = "perfect_hash";
+    const char* key_type = "string";
+    const char* value_type = "int";
+    const char* paths[2] = { NULL, NULL };
+    unsigned path_count = 0;
+
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--type") == 0 && i + 1 < argc) {
+            type = argv[++i];
+        } else if (strcmp(argv[i], "--key-type") == 0 && i + 1 < argc) {
+            key_type = argv[++i];
+        } else if (strcmp(argv[i], "--value-type") == 0 && i + 1 < argc) {
+            value_type = argv[++i];
+        } else if (argv[i][0] != '-' && path_count < 2) {
+            paths[path_count++] = argv[i];
+        } else {
+            fail("unexpected argument", argv[i]);
+        }
+    }
+    if (path_count != 2) {
+        fprintf(
+            stderr,
+            "usage: %s [--type NAME] [--key-type string|INTEGER_TYPE] [--value-type TYPE] INPUT OUTPUT\n",
+            program);
+        return EXIT_FAILURE;
+    }
+
+    const int string_keys = strcmp(key_type, "string") == 0;
+    const integer_type_t* integer_type = NULL;
+    for (size_t i = 0; !string_keys && i < TDS_COUNTOF(integer_types); i++) {
+        if (strcmp(key_type, integer_types[i].name) == 0) {
+            integer_type = integer_types + i;
+        }
+    }
+    if (!string_keys && !integer_type) {
+        fail("unsupported key type", key_type);
+    }
+
+    FILE* input = fopen(paths[0], "r");
+    if (!input) {
+        fail("can't open input", paths[0]);
+    }
+    size_t count;
+    entry_t* entries = parse(input, integer_type, &count);
+    fclose(input);
+    if (count == 0) {
+        fail("no entries", paths[0]);
+    }
+
+    // Equal hashes would make the pilot search loop forever, so reject them up front.
+    qsort(entries, count, sizeof(entry_t), compare_hashes);
+    for (size_t i = 1; i < count; i++) {
+        if (entries[i].hash == entries[i - 1].hash) {
+            const int same = string_keys
+                ? strcmp(entries[i].key, entries[i - 1].key) == 0
+                : entries[i].integer == entries[i - 1].integer;
+            fprintf(
+                stderr,
+                "%s: lines %u and %u: %s '%s'\n",
+                program,
+                entries[i - 1].line < entries[i].line ? entries[i - 1].line : entries[i].line,
+                entries[i - 1].line < entries[i].line ? entries[i].line : entries[i - 1].line,
+                same ? "duplicate key" : "hash collision with key",
+                entries[i].key);
+            return EXIT_FAILURE;
+        }
+    }
+
+    // Hash-and-displace, exactly like `freeze` in hashmap.h.
+    const size_t bucket_count = count / KEYS_PER_BUCKET + 1;
+    bucket_t* buckets = calloc(bucket_count, sizeof(bucket_t));
+    size_t* members = malloc(count * sizeof(size_t));
+    uint32_t* pilots = calloc(bucket_count, sizeof(uint32_t));
+    size_t* slots = malloc(count * sizeof(size_t)); // Entry placed in every slot.
+    char* taken = calloc(count, 1);
+    size_t* placed_slots = malloc(count * sizeof(size_t));
+    if (!buckets || !members || !pilots || !slots || !taken || !placed_slots) {
+        fail("out of memory", NULL);
+    }
+
+    for (size_t i = 0; i < bucket_count; i++) {
+        buckets[i].index = i;
+    }
+    for (size_t i = 0; i < count; i++) {
+        buckets[reduce(entries[i].hash, bucket_count)].size++;
+    }
+    for (size_t i = 0, total = 0; i < bucket_count; i++) {
+        buckets[i].begin = total;
+        total += buckets[i].size;
+        buckets[i].size = 0;
+    }
+    for (size_t i = 0; i < count; i++) {
+        bucket_t* bucket = buckets + reduce(entries[i].hash, bucket_count);
+        members[bucket->begin + bucket->size++] = i;
+    }
+    qsort(buckets, bucket_count, sizeof(bucket_t), compare_buckets);
+
+    for (size_t i = 0; i < bucket_count && buckets[i].size; i++) {
+        const bucket_t* bucket = buckets + i;
+        uint32_t pilot = 0;
+        size_t placed = 0;
+        while (placed < bucket->size) {
+            const size_t slot = slot_of(entries[members[bucket->begin + placed]].hash, pilot, count);
+            int free_slot = !taken[slot];
+            for (size_t j = 0; free_slot && j < placed; j++) {
+                free_slot = placed_slots[j] != slot;
+            }
+
+            if (free_slot) {
+                placed_slots[placed++] = slot;
+            } else {
+                pilot++;
+                placed = 0;
+                if (pilot == 0) {
+                    fail("no pilot found", NULL);
+                }
+            }
+        }
+
+        pilots[bucket->index] = pilot;
+        for (size_t j = 0; j < bucket->size; j++) {
+            taken[placed_slots[j]] = 1;
+            slots[placed_slots[j]] = members[bucket->begin + j];
+        }
+    }
+
+    FILE* output = fopen(paths[1], "w");
+    if (!output) {
+        fail("can't open output", paths[1]);
+    }
+
+    const char* base_name = strrchr(paths[0], '/');
+    base_name = base_name ? base_name + 1 : paths[0];
+    fprintf(output, "// Generated by %s from %s. Do not edit.\n\n", program, base_name);
+    fprintf(output, "#include <tds/private/common.h>\n");
+    if (string_keys) {
+        fprintf(output, "\n#include <string.h>\n\n#include <rapidhash.h>\n");
+    }
+    fprintf(output, "\n#ifndef TDS_TYPE\n#define TDS_TYPE %s\n#endif\n\n", type);
+    fprintf(output, "#define TDS_KEY_T %s\n", string_keys ? "const char*" : key_type);
+    fprintf(output, "#define TDS_VALUE_T %s\n", value_type);
+    fprintf(output, "#include <tds/private/begin.inc>\n\n");
+
+    fprintf(output, "#ifdef TDS_DECLARE\n");
+    fprintf(output, "TDS_VALUE_T const* TDS_FUNCTION(get)(TDS_KEY_T key);\n");
+    fprintf(output, "TDS_SIZE_T TDS_FUNCTION(count)(void);\n");
+    fprintf(output, "#endif\n\n");
+
+    fprintf(output, "#ifdef TDS_IMPLEMENT\n");
+    fprintf(output, "static const uint32_t TDS_FUNCTION(_pilots)[%zu] = {\n", bucket_count);
+    for (size_t i = 0; i < bucket_count; i++) {
+        fprintf(output, "    %" PRIu32 ",\n", pilots[i]);
+    }
+    fprintf(output, "};\n\nstatic TDS_KEY_T const TDS_FUNCTION(_keys)[%zu] = {\n", count);
+    for (size_t i = 0; i < count; i++) {
+        fprintf(output, "    ");
+        if (string_keys) {
+            write_string(output, entries[slots[i]].key);
+        } else if (!integer_type->is_signed) {
+            fprintf(output, "%" PRIu64 "u", entries[slots[i]].integer);
+        } else if (entries[slots[i]].integer == (uint64_t)1 << 63) {
+            // The literal for INT64_MIN would be the negation of a constant too big for any signed type.
+            fprintf(output, "(-%" PRId64 " - 1)", INT64_MAX);
+        } else {
+            fprintf(output, "%" PRId64, (int64_t)entries[slots[i]].integer);
+        }
+        fprintf(output, ",\n");
+    }
+    fprintf(output, "};\n\nstatic TDS_VALUE_T const TDS_FUNCTION(_values)[%zu] = {\n", count);
+    for (size_t i = 0; i < count; i++) {
+        fprintf(output, "    %s,\n", entries[slots[i]].value);
+    }
+    fprintf(output, "};\n\n");
+
+    fprintf(output, "TDS_VALUE_T const* TDS_FUNCTION(get)(TDS_KEY_T key) {\n");
+    if (string_keys) {
+        fprintf(output, "    const uint64_t hash = rapidhash(key, strlen(key));\n");
+    } else {
+        fprintf(output, "    const uint64_t hash = tds_mix64((uint64_t)key);\n");
+    }
+    fprintf(output, "    const uint64_t pilot = TDS_FUNCTION(_pilots)[((hash & 0xffffffff) * %zuu) >> 32];\n", bucket_count);
+    fprintf(output, "    const uint64_t slot = ((tds_mix64(hash ^ (pilot * 0x9e3779b97f4a7c15ull)) >> 32) * %zuu) >> 32;\n", count);
+    if (string_keys) {
+        fprintf(output, "    return strcmp(TDS_FUNCTION(_keys)[slot], key) == 0 ? TDS_FUNCTION(_values) + slot : NULL;\n");
+    } else {
+        fprintf(output, "    return TDS_FUNCTION(_keys)[slot] == key ? TDS_FUNCTION(_values) + slot : NULL;\n");
+    }
+    fprintf(output, "}\n\n");
+    fprintf(output, "TDS_SIZE_T TDS_FUNCTION(count)(void) {\n    return %zu;\n}\n", count);
+    fprintf(output, "#endif\n\n#include <tds/private/end.inc>\n");
+
+    if (fclose(output) != 0) {
+        fail("can't write output", paths[1]);
+    }
+
+    for (size_t i = 0; i < count; i++) {
+        free(entries[i].key);
+        free(entries[i].value);
+    }
+    free(entries);
+    free(buckets);
+    free(members);
+    free(pilots);
+    free(slots);
+    free(taken);
+    free(placed_slots);
+    return EXIT_SUCCESS;
+}